@@ -18,7 +18,6 @@
 #include "pdca_write_sector.h"
 #include "intc.h"
 #include "sdramc.h"
-#include "delay.h"
 #include "cycle_counter.h"
 
 
@@ -291,12 +290,14 @@ int main(void)
 			// by checking the channel transfer status with the correct interrupt flag
 			while (!(pdca_get_transfer_status(AVR32_PDCA_CHANNEL_SPI_TX) & AVR32_PDCA_ISR_TRC_MASK));
 			
+			// Wait for the last byte to leave the shifter before the CRC
+			while (!spi_writeEndCheck(SD_MMC_SPI));
+			
 			// Disable PDCA TX channel
 			pdca_disable(AVR32_PDCA_CHANNEL_SPI_TX);
 			
 			// Close PCDA write session
 			sd_mmc_spi_write_close_PDCA();
-			delay_us(10); // give the PDCA time to close
 			
 			// Increase sdram pointer with one sector size
 			sdram += MMC_SECTOR_SIZE;
@@ -348,7 +349,6 @@ int main(void)
 			
 			// Close PDCA read session
 			sd_mmc_spi_read_close_PDCA();
-			delay_us(10); // give the PDCA time to close
 			
 			// Disable PDCA RX and TX channel
 			pdca_disable(AVR32_PDCA_CHANNEL_SPI_TX);
@@ -80,7 +80,13 @@
 
 #define DIP204_CGRAM_BASE_ADDR           0x40
 
+/*! LCD execution time covered by the transfer delay of queued writes (us) */
+#define DIP204_QUEUE_EXEC_TIME_US          50
+
 static void dip204_write_byte(unsigned char byte);
+static void dip204_encode_frame(uint8_t frame[3], unsigned char start, unsigned char byte);
+static void dip204_write_frame(unsigned char start, unsigned char byte);
+static unsigned char dip204_cursor_address(unsigned char column, unsigned char line);
 static void dip204_read_byte(unsigned char *byte);
 static void dip204_select(void);
 static void dip204_unselect(void);
@@ -100,6 +106,11 @@ static int channel_id = -1;
 static spi_status_t spi_status;
 #endif
 
+#if (defined DIP204_USE_SPI_QUEUE) && (DIP204_USE_SPI_QUEUE == true)
+/*! the LCD as seen by the SPI queue, a transfer delay replaces busy polling */
+static spi_queue_device_t dip204_queue_device;
+#endif
+
 
 /****************************** global functions *****************************/
 
@@ -249,10 +260,8 @@ void dip204_hide_cursor(void)
 void dip204_write_data(unsigned char data)
 {
   dip204_select();
-  /* Send Write Data Start-Byte */
-  dip204_write_byte(DIP204_WRITE_DATA);
-  /* send data */
-  dip204_write_byte(data);
+  /* Send Write Data Start Byte and data */
+  dip204_write_frame(DIP204_WRITE_DATA, data);
   dip204_wait_busy();
   dip204_unselect();
 }
@@ -298,10 +307,8 @@ void dip204_create_char(char ascii_code, const unsigned char data[8])
   /* To proceed the 8 lines */
   for(i=0; i<8; i++)
   {
-    /* Send Data Start Byte */
-    dip204_write_byte(DIP204_WRITE_DATA);
-    /* send data */
-    dip204_write_byte(data[i] & 0x1F); //data[i]);
+    /* Send Write Data Start Byte and data */
+    dip204_write_frame(DIP204_WRITE_DATA, data[i] & 0x1F);
     /* wait for LCD */
     dip204_wait_busy();
   }
@@ -316,18 +323,9 @@ void dip204_create_char(char ascii_code, const unsigned char data[8])
 
 void dip204_set_cursor_position(unsigned char column, unsigned char line)
 {
-  unsigned char address = 0;
-
   dip204_select();
-  if ((column <= 20) && (line <= 4))
-  {
-    /* Calculate DDRAM address from line and row values */
-    address = ( (line-1) * 32 ) + ( column-1 ) + 128;
-  }
-  /* Send Command Start Byte */
-  dip204_write_byte(DIP204_WRITE_COMMAND);
-  /* Send Address lower Nibble */
-  dip204_write_byte(address);
+  /* Send Command Start Byte and Address */
+  dip204_write_frame(DIP204_WRITE_COMMAND, dip204_cursor_address(column, line));
   dip204_wait_busy();
   dip204_unselect();
 }
@@ -355,10 +353,8 @@ void dip204_write_string(const char *string)
   /* for all chars in string */
   while(string[i]!=0)
   {
-    /* Send Write Data Start Byte */
-    dip204_write_byte(DIP204_WRITE_DATA);
-    /* Send byte */
-    dip204_write_byte(string[i]);
+    /* Send Write Data Start Byte and data */
+    dip204_write_frame(DIP204_WRITE_DATA, string[i]);
     /* go to next char */
     i++;
     dip204_wait_busy();
@@ -382,10 +378,8 @@ void dip204_printf_string(const char *format, ...)
   i = 0;
   while(string[i]!='\0')
   {
-    /* Send Write Data Start Byte */
-    dip204_write_byte(DIP204_WRITE_DATA);
-    /* Send byte */
-    dip204_write_byte(string[i]);
+    /* Send Write Data Start Byte and data */
+    dip204_write_frame(DIP204_WRITE_DATA, string[i]);
     /* go to next char */
     i++;
     dip204_wait_busy();
@@ -394,6 +388,41 @@ void dip204_printf_string(const char *format, ...)
 }
 
 
+#if (defined DIP204_USE_SPI_QUEUE) && (DIP204_USE_SPI_QUEUE == true)
+void dip204_queue_init(const spi_options_t *options, uint32_t pba_hz)
+{
+  dip204_queue_device.options = *options;
+  /* wait 32 * DLYBCT PBA periods between bytes */
+  dip204_queue_device.options.trans_delay =
+    min(255, div_ceil(pba_hz / 1000000 * DIP204_QUEUE_EXEC_TIME_US, 32));
+}
+
+
+bool dip204_queue_write_data(dip204_queue_job_t *job, unsigned char column,
+                             unsigned char line, unsigned char data)
+{
+  if (job->xfer.busy)
+    return false;
+
+  /* Set cursor position, then write data */
+  dip204_encode_frame(&job->frame[0], DIP204_WRITE_COMMAND, dip204_cursor_address(column, line));
+  dip204_encode_frame(&job->frame[3], DIP204_WRITE_DATA, data);
+  /* Busy flag read, only sent once the transfer delay has covered the write */
+  job->frame[6] = DIP204_READ_COMMAND;
+  job->frame[7] = 0x00;
+
+  job->xfer.device   = &dip204_queue_device;
+  job->xfer.tx       = job->frame;
+  job->xfer.rx       = NULL;
+  job->xfer.len      = sizeof(job->frame);
+  job->xfer.keep_cs  = false;
+  job->xfer.callback = NULL;
+
+  return spi_queue_submit(&job->xfer);
+}
+#endif
+
+
 /****************************** local functions ******************************/
 
 /*! \brief function to select the LCD
@@ -401,6 +430,9 @@ void dip204_printf_string(const char *format, ...)
  */
 static void dip204_select(void)
 {
+#if (defined DIP204_USE_SPI_QUEUE) && (DIP204_USE_SPI_QUEUE == true)
+  spi_queue_acquire();
+#endif
   spi_selectChip(DIP204_SPI, DIP204_SPI_NPCS);
 }
 
@@ -415,6 +447,28 @@ static void dip204_unselect(void)
 #endif
   spi_unselectChip(DIP204_SPI, DIP204_SPI_NPCS);
   Assert( SPI_OK==spi_status );
+#if (defined DIP204_USE_SPI_QUEUE) && (DIP204_USE_SPI_QUEUE == true)
+  spi_queue_release();
+#endif
+}
+
+
+/*! \brief DDRAM address of a cursor position
+ *
+ *  \param  column   Input. Column (from 1 to 20).
+ *  \param  line     Input. Line (from 1 to 4).
+ *
+ */
+static unsigned char dip204_cursor_address(unsigned char column, unsigned char line)
+{
+  unsigned char address = 0;
+
+  if ((column <= 20) && (line <= 4))
+  {
+    /* Calculate DDRAM address from line and row values */
+    address = ( (line-1) * 32 ) + ( column-1 ) + 128;
+  }
+  return address;
 }
 
 
@@ -467,6 +521,43 @@ static void dip204_write_byte(unsigned char byte)
 }
 
 
+/*! \brief build the SPI bytes of a start byte followed by a data byte
+ *
+ *  \param  frame  Output. 3 bytes to send
+ *  \param  start  Input. start byte (DIP204_WRITE_COMMAND or DIP204_WRITE_DATA)
+ *  \param  byte   Input. byte to write to the LCD (D7 .. D0)
+ *
+ */
+static void dip204_encode_frame(uint8_t frame[3], unsigned char start, unsigned char byte)
+{
+  unsigned char reverse = bit_reverse8(byte);
+
+  frame[0] = start;                   /* MSB first for the start byte */
+  frame[1] = reverse & 0xF0;          /* D0 to D3 */
+  frame[2] = (reverse << 4) & 0xF0;   /* D4 to D7 */
+}
+
+
+/*! \brief hardware abstraction layer to send a start byte and a data byte
+ *         to LCD in one SPI buffer transfer
+ *
+ *  \param  start  Input. start byte (DIP204_WRITE_COMMAND or DIP204_WRITE_DATA)
+ *  \param  byte   Input. byte to write to the LCD (D7 .. D0)
+ *
+ */
+static void dip204_write_frame(unsigned char start, unsigned char byte)
+{
+  uint8_t frame[3];
+
+  dip204_encode_frame(frame, start, byte);
+#ifdef _ASSERT_ENABLE_
+  spi_status =
+#endif
+  spi_write_buf(DIP204_SPI, frame, sizeof(frame));
+  Assert( SPI_OK==spi_status );
+}
+
+
 /*! \brief hardware abstraction layer to read a byte from LCD
  *         depends if LCD is plugged on SPI or on EBI
  *
@@ -62,6 +62,10 @@
  */
 
 #include "compiler.h"
+#include "conf_dip204.h"
+#if (defined DIP204_USE_SPI_QUEUE) && (DIP204_USE_SPI_QUEUE == true)
+#include "spi_queue.h"
+#endif
 
 
 /*! type for Backlight options : use PWM or IO to drive the backlight
@@ -155,6 +159,38 @@ extern void dip204_write_string(const char *string);
  */
 extern void dip204_printf_string(const char *format, ...);
 
+#if (defined DIP204_USE_SPI_QUEUE) && (DIP204_USE_SPI_QUEUE == true)
+/*! a character write executed from the SPI queue interrupt
+ *
+ */
+typedef struct {
+  uint8_t frame[8];
+  spi_queue_xfer_t xfer;
+} dip204_queue_job_t;
+
+/*! Set up queued writes, the blocking functions keep working alongside
+ *         (spi_queue_init() must have been called on DIP204_SPI)
+ *
+ * \param  options   Input. SPI options of the LCD chip select
+ * \param  pba_hz    Input. PBA clock frequency (Hz)
+ *
+ */
+extern void dip204_queue_init(const spi_options_t *options, uint32_t pba_hz);
+
+/*! Write a byte at given position without waiting for the SPI bus or the LCD,
+ *         may be called from an interrupt
+ *
+ * \param  job      Input. job holding the transfer until it is done
+ * \param  column   Input. Column where to write (from 1 to 20).
+ * \param  line     Input. Line where to write (from 1 to 4).
+ * \param  data     Input. data to display
+ *
+ * \return false if the job is still pending from a previous write
+ */
+extern bool dip204_queue_write_data(dip204_queue_job_t *job, unsigned char column,
+                                    unsigned char line, unsigned char data);
+#endif
+
 /**
  * \}
  */
@@ -741,6 +741,57 @@ uint8_t spi_readRegisterFullCheck(volatile avr32_spi_t *spi);
  */
 spi_status_t spi_read(volatile avr32_spi_t *spi, uint16_t *data);
 
+/** \brief Writes a buffer of 8-bit frames in master mode.
+ *
+ * TDR is reloaded as soon as it is empty, so the frames go out back-to-back.
+ * Received data is not read.
+ *
+ * \param spi   Base address of the SPI instance.
+ * \param data  Pointer to the bytes to send.
+ * \param len   Number of bytes to send.
+ *
+ * \return Status.
+ *   \retval SPI_OK             Success.
+ *   \retval SPI_ERROR_TIMEOUT  Time-out.
+ *
+ * \note The last frame may still be shifting out on return. Invoke
+ *       \ref spi_writeEndCheck if needed.
+ */
+spi_status_t spi_write_buf(volatile avr32_spi_t *spi, const uint8_t *data,
+		uint32_t len);
+
+/** \brief Reads a buffer of 8-bit frames in master mode.
+ *
+ * \a dummy is sent for each received byte. One frame is kept queued in TDR
+ * while the previous one is read back.
+ *
+ * \param spi   Base address of the SPI instance.
+ * \param data  Pointer to the location where to store the received bytes.
+ * \param len   Number of bytes to receive.
+ * \param dummy Byte sent while receiving.
+ *
+ * \return Status.
+ *   \retval SPI_OK             Success.
+ *   \retval SPI_ERROR_TIMEOUT  Time-out.
+ *   \retval SPI_ERROR_OVERRUN  A received byte was lost, e.g. because an
+ *                              interrupt delayed the loop for a frame time.
+ */
+spi_status_t spi_read_buf(volatile avr32_spi_t *spi, uint8_t *data,
+		uint32_t len, uint8_t dummy);
+
+/** \brief Full duplex transfer of a buffer of 8-bit frames in master mode.
+ *
+ * \param spi   Base address of the SPI instance.
+ * \param tx    Pointer to the bytes to send.
+ * \param rx    Pointer to the location where to store the received bytes
+ *              (may be the same as \a tx).
+ * \param len   Number of bytes to transfer.
+ *
+ * \return Status, see \ref spi_read_buf.
+ */
+spi_status_t spi_transfer_buf(volatile avr32_spi_t *spi, const uint8_t *tx,
+		uint8_t *rx, uint32_t len);
+
 /** \brief Gets status information from the SPI.
  *
  * \param spi Base address of the SPI instance.
@@ -0,0 +1,226 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief Interrupt driven SPI transaction queue.
+ *
+ ******************************************************************************/
+
+#include "spi_queue.h"
+#include "intc.h"
+#include "interrupt.h"
+
+/** SPI instance served by the queue. */
+static volatile avr32_spi_t *spi_queue_spi;
+
+/** PBA clock frequency used to program the chip selects. */
+static uint32_t spi_queue_pb_hz;
+
+/** Waiting transactions, in submission order. */
+static spi_queue_xfer_t *spi_queue_head;
+static spi_queue_xfer_t *spi_queue_tail;
+
+/** Transaction being clocked. */
+static spi_queue_xfer_t *volatile spi_queue_current;
+
+/** Device holding the chip select (keep_cs), NULL when released. */
+static const spi_queue_device_t *volatile spi_queue_owner;
+
+/** Chip select register of the owner before the queue programmed it. */
+static unsigned long spi_queue_saved_csr;
+
+/** Set while a blocking driver uses the bus. */
+static volatile bool spi_queue_locked;
+
+static void spi_queue_start(void);
+
+/** \brief Chip select register of a chip.
+ */
+static volatile unsigned long *spi_queue_csr(uint8_t chip)
+{
+	/* CSR0 to CSR3 are consecutive. */
+	return &spi_queue_spi->csr0 + chip;
+}
+
+/** \brief Ends the current transaction and starts the next one.
+ */
+static void spi_queue_finish(void)
+{
+	spi_queue_xfer_t *xfer = spi_queue_current;
+	uint8_t chip = xfer->device->options.reg;
+
+	spi_queue_current = NULL;
+
+	if (!xfer->keep_cs) {
+		spi_unselectChip(spi_queue_spi, chip);
+		/* Leave the chip select as the blocking drivers set it up. */
+		*spi_queue_csr(chip) = spi_queue_saved_csr;
+		spi_queue_owner = NULL;
+	}
+
+	xfer->busy = false;
+	if (xfer->callback) {
+		xfer->callback(xfer);
+	}
+
+	spi_queue_start();
+}
+
+/** \brief Starts the next transaction if the bus is free.
+ *
+ * Called with the queue interrupt masked.
+ */
+static void spi_queue_start(void)
+{
+	spi_queue_xfer_t *xfer;
+	spi_queue_xfer_t *prev = NULL;
+	uint8_t chip;
+
+	if (spi_queue_current || spi_queue_locked) {
+		return;
+	}
+
+	/* The device holding the chip select goes first. */
+	xfer = spi_queue_head;
+	if (spi_queue_owner) {
+		while (xfer && xfer->device != spi_queue_owner) {
+			prev = xfer;
+			xfer = xfer->next;
+		}
+	}
+
+	if (!xfer) {
+		return;
+	}
+
+	/* Unlink it. */
+	if (prev) {
+		prev->next = xfer->next;
+	} else {
+		spi_queue_head = xfer->next;
+	}
+	if (spi_queue_tail == xfer) {
+		spi_queue_tail = prev;
+	}
+	xfer->next = NULL;
+	xfer->pos = 0;
+
+	spi_queue_current = xfer;
+
+	if (spi_queue_owner != xfer->device) {
+		chip = xfer->device->options.reg;
+		spi_queue_saved_csr = *spi_queue_csr(chip);
+		spi_setupChipReg(spi_queue_spi, &xfer->device->options,
+				spi_queue_pb_hz);
+		spi_selectChip(spi_queue_spi, chip);
+		spi_queue_owner = xfer->device;
+	}
+
+	if (!xfer->len) {
+		spi_queue_finish();
+		return;
+	}
+
+	/* Drop a stale received byte, then send the first one. */
+	(void)spi_queue_spi->rdr;
+	spi_queue_spi->tdr = (xfer->tx ? xfer->tx[0] : xfer->dummy)
+			<< AVR32_SPI_TDR_TD_OFFSET;
+	spi_queue_spi->ier = AVR32_SPI_IER_RDRF_MASK;
+}
+
+/** \brief SPI interrupt: one byte received, send the next one.
+ *
+ * Only one byte is in flight so that a delayed interrupt cannot overrun RDR.
+ */
+__attribute__((__interrupt__))
+static void spi_queue_irq(void)
+{
+	spi_queue_xfer_t *xfer = spi_queue_current;
+	uint8_t data = spi_queue_spi->rdr >> AVR32_SPI_RDR_RD_OFFSET;
+
+	if (!xfer) {
+		spi_queue_spi->idr = AVR32_SPI_IDR_RDRF_MASK;
+		return;
+	}
+
+	if (xfer->rx) {
+		xfer->rx[xfer->pos] = data;
+	}
+
+	if (++xfer->pos < xfer->len) {
+		spi_queue_spi->tdr = (xfer->tx ? xfer->tx[xfer->pos] : xfer->dummy)
+				<< AVR32_SPI_TDR_TD_OFFSET;
+		return;
+	}
+
+	spi_queue_spi->idr = AVR32_SPI_IDR_RDRF_MASK;
+	spi_queue_finish();
+}
+
+void spi_queue_init(volatile avr32_spi_t *spi, uint32_t pb_hz,
+		uint32_t irq, uint32_t int_level)
+{
+	spi_queue_spi = spi;
+	spi_queue_pb_hz = pb_hz;
+	spi_queue_head = NULL;
+	spi_queue_tail = NULL;
+	spi_queue_current = NULL;
+	spi_queue_owner = NULL;
+
+	spi->idr = AVR32_SPI_IDR_RDRF_MASK;
+	INTC_register_interrupt(&spi_queue_irq, irq, int_level);
+}
+
+bool spi_queue_submit(spi_queue_xfer_t *xfer)
+{
+	irqflags_t flags = cpu_irq_save();
+
+	if (xfer->busy) {
+		cpu_irq_restore(flags);
+		return false;
+	}
+
+	xfer->busy = true;
+	xfer->next = NULL;
+	if (spi_queue_tail) {
+		spi_queue_tail->next = xfer;
+	} else {
+		spi_queue_head = xfer;
+	}
+	spi_queue_tail = xfer;
+
+	spi_queue_start();
+
+	cpu_irq_restore(flags);
+	return true;
+}
+
+bool spi_queue_is_idle(void)
+{
+	return !spi_queue_current && !spi_queue_head && !spi_queue_owner;
+}
+
+void spi_queue_acquire(void)
+{
+	irqflags_t flags;
+
+	while (true) {
+		flags = cpu_irq_save();
+		if (!spi_queue_current && !spi_queue_owner) {
+			spi_queue_locked = true;
+			cpu_irq_restore(flags);
+			return;
+		}
+		cpu_irq_restore(flags);
+	}
+}
+
+void spi_queue_release(void)
+{
+	irqflags_t flags = cpu_irq_save();
+
+	spi_queue_locked = false;
+	spi_queue_start();
+
+	cpu_irq_restore(flags);
+}
@@ -0,0 +1,130 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief Interrupt driven SPI transaction queue.
+ *
+ * Transactions from several devices on one SPI master are queued as
+ * descriptors and executed one byte per SPI interrupt, so that code running
+ * in an interrupt (or the main loop) can start a transfer without waiting
+ * for the bus.
+ *
+ ******************************************************************************/
+
+
+#ifndef _SPI_QUEUE_H_
+#define _SPI_QUEUE_H_
+
+/**
+ * \defgroup group_avr32_drivers_spi_queue SPI - Transaction queue
+ *
+ * \ingroup group_avr32_drivers_spi
+ *
+ * Each device on the bus is described by its chip select settings. A queued
+ * transaction programs these settings, selects the chip, clocks its buffers
+ * and calls its completion callback from the SPI interrupt.
+ *
+ * Blocking drivers sharing the bus bracket their transactions with
+ * \ref spi_queue_acquire and \ref spi_queue_release.
+ *
+ * \{
+ */
+
+#include <avr32/io.h>
+#include "compiler.h"
+#include "spi.h"
+
+/** \brief A device on the queued SPI bus. */
+typedef struct {
+	/** Chip select register settings, \a reg is the chip select. */
+	spi_options_t options;
+} spi_queue_device_t;
+
+struct spi_queue_xfer;
+
+/** \brief Completion callback, called from the SPI interrupt. */
+typedef void (*spi_queue_callback_t)(struct spi_queue_xfer *xfer);
+
+/** \brief A queued SPI transaction. */
+typedef struct spi_queue_xfer {
+	/** Device the transaction is sent to. */
+	const spi_queue_device_t *device;
+
+	/** Bytes to send, NULL to send \a dummy. */
+	const uint8_t *tx;
+
+	/** Location of the received bytes, NULL to drop them. */
+	uint8_t *rx;
+
+	/** Number of bytes to transfer. */
+	uint32_t len;
+
+	/** Byte sent when \a tx is NULL. */
+	uint8_t dummy;
+
+	/** Keep the chip selected after this transaction. The bus stays owned
+	 *  by the device until one of its transactions clears \a keep_cs,
+	 *  transactions of other devices wait meanwhile. */
+	bool keep_cs;
+
+	/** Called when the transaction is done (may be NULL). */
+	spi_queue_callback_t callback;
+
+	/** Free for the caller, e.g. for the callback. */
+	void *arg;
+
+	/** Set while the transaction is queued or running. */
+	volatile bool busy;
+
+	/** Queue link, private. */
+	struct spi_queue_xfer *next;
+
+	/** Bytes transferred so far, private. */
+	uint32_t pos;
+} spi_queue_xfer_t;
+
+/** \brief Initializes the queue on an SPI master.
+ *
+ * The SPI must already be initialized as master and enabled.
+ *
+ * \param spi       Base address of the SPI instance.
+ * \param pb_hz     SPI module input clock frequency (PBA clock, Hz).
+ * \param irq       IRQ number of the SPI instance.
+ * \param int_level Interrupt priority level.
+ */
+extern void spi_queue_init(volatile avr32_spi_t *spi, uint32_t pb_hz,
+		uint32_t irq, uint32_t int_level);
+
+/** \brief Queues a transaction.
+ *
+ * May be called from an interrupt. The descriptor and its buffers must stay
+ * valid until \a busy is cleared.
+ *
+ * \param xfer      Transaction to queue, must not be busy.
+ *
+ * \return \c false if the transaction is already queued.
+ */
+extern bool spi_queue_submit(spi_queue_xfer_t *xfer);
+
+/** \brief Tells if no transaction is queued or running.
+ */
+extern bool spi_queue_is_idle(void);
+
+/** \brief Takes the bus for a blocking driver.
+ *
+ * Waits for the running transaction (and a device holding its chip select)
+ * to finish, then holds queued transactions back until
+ * \ref spi_queue_release. Must not be called from an interrupt with a
+ * higher priority than the queue.
+ */
+extern void spi_queue_acquire(void);
+
+/** \brief Gives the bus back to the queue and starts pending transactions.
+ */
+extern void spi_queue_release(void);
+
+/**
+ * \}
+ */
+
+#endif  // _SPI_QUEUE_H_
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief Lock-free single producer, single consumer event ring.
+ *
+ * Hands timestamped events from one interrupt handler to the main loop (or
+ * the other way around) without masking interrupts: the producer only
+ * writes the head index, the consumer only writes the tail index.
+ *
+ ******************************************************************************/
+
+
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+/**
+ * \defgroup group_common_utils_spsc_ring SPSC event ring
+ *
+ * \ingroup group_common_utils
+ *
+ * The indexes run freely and are masked on access, so the ring size must be
+ * a power of two. A full ring drops the new event and counts it in
+ * \a overflows, \a high_water keeps the highest fill level seen.
+ *
+ * \{
+ */
+
+#include "compiler.h"
+
+/** \brief A timestamped event. */
+typedef struct {
+	/** Time of the event, the unit is up to the user. */
+	uint32_t timestamp;
+
+	/** Event data. */
+	uint32_t value;
+} spsc_event_t;
+
+/** \brief An event ring. */
+typedef struct {
+	/** Event storage, \a size entries. */
+	spsc_event_t *buffer;
+
+	/** Number of entries, a power of two. */
+	uint16_t size;
+
+	/** Next entry to write, written by the producer only. */
+	volatile uint16_t head;
+
+	/** Next entry to read, written by the consumer only. */
+	volatile uint16_t tail;
+
+	/** Highest number of pending events, written by the producer. */
+	volatile uint16_t high_water;
+
+	/** Events dropped because the ring was full, written by the producer. */
+	volatile uint32_t overflows;
+} spsc_ring_t;
+
+/** \brief Sets up an empty ring.
+ *
+ * Neither side may use the ring meanwhile.
+ *
+ * \param ring   Ring to set up.
+ * \param buffer Event storage.
+ * \param size   Number of events in \a buffer, a power of two.
+ */
+static inline void spsc_ring_init(spsc_ring_t *ring, spsc_event_t *buffer,
+		uint16_t size)
+{
+	Assert(size && !(size & (size - 1)));
+
+	ring->buffer = buffer;
+	ring->size = size;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->high_water = 0;
+	ring->overflows = 0;
+}
+
+/** \brief Number of pending events.
+ */
+static inline uint16_t spsc_ring_count(const spsc_ring_t *ring)
+{
+	return (uint16_t)(ring->head - ring->tail);
+}
+
+/** \brief Adds an event, producer side.
+ *
+ * \return \c false if the ring is full, the event is dropped.
+ */
+static inline bool spsc_ring_push(spsc_ring_t *ring, uint32_t timestamp,
+		uint32_t value)
+{
+	uint16_t head = ring->head;
+	uint16_t count = (uint16_t)(head - ring->tail);
+	spsc_event_t *event;
+
+	if (count >= ring->size) {
+		ring->overflows++;
+		return false;
+	}
+
+	event = &ring->buffer[head & (ring->size - 1)];
+	event->timestamp = timestamp;
+	event->value = value;
+
+	/* The event must be complete before the consumer can see it. */
+	barrier();
+	ring->head = head + 1;
+
+	if (count + 1 > ring->high_water) {
+		ring->high_water = count + 1;
+	}
+	return true;
+}
+
+/** \brief Takes the oldest event, consumer side.
+ *
+ * \return \c false if the ring is empty.
+ */
+static inline bool spsc_ring_pop(spsc_ring_t *ring, spsc_event_t *event)
+{
+	uint16_t tail = ring->tail;
+
+	if (tail == ring->head) {
+		return false;
+	}
+
+	*event = ring->buffer[tail & (ring->size - 1)];
+
+	/* The entry must be read before the producer can reuse it. */
+	barrier();
+	ring->tail = tail + 1;
+	return true;
+}
+
+/**
+ * \}
+ */
+
+#endif  // _SPSC_RING_H_
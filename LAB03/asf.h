@@ -79,6 +79,7 @@
 
 // From module: Interrupt management - UC3 implementation
 #include <interrupt.h>
+#include <spsc_ring.h>
 
 // From module: LCD Display - DIP204B-4ORT01
 #include <dip204.h>
@@ -91,6 +92,7 @@
 
 // From module: SPI - Serial Peripheral Interface
 #include <spi.h>
+#include <spi_queue.h>
 
 // From module: System Clock Control - UC3 A implementation
 #include <sysclk.h>
@@ -27,6 +27,11 @@
 #define APP_ADC_POT_FUNCTION  AVR32_ADC_AD_1_FUNCTION
 
 #define APP_READ_ADC_INTERVAL 50 // Hz
+#define APP_ADC_REQUESTS      4  // Queued readings, a power of two
+
+
+#define APP_LCD_SPI_IRQ       AVR32_SPI1_IRQ
+#define APP_LCD_SPI_PRIORITY  AVR32_INTC_INT1
 
 
 
@@ -121,4 +121,11 @@
 #endif
 //! @}
 
+/*! \name Queued writes
+ */
+//! @{
+//! Share the SPI bus with the interrupt driven SPI queue (spi_queue.h)
+#define DIP204_USE_SPI_QUEUE            true
+//! @}
+
 #endif // __CONF_DIP204_H__
@@ -36,8 +36,17 @@ volatile app_pwm_opt_t app_pwm_opt = APP_PWM_OPT_FREQUENCY;
 volatile uint16_t adc_pot_value = 0;
 
 
-// ADC update flag
-volatile bool update_adc_value = false;
+// ADC update requests from the TC interrupt, timestamped with the cycle
+// count. A request that finds the queue full is counted, not lost silently
+static spsc_event_t adc_request_buffer[APP_ADC_REQUESTS];
+static spsc_ring_t adc_requests;
+
+
+// Queued LCD writes for the PWM option marker (line 2 and 3)
+static dip204_queue_job_t lcd_marker_job[2];
+
+// Set by the push button when the marker must be redrawn
+volatile bool lcd_marker_update = false;
 
 
 
@@ -66,22 +75,21 @@ static void pwm_selection_irq(void)
 	// Check if interrupt flag is set
 	if (gpio_get_pin_interrupt_flag(GPIO_PUSH_BUTTON_0))
 	{
-		// Update selected PWM option on display
+		// Toggle selected PWM option
 		switch (app_pwm_opt)
 		{
 			case APP_PWM_OPT_FREQUENCY:
-			dip204_set_cursor_position(1, 2); dip204_write_data(' ');
-			dip204_set_cursor_position(1, 3); dip204_write_data(0xDF);
 			app_pwm_opt = APP_PWM_OPT_DUTYCYCLE;
 			break;
 
 			default:
-			dip204_set_cursor_position(1, 2); dip204_write_data(0xDF);
-			dip204_set_cursor_position(1, 3); dip204_write_data(' ');
 			app_pwm_opt = APP_PWM_OPT_FREQUENCY;
 			break;
 		}
 		
+		// The marker on the display is redrawn from the main loop
+		lcd_marker_update = true;
+		
 		// Toggle LED1 and LED2 to indicate selected option
 		LED_Toggle(LED1);
 		LED_Toggle(LED2);
@@ -102,8 +110,8 @@ static void pwm_selection_irq(void)
  *  tested and did not make any performance differences due to the
  *  update frequency.
  *  But since one usually want to keep the interrupt handler cycles to a
- *  bare minimum, this function just sets a flag and the update routines
- *  are handled in the main while loop.
+ *  bare minimum, this function just queues a request and the update
+ *  routines are handled in the main while loop.
  */
 __attribute__((__interrupt__))
 static void tc_read_pot_irq(void)
@@ -111,8 +119,8 @@ static void tc_read_pot_irq(void)
 	// Clear the interrupt flag.
 	tc_read_sr(APP_TC, APP_TC_CHANNEL);
 
-	// Set update ADC value flag to true for new reading
-	update_adc_value = true;
+	// Queue a new reading for the main loop
+	spsc_ring_push(&adc_requests, Get_sys_count(), 0);
 
 	// Toggle LED0 as a reading interval indicator
 	LED_Toggle(LED0);
@@ -133,6 +141,9 @@ static void app_interrupt_init(void)
 	// Initialize interrupt vectors.
 	INTC_init_interrupts();
 
+	// Empty ADC request queue
+	spsc_ring_init(&adc_requests, adc_request_buffer, APP_ADC_REQUESTS);
+
 	// Register the PB0 int handler with highest priority
 	gpio_enable_pin_interrupt(GPIO_PUSH_BUTTON_0, GPIO_RISING_EDGE);
 	INTC_register_interrupt(&pwm_selection_irq, (AVR32_GPIO_IRQ_0+88/8), AVR32_INTC_INT0);
@@ -443,6 +454,10 @@ static void app_lcd_init(void)
 	spi_enable(DIP204_SPI);
 	spi_setupChipReg(DIP204_SPI, &spiOptions, sysclk_get_pba_hz());
 
+	// Interrupt driven SPI queue, shared with the blocking LCD functions
+	spi_queue_init(DIP204_SPI, sysclk_get_pba_hz(), APP_LCD_SPI_IRQ, APP_LCD_SPI_PRIORITY);
+	dip204_queue_init(&spiOptions, sysclk_get_pba_hz());
+
 	// Initialize LCD DIP204, using IO as backlight instead of PWM
 	dip204_init(backlight_IO, true);
 	dip204_hide_cursor();
@@ -482,6 +497,32 @@ static void app_read_adc(void)
 }
 
 
+/*
+ * Update PWM option marker
+ *
+ *  Queues the LCD writes of the option marker after the push
+ *  button changed the option. A write is tried again on the
+ *  next call while its job is still pending from the last one.
+ */
+static void app_update_marker(void)
+{
+	static uint8_t pending = 0;
+	bool frequency;
+	
+	if (lcd_marker_update)
+	{
+		lcd_marker_update = false;
+		pending = 0x3;
+	}
+	if (!pending) return;
+	
+	// The option may change again meanwhile, the last one is drawn
+	frequency = (app_pwm_opt == APP_PWM_OPT_FREQUENCY);
+	if ((pending & 0x1) && dip204_queue_write_data(&lcd_marker_job[0], 1, 2, frequency ? 0xDF : ' ')) pending &= ~0x1;
+	if ((pending & 0x2) && dip204_queue_write_data(&lcd_marker_job[1], 1, 3, frequency ? ' ' : 0xDF)) pending &= ~0x2;
+}
+
+
 /*
  * Main app function
  *
@@ -541,20 +582,22 @@ int main(void)
 	// Main while loop
 	while (true)
 	{
-		// Checks if the update flag is set
-		if (update_adc_value)
+		spsc_event_t request;
+
+		// Handles every queued reading request
+		while (spsc_ring_pop(&adc_requests, &request))
 		{
 			// Indicate update
 			LED_On(LED5); 
 			
 			// Update the ADC value
 			app_read_adc();
-			
-			// Reset update flag
-			update_adc_value = false;
 	
 			LED_Off(LED5);
 		}
+		
+		// Redraws the PWM option marker
+		app_update_marker();
 	}
 
 }
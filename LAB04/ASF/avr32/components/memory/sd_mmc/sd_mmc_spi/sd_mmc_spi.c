@@ -57,8 +57,12 @@
 #include "board.h"
 #include "gpio.h"
 #include "spi.h"
+#include "sysclk.h"
 #include "conf_sd_mmc_spi.h"
 #include "sd_mmc_spi.h"
+#if (defined SD_MMC_SPI_USE_PDCA) && (SD_MMC_SPI_USE_PDCA == true)
+#include "pdca.h"
+#endif
 #include <string.h>
 
 
@@ -66,6 +70,14 @@
 
 #define        NO_SUPPORT_USB_PING_PONG                     // defines if USB endpoints do not support ping pong mode
 
+// Number of reads of a register (CSD, CID, switch status) when a received frame is lost
+#define        SD_MMC_SPI_REG_READ_RETRY    3
+
+// Longest busy phase of a written block, in ms (SD: 250, SDXC: 500)
+#ifndef SD_MMC_SPI_WRITE_TIMEOUT_MS
+#define        SD_MMC_SPI_WRITE_TIMEOUT_MS  500
+#endif
+
 
 /*_____ D E F I N I T I O N ________________________________________________*/
 
@@ -74,6 +86,28 @@ static uint8_t   sector_buf[MMC_SECTOR_SIZE];  // Sector buffer
 static spi_options_t sd_mmc_opt;
 static unsigned int sd_mmc_pba_hz;
 
+// Busy phase of the last written block, advanced by sd_mmc_spi_async_task()
+static volatile bool              sd_mmc_spi_async_busy = false;
+static volatile uint32_t          sd_mmc_spi_async_start_count;
+static sd_mmc_spi_callback_t      sd_mmc_spi_async_callback;
+// A busy phase without callback timed out, reported by sd_mmc_spi_wait_not_busy()
+static volatile bool              sd_mmc_spi_async_failed = false;
+
+static void sd_mmc_spi_async_wait(void);
+
+// SPI clock currently programmed for the card
+static uint32_t sd_mmc_spi_clock_hz;
+
+// CSD TRAN_SPEED decoding: time value (x10) and transfer rate unit (in 10 bit/s)
+static const uint8_t  sd_mmc_spi_tran_speed_value[16] =
+{
+  0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80
+};
+static const uint32_t sd_mmc_spi_tran_speed_unit[4] =
+{
+  10000, 100000, 1000000, 10000000
+};
+
 bool  sd_mmc_spi_init_done = false;
 uint8_t   r1;
 uint16_t  r2;
@@ -91,9 +125,157 @@ volatile  uint32_t  sd_mmc_spi_last_block_address;  // stores the address of the
           uint8_t   cid[16];
 #endif
 
+#if (defined SD_MMC_SPI_USE_PDCA) && (SD_MMC_SPI_USE_PDCA == true)
+// 0xFF source clocked out by the PDCA TX channel while a block is received
+COMPILER_WORD_ALIGNED static const uint8_t sd_mmc_spi_dummy_block[MMC_SECTOR_SIZE] =
+{
+#define DUMMY_8_BYTES(line, unused)  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  MREPEAT(64, DUMMY_8_BYTES, ~)
+#undef DUMMY_8_BYTES
+};
+#endif
+
 
 /*_____ D E C L A R A T I O N ______________________________________________*/
 
+//!
+//! @brief This function decodes the maximum data transfer rate of the card
+//!        from the TRAN_SPEED field of the CSD.
+//!
+//! @return uint32_t
+//!         maximum SPI clock in Hz, the identification clock (400 kHz)
+//!         if the time value is reserved
+static uint32_t sd_mmc_spi_get_tran_speed(void)
+{
+  uint8_t tran_speed = csd[3];
+  uint8_t unit = tran_speed & 0x07;
+  uint8_t value = (tran_speed >> 3) & 0x0F;
+
+  if (value == 0)   // reserved (or a corrupt CSD), keep the clock the card was identified at
+    return 400000;
+  if (unit > 3)     // reserved units, take the fastest defined one
+    unit = 3;
+
+  return sd_mmc_spi_tran_speed_value[value] * sd_mmc_spi_tran_speed_unit[unit];
+}
+
+//!
+//! @brief This function programs the fastest SPI clock not above max_hz,
+//!        SD_MMC_SPI_MASTER_SPEED and what the PBA divider can produce.
+//!
+//! @param  max_hz    highest clock accepted by the card
+static void sd_mmc_spi_set_clock(uint32_t max_hz)
+{
+  uint32_t div;
+
+  if (max_hz > SD_MMC_SPI_MASTER_SPEED)
+    max_hz = SD_MMC_SPI_MASTER_SPEED;
+
+  // smallest SCBR divider keeping SPCK at or below max_hz
+  div = div_ceil(sd_mmc_pba_hz, max_hz);
+  if (div == 0)
+    div = 1;
+  else if (div > 255)
+  {
+    div = 255;
+    max_hz = div_ceil(sd_mmc_pba_hz, div);
+  }
+
+  sd_mmc_opt.baudrate = max_hz;
+  spi_setupChipReg(SD_MMC_SPI, &sd_mmc_opt, sd_mmc_pba_hz);
+  sd_mmc_spi_clock_hz = sd_mmc_pba_hz / div;
+}
+
+//!
+//! @brief This function returns the SPI clock negotiated with the card.
+//!
+//! @return uint32_t
+//!         SPCK frequency in Hz
+uint32_t sd_mmc_spi_get_clock(void)
+{
+  return sd_mmc_spi_clock_hz;
+}
+
+#if (defined SD_MMC_SPI_HIGH_SPEED) && (SD_MMC_SPI_HIGH_SPEED == true)
+//!
+//! @brief This function sends a SWITCH_FUNC command (CMD6) and reads back the
+//!        64 bytes switch status.
+//!
+//! @param  arg       mode and function selection of CMD6
+//! @param  status    buffer for the switch status (64 bytes)
+//!
+//! @return bit
+//!         true / false
+static bool sd_mmc_spi_switch_func(uint32_t arg, uint8_t *status)
+{
+  uint16_t retry;
+  uint8_t attempt = 0;
+  spi_status_t spi_status;
+
+  // wait for MMC not busy
+  if (false == sd_mmc_spi_wait_not_busy())
+    return false;
+
+sd_mmc_spi_switch_func_retry:
+  spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);    // select SD_MMC_SPI
+  // issue command
+  r1 = sd_mmc_spi_command(SD_SWITCH_FUNC, arg);
+  // check for valid response
+  if(r1 != 0x00)
+  {
+    spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+    return false;
+  }
+  // wait for block start
+  retry = 0;
+  while((r1 = sd_mmc_spi_send_and_read(0xFF)) != MMC_STARTBLOCK_READ)
+  {
+    if (retry > 30000)
+    {
+      spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+      return false;
+    }
+    retry++;
+  }
+  // store switch status
+  spi_status = spi_read_buf(SD_MMC_SPI, status, 64, 0xFF);
+  spi_write(SD_MMC_SPI,0xFF);   // load CRC (not used)
+  spi_write(SD_MMC_SPI,0xFF);
+  spi_write(SD_MMC_SPI,0xFF);   // give clock again to end transaction
+  spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+  if (spi_status != SPI_OK)
+  {
+    // a frame was lost (overrun), the status is read again
+    if (++attempt < SD_MMC_SPI_REG_READ_RETRY)
+      goto sd_mmc_spi_switch_func_retry;
+    return false;
+  }
+  return true;
+}
+
+//!
+//! @brief This function switches a SD card to high speed mode (up to 50 MHz)
+//!        if its function group 1 supports it.
+//!
+//! @return bit
+//!   The card is in high speed mode   -> true
+static bool sd_mmc_spi_switch_high_speed(void)
+{
+  uint8_t status[64];
+
+  // check mode: is high speed (function 1 of group 1) supported ?
+  if (false == sd_mmc_spi_switch_func(0x00FFFFF1, status))
+    return false;
+  if ((status[13] & 0x02) == 0)
+    return false;
+
+  // switch mode, then check that group 1 now runs function 1
+  if (false == sd_mmc_spi_switch_func(0x80FFFFF1, status))
+    return false;
+  return ((status[16] & 0x0F) == 0x01);
+}
+#endif
+
 //!
 //! @brief This function initializes the SD/MMC controller.
 //!
@@ -106,9 +288,11 @@ bool sd_mmc_spi_internal_init(void)
   int i;
   int if_cond;
 
-  // Start at low frequency
-  sd_mmc_opt.baudrate = 400000;
-  spi_setupChipReg(SD_MMC_SPI, &sd_mmc_opt, sd_mmc_pba_hz);
+  // a write may still be programming if the card is initialized again
+  sd_mmc_spi_async_wait();
+
+  // Start at low frequency (identification mode)
+  sd_mmc_spi_set_clock(400000);
 
   /* card needs 74 cycles minimum to start up */
   spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);    // select SD_MMC_SPI
@@ -228,9 +412,19 @@ bool sd_mmc_spi_internal_init(void)
 
   sd_mmc_spi_init_done = true;
 
-  // Set SPI Speed to MAX
-  sd_mmc_opt.baudrate = SD_MMC_SPI_MASTER_SPEED;
-  spi_setupChipReg(SD_MMC_SPI, &sd_mmc_opt, sd_mmc_pba_hz);
+#if (defined SD_MMC_SPI_HIGH_SPEED) && (SD_MMC_SPI_HIGH_SPEED == true)
+  // SWITCH TO HIGH SPEED if the card (command class 10) and the bus can go above 25 MHz
+  if ((card_type != MMC_CARD) && (csd[4] & 0x40) &&
+      (sd_mmc_pba_hz > 25000000) && (SD_MMC_SPI_MASTER_SPEED > 25000000))
+  {
+    // TRAN_SPEED of the CSD is updated by the switch
+    if (sd_mmc_spi_switch_high_speed() && (false == sd_mmc_spi_get_csd(csd)))
+      return false;
+  }
+#endif
+
+  // Set SPI Speed to the card maximum (TRAN_SPEED)
+  sd_mmc_spi_set_clock(sd_mmc_spi_get_tran_speed());
   return true;
 }
 
@@ -246,6 +440,30 @@ bool sd_mmc_spi_init(spi_options_t spiOptions, unsigned int pba_hz)
   sd_mmc_pba_hz = pba_hz;
   memcpy( &sd_mmc_opt, &spiOptions, sizeof(spi_options_t) );
 
+#if (defined SD_MMC_SPI_USE_PDCA) && (SD_MMC_SPI_USE_PDCA == true)
+  // Paired PDCA channels for the data phase of sector transfers
+  const pdca_channel_options_t pdca_options_rx =
+  {
+    .addr          = NULL,
+    .size          = 0,
+    .r_addr        = NULL,
+    .r_size        = 0,
+    .pid           = SD_MMC_SPI_PDCA_RX_PID,
+    .transfer_size = PDCA_TRANSFER_SIZE_BYTE
+  };
+  const pdca_channel_options_t pdca_options_tx =
+  {
+    .addr          = NULL,
+    .size          = 0,
+    .r_addr        = NULL,
+    .r_size        = 0,
+    .pid           = SD_MMC_SPI_PDCA_TX_PID,
+    .transfer_size = PDCA_TRANSFER_SIZE_BYTE
+  };
+  pdca_init_channel(SD_MMC_SPI_PDCA_RX_CHANNEL, &pdca_options_rx);
+  pdca_init_channel(SD_MMC_SPI_PDCA_TX_CHANNEL, &pdca_options_tx);
+#endif
+
   // Initialize the SD/MMC controller.
   return sd_mmc_spi_internal_init();
 }
@@ -261,6 +479,8 @@ bool sd_mmc_spi_init(spi_options_t spiOptions, unsigned int pba_hz)
 //!         R1 response (R1 == 0xFF if time out error)
 uint8_t sd_mmc_spi_send_command(uint8_t command, uint32_t arg)
 {
+  sd_mmc_spi_async_wait();
+
   spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);    // select SD_MMC_SPI
   r1 = sd_mmc_spi_command(command, arg);
   spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
@@ -299,6 +519,10 @@ uint8_t sd_mmc_spi_command(uint8_t command, uint32_t arg)
          break;
   }
 
+  // CMD12 is followed by a stuff byte which must not be taken as R1
+  if (command == MMC_STOP_TRANSMISSION)
+    spi_write(SD_MMC_SPI, 0xFF);
+
   // end command
   // wait for response
   // if more than 8 retries, card has timed-out and return the received 0xFF
@@ -413,11 +637,13 @@ int sd_mmc_spi_check_hc(void)
 bool sd_mmc_spi_get_csd(uint8_t *buffer)
 {
 uint8_t retry;
-unsigned short data_read;
+uint8_t attempt = 0;
+spi_status_t spi_status;
   // wait for MMC not busy
   if (false == sd_mmc_spi_wait_not_busy())
     return false;
 
+sd_mmc_spi_get_csd_retry:
   spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);    // select SD_MMC_SPI
   // issue command
   r1 = sd_mmc_spi_command(MMC_SEND_CSD, 0);
@@ -440,16 +666,18 @@ unsigned short data_read;
     retry++;
   }
   // store valid data block
-  for (retry = 0; retry <16; retry++)
-  {
-   spi_write(SD_MMC_SPI,0xFF);
-   spi_read(SD_MMC_SPI,&data_read);
-    buffer[retry] = data_read;
-  }
+  spi_status = spi_read_buf(SD_MMC_SPI, buffer, 16, 0xFF);
    spi_write(SD_MMC_SPI,0xFF);   // load CRC (not used)
    spi_write(SD_MMC_SPI,0xFF);
    spi_write(SD_MMC_SPI,0xFF);   // give clock again to end transaction
   spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+  if (spi_status != SPI_OK)
+  {
+    // a frame was lost (overrun), the CSD is read again
+    if (++attempt < SD_MMC_SPI_REG_READ_RETRY)
+      goto sd_mmc_spi_get_csd_retry;
+    return false;
+  }
   return true;
 }
 
@@ -464,11 +692,13 @@ unsigned short data_read;
 bool sd_mmc_spi_get_cid(uint8_t *buffer)
 {
 uint8_t retry;
-unsigned short data_read;
+uint8_t attempt = 0;
+spi_status_t spi_status;
   // wait for MMC not busy
   if (false == sd_mmc_spi_wait_not_busy())
     return false;
 
+sd_mmc_spi_get_cid_retry:
   spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // select SD_MMC_SPI
   // issue command
   r1 = sd_mmc_spi_command(MMC_SEND_CID, 0);
@@ -491,16 +721,18 @@ unsigned short data_read;
     retry++;
   }
   // store valid data block
-  for (retry = 0; retry <16; retry++)
-  {
-   spi_write(SD_MMC_SPI,0xFF);
-   spi_read(SD_MMC_SPI,&data_read);
-   buffer[retry] = data_read;
-  }
+  spi_status = spi_read_buf(SD_MMC_SPI, buffer, 16, 0xFF);
   spi_write(SD_MMC_SPI,0xFF);   // load CRC (not used)
   spi_write(SD_MMC_SPI,0xFF);
   spi_write(SD_MMC_SPI,0xFF);   // give clock again to end transaction
   spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+  if (spi_status != SPI_OK)
+  {
+    // a frame was lost (overrun), the CID is read again
+    if (++attempt < SD_MMC_SPI_REG_READ_RETRY)
+      goto sd_mmc_spi_get_cid_retry;
+    return false;
+  }
   return true;
 }
 
@@ -621,8 +853,96 @@ bool     sd_mmc_spi_get_status(void)
 }
 
 
+//!
+//! @brief This function hands the busy phase of a written block over to
+//!        sd_mmc_spi_async_task() instead of waiting for it.
+//!
+//! @param callback   function called once the card is ready (may be NULL)
+static void sd_mmc_spi_async_start(sd_mmc_spi_callback_t callback)
+{
+  sd_mmc_spi_async_start_count = Get_sys_count();
+  sd_mmc_spi_async_callback = callback;
+  sd_mmc_spi_async_busy = true;
+}
+
+//!
+//! @brief This function samples the card busy signal once and completes the
+//!        pending write when the card has released MISO, or fails it
+//!        SD_MMC_SPI_WRITE_TIMEOUT_MS after the block was sent.
+//!        The callback is called from here, i.e. possibly from an interrupt,
+//!        with the interrupts restored.
+//!
+void sd_mmc_spi_async_task(void)
+{
+  sd_mmc_spi_callback_t callback;
+  bool status;
+  uint8_t busy;
+  irqflags_t flags;
+  uint32_t timeout = sysclk_get_cpu_hz() / 1000 * SD_MMC_SPI_WRITE_TIMEOUT_MS;
+
+  if (!sd_mmc_spi_async_busy)
+    return;
+
+  // the main context and the interrupt context may both poll
+  flags = cpu_irq_save();
+
+  if (!sd_mmc_spi_async_busy)
+  {
+    cpu_irq_restore(flags);
+    return;
+  }
+
+  spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);
+  busy = sd_mmc_spi_send_and_read(0xFF);
+  spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);
+
+  if (busy == 0xFF)
+    status = true;
+  else if (Get_sys_count() - sd_mmc_spi_async_start_count >= timeout)
+    status = false;
+  else
+  {
+    cpu_irq_restore(flags);
+    return;
+  }
+
+  callback = sd_mmc_spi_async_callback;
+  sd_mmc_spi_async_callback = NULL;
+  sd_mmc_spi_async_busy = false;
+
+  if (!callback && !status)
+    sd_mmc_spi_async_failed = true;
+
+  cpu_irq_restore(flags);
+
+  if (callback)
+    callback(status);
+}
+
+//!
+//! @brief This function tells if a written block is still being programmed.
+//!
+//! @return bit
+//!          true while the card is busy with a block written asynchronously
+bool sd_mmc_spi_async_is_busy(void)
+{
+  return sd_mmc_spi_async_busy;
+}
+
+//!
+//! @brief This function completes a pending asynchronous write before the
+//!        bus is used for anything else.
+//!
+static void sd_mmc_spi_async_wait(void)
+{
+  while (sd_mmc_spi_async_busy)
+    sd_mmc_spi_async_task();
+}
+
 //!
 //! @brief This function waits until the SD/MMC is not busy.
+//!        A background write that failed without a callback to report to is
+//!        reported here, once.
 //!
 //! @return bit
 //!          true when card is not busy
@@ -630,6 +950,14 @@ bool sd_mmc_spi_wait_not_busy(void)
 {
   uint32_t retry;
 
+  // finish a write left programming in the background first
+  sd_mmc_spi_async_wait();
+  if (sd_mmc_spi_async_failed)
+  {
+    sd_mmc_spi_async_failed = false;
+    return false;
+  }
+
   // Select the SD_MMC memory gl_ptr_mem points to
   spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);
   retry = 0;
@@ -660,6 +988,8 @@ bool sd_mmc_spi_check_presence(void)
 {
   uint16_t retry;
 
+  sd_mmc_spi_async_wait();
+
   retry = 0;
   if (sd_mmc_spi_init_done == false)
   {
@@ -804,10 +1134,7 @@ bool sd_mmc_spi_lock_operation(uint8_t operation, uint8_t pwd_lg, uint8_t * pwd)
   if (operation != OP_FORCED_ERASE)
   {
   spi_write(SD_MMC_SPI,pwd_lg);
-    for(retry=0 ; retry<pwd_lg ; retry++)
-    {
-      spi_write(SD_MMC_SPI,*(pwd+retry));
-    }
+    spi_write_buf(SD_MMC_SPI, pwd, pwd_lg);
   }
   spi_write(SD_MMC_SPI,0xFF);    // send CRC (field required but value ignored)
   spi_write(SD_MMC_SPI,0xFF);
@@ -910,6 +1237,213 @@ void sd_mmc_spi_write_close (void)
 
 }
 
+#if (defined SD_MMC_SPI_DATA_BITS) && (SD_MMC_SPI_DATA_BITS == 16)
+  #define SD_MMC_SPI_DATA_16  true
+#else
+  #define SD_MMC_SPI_DATA_16  false
+#endif
+
+//!
+//! @brief This function sets the SPI frame size (and the PDCA transfer size)
+//!        used for the data phase. The SPI shifter must be idle.
+//!
+//! @param bits        8 or 16
+static void sd_mmc_spi_set_frame_bits(uint8_t bits)
+{
+  spi_set_bits_per_transfer(SD_MMC_SPI, SD_MMC_SPI_NPCS, bits);
+#if (defined SD_MMC_SPI_USE_PDCA) && (SD_MMC_SPI_USE_PDCA == true)
+  // a halfword read from memory holds its first byte in the MSB on AVR32,
+  // which is also the first bit out on the bus: no swapping is needed
+  pdca_set_transfer_size(SD_MMC_SPI_PDCA_RX_CHANNEL, (bits > 8) ? PDCA_TRANSFER_SIZE_HALF_WORD : PDCA_TRANSFER_SIZE_BYTE);
+  pdca_set_transfer_size(SD_MMC_SPI_PDCA_TX_CHANNEL, (bits > 8) ? PDCA_TRANSFER_SIZE_HALF_WORD : PDCA_TRANSFER_SIZE_BYTE);
+#endif
+}
+
+//!
+//! @brief This function clocks in the 512 data bytes of a block.
+//!        The PDCA is used when SD_MMC_SPI_USE_PDCA is true, with the TX
+//!        channel sending 0xFF dummy bytes to generate the clock.
+//!
+//! @param ram         pointer to ram buffer (512 bytes)
+//!
+//! @return bit
+//!   The block has been received            -> true
+//!   A frame has been lost (overrun)        -> false
+static bool sd_mmc_spi_rx_block(uint8_t *ram)
+{
+  // 16-bit frames need halfword accesses to the buffer
+  bool wide = SD_MMC_SPI_DATA_16 && !((uint32_t)ram & 0x1);
+  bool status = true;
+
+  if (wide)
+    sd_mmc_spi_set_frame_bits(16);
+
+#if (defined SD_MMC_SPI_USE_PDCA) && (SD_MMC_SPI_USE_PDCA == true)
+  // drop any byte left in RDR so that the RX channel starts on the first data byte
+  (void)SD_MMC_SPI->rdr;
+
+  pdca_load_channel(SD_MMC_SPI_PDCA_RX_CHANNEL, ram, wide ? MMC_SECTOR_SIZE / 2 : MMC_SECTOR_SIZE);
+  pdca_load_channel(SD_MMC_SPI_PDCA_TX_CHANNEL, (void *)sd_mmc_spi_dummy_block, wide ? MMC_SECTOR_SIZE / 2 : MMC_SECTOR_SIZE);
+
+  // RX first so that no received byte can be missed
+  pdca_enable(SD_MMC_SPI_PDCA_RX_CHANNEL);
+  pdca_enable(SD_MMC_SPI_PDCA_TX_CHANNEL);
+
+  // the last byte received means the last dummy byte has been shifted out
+  while (!(pdca_get_transfer_status(SD_MMC_SPI_PDCA_RX_CHANNEL) & PDCA_TRANSFER_COMPLETE));
+
+  pdca_disable(SD_MMC_SPI_PDCA_TX_CHANNEL);
+  pdca_disable(SD_MMC_SPI_PDCA_RX_CHANNEL);
+#else
+  if (wide)
+    status = (spi_read_packed16(SD_MMC_SPI, ram, MMC_SECTOR_SIZE, 0xFFFF) == SPI_OK);
+  else
+    status = (spi_read_buf(SD_MMC_SPI, ram, MMC_SECTOR_SIZE, 0xFF) == SPI_OK);
+#endif
+
+  if (wide)
+    sd_mmc_spi_set_frame_bits(sd_mmc_opt.bits);
+
+  return status;
+}
+
+//!
+//! @brief This function clocks out the 512 data bytes of a block.
+//!        The PDCA is used when SD_MMC_SPI_USE_PDCA is true.
+//!
+//! @param ram         pointer to ram buffer (512 bytes)
+static void sd_mmc_spi_tx_block(const uint8_t *ram)
+{
+  // 16-bit frames need halfword accesses to the buffer
+  bool wide = SD_MMC_SPI_DATA_16 && !((uint32_t)ram & 0x1);
+
+  if (wide)
+  {
+    // the start token must be out before the frame size changes
+    while (!spi_writeEndCheck(SD_MMC_SPI));
+    sd_mmc_spi_set_frame_bits(16);
+  }
+
+#if (defined SD_MMC_SPI_USE_PDCA) && (SD_MMC_SPI_USE_PDCA == true)
+  pdca_load_channel(SD_MMC_SPI_PDCA_TX_CHANNEL, (void *)ram, wide ? MMC_SECTOR_SIZE / 2 : MMC_SECTOR_SIZE);
+  pdca_enable(SD_MMC_SPI_PDCA_TX_CHANNEL);
+
+  // the channel completes when the last byte is loaded in TDR,
+  // wait for the shifter too before the CRC is sent
+  while (!(pdca_get_transfer_status(SD_MMC_SPI_PDCA_TX_CHANNEL) & PDCA_TRANSFER_COMPLETE));
+  while (!spi_writeEndCheck(SD_MMC_SPI));
+
+  pdca_disable(SD_MMC_SPI_PDCA_TX_CHANNEL);
+#else
+  if (wide)
+  {
+    spi_write_packed16(SD_MMC_SPI, ram, MMC_SECTOR_SIZE);
+    while (!spi_writeEndCheck(SD_MMC_SPI));
+  }
+  else
+    spi_write_buf(SD_MMC_SPI, ram, MMC_SECTOR_SIZE);
+#endif
+
+  if (wide)
+    sd_mmc_spi_set_frame_bits(sd_mmc_opt.bits);
+}
+
+//!
+//! @brief This function waits for a data block start token and stores the
+//!        following block in a ram buffer.
+//!        The memory /CS signal is not affected so this function can be used
+//!        inside a single or a multiple block read transaction
+//!
+//! @param ram         pointer to ram buffer (512 bytes)
+//!
+//! @return bit
+//!   A data block has been received         -> true
+//!   Time-out, data error token or lost byte -> false
+static bool sd_mmc_spi_read_block_data(uint8_t *ram)
+{
+  uint16_t  read_time_out;
+
+  // wait for token (may be a datablock start token OR a data error token !)
+  read_time_out = 30000;
+  while((r1 = sd_mmc_spi_send_and_read(0xFF)) == 0xFF)
+  {
+     read_time_out--;
+     if (read_time_out == 0)   // TIME-OUT
+       return false;
+  }
+
+  // check token
+  if (r1 != MMC_STARTBLOCK_READ)
+    return false;
+
+  // store datablock
+  if (false == sd_mmc_spi_rx_block(ram))
+  {
+    // a data byte was lost, the block must not be used
+    spi_write(SD_MMC_SPI,0xFF);
+    spi_write(SD_MMC_SPI,0xFF);
+    return false;
+  }
+  gl_ptr_mem += 512;     // Update the memory pointer.
+
+  // load 16-bit CRC (ignored)
+  spi_write(SD_MMC_SPI,0xFF);
+  spi_write(SD_MMC_SPI,0xFF);
+
+  return true;
+}
+
+//!
+//! @brief This function starts a multiple block read (CMD18) at the current
+//!        memory pointer. The memory is left selected on success.
+//!
+//! @return bit
+//!   The card accepted the command   -> true
+static bool sd_mmc_spi_read_multiple_open(void)
+{
+  // wait for MMC not busy
+  if (false == sd_mmc_spi_wait_not_busy())
+    return false;
+
+  spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);    // select SD_MMC_SPI
+
+  // issue command
+  if(card_type == SD_CARD_2_SDHC) {
+    r1 = sd_mmc_spi_command(MMC_READ_MULTIPLE_BLOCK, gl_ptr_mem>>9);
+  } else {
+    r1 = sd_mmc_spi_command(MMC_READ_MULTIPLE_BLOCK, gl_ptr_mem);
+  }
+
+  // check for valid response
+  if (r1 != 0x00)
+  {
+    spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+    return false;
+  }
+  return true;
+}
+
+//!
+//! @brief This function ends a multiple block read with a STOP_TRANSMISSION
+//!        command and releases the memory.
+//!
+//! @return bit
+//!   The card answered and is not busy   -> true
+static bool sd_mmc_spi_read_multiple_close(void)
+{
+  // the card may already be sending the next block, CMD12 aborts it
+  r1 = sd_mmc_spi_command(MMC_STOP_TRANSMISSION, 0);
+  spi_write(SD_MMC_SPI,0xFF);            // write dummy byte
+  spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+
+  // some cards flag the prefetch past the last block as out of range,
+  // so only a missing response is considered as an error
+  if (r1 == 0xFF)
+    return false;
+
+  return sd_mmc_spi_wait_not_busy();
+}
+
 //!
 //! @brief This function allow to read multiple sectors
 //!
@@ -918,13 +1452,195 @@ void sd_mmc_spi_write_close (void)
 //!   The read succeeded      -> true
 bool sd_mmc_spi_read_multiple_sector(uint16_t nb_sector)
 {
+  bool status = true;
+
+  if (nb_sector == 0)
+    return true;
+
+  // The card keeps streaming blocks until MMC_STOP_TRANSMISSION is sent
+  if (false == sd_mmc_spi_read_multiple_open())
+    return false;
+
   while (nb_sector--)
   {
     // Read the next sector
-    sd_mmc_spi_read_sector_to_ram(sector_buf);
+    if (false == sd_mmc_spi_read_block_data(sector_buf))
+    {
+      status = false;
+      break;
+    }
     sd_mmc_spi_read_multiple_sector_callback(sector_buf);
   }
 
+  if (false == sd_mmc_spi_read_multiple_close())
+    return false;
+
+  return status;
+}
+
+//!
+//! @brief This function reads several contiguous MMC sectors into a ram buffer
+//!        using one READ_MULTIPLE_BLOCK command
+//!
+//!         DATA FLOW is: SD/MMC => RAM
+//!
+//!
+//! NOTE:
+//!   - Must be preceded by a call to the sd_mmc_spi_read_open() function
+//!
+//! @param ram         pointer to ram buffer (nb_sector * 512 bytes)
+//! @param nb_sector   the number of sector to read
+//!
+//! @return bit
+//!   The read succeeded   -> true
+//!   The read failed (bad address, etc.)  -> false
+//!/
+bool sd_mmc_spi_read_multiple_sector_to_ram(void *ram, uint16_t nb_sector)
+{
+  uint8_t *_ram = ram;
+  bool status = true;
+
+  if (nb_sector == 0)
+    return true;
+
+  // A single sector does not need the stop transmission overhead
+  if (nb_sector == 1)
+    return sd_mmc_spi_read_sector_to_ram(ram);
+
+  if (false == sd_mmc_spi_read_multiple_open())
+    return false;
+
+  while (nb_sector--)
+  {
+    if (false == sd_mmc_spi_read_block_data(_ram))
+    {
+      status = false;
+      break;
+    }
+    _ram += MMC_SECTOR_SIZE;
+  }
+
+  if (false == sd_mmc_spi_read_multiple_close())
+    return false;
+
+  return status;
+}
+
+//!
+//! @brief This function waits while the card holds MISO low (busy) without
+//!        releasing the memory /CS signal.
+//!
+//! @return bit
+//!   The card is ready   -> true
+static bool sd_mmc_spi_wait_not_busy_selected(void)
+{
+  uint32_t retry = 0;
+
+  while((r1 = sd_mmc_spi_send_and_read(0xFF)) != 0xFF)
+  {
+    retry++;
+    if (retry == 200000)
+      return false;
+  }
+  return true;
+}
+
+//!
+//! @brief This function starts a multiple block write (CMD25) at the current
+//!        memory pointer. SD cards are first told how many blocks will follow
+//!        (ACMD23) so that they can pre-erase them.
+//!        The memory is left selected on success.
+//!
+//! @param  nb_sector   the number of sector that will be written
+//!
+//! @return bit
+//!   The card accepted the command   -> true
+static bool sd_mmc_spi_write_multiple_open(uint16_t nb_sector)
+{
+  // wait for MMC not busy
+  if (false == sd_mmc_spi_wait_not_busy())
+    return false;
+
+#if (defined SD_MMC_SPI_PRE_ERASE) && (SD_MMC_SPI_PRE_ERASE == true)
+  // pre-erase hint, a rejected ACMD23 does not prevent the write
+  if (card_type != MMC_CARD)
+  {
+    sd_mmc_spi_send_command(SD_APP_CMD55, 0);
+    sd_mmc_spi_send_command(SD_SET_WR_BLK_ERASE_COUNT_ACMD, nb_sector);
+  }
+#else
+  UNUSED(nb_sector);
+#endif
+
+  spi_selectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);    // select SD_MMC_SPI
+
+  // issue command
+  if(card_type == SD_CARD_2_SDHC) {
+    r1 = sd_mmc_spi_command(MMC_WRITE_MULTIPLE_BLOCK, gl_ptr_mem>>9);
+  } else {
+    r1 = sd_mmc_spi_command(MMC_WRITE_MULTIPLE_BLOCK, gl_ptr_mem);
+  }
+
+  // check for valid response
+  if(r1 != 0x00)
+  {
+    spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);
+    return false;
+  }
+  // send dummy
+  spi_write(SD_MMC_SPI,0xFF);   // give clock again to end transaction
+
+  return true;
+}
+
+//!
+//! @brief This function sends one data block of a multiple block write and
+//!        waits for the card to program it.
+//!        The memory /CS signal is not affected.
+//!
+//! @param ram         pointer to ram buffer (512 bytes)
+//!
+//! @return bit
+//!   The block has been accepted and programmed   -> true
+static bool sd_mmc_spi_write_block_data(const uint8_t *ram)
+{
+  // send data start token
+  spi_write(SD_MMC_SPI,MMC_STARTBLOCK_MWRITE);
+  // write data
+  sd_mmc_spi_tx_block(ram);
+
+  spi_write(SD_MMC_SPI,0xFF);    // send CRC (field required but value ignored)
+  spi_write(SD_MMC_SPI,0xFF);
+
+  // read data response token
+  r1 = sd_mmc_spi_send_and_read(0xFF);
+  if( (r1&MMC_DR_MASK) != MMC_DR_ACCEPT)
+    return false;
+
+  gl_ptr_mem += 512;        // Update the memory pointer.
+
+  // the next token may only be sent once the card has released MISO
+  return sd_mmc_spi_wait_not_busy_selected();
+}
+
+//!
+//! @brief This function ends a multiple block write with the stop token and
+//!        releases the memory while the card programs the last block.
+//!
+//! @return bit
+//!   always true, a programming error is reported by the next
+//!   sd_mmc_spi_wait_not_busy()
+static bool sd_mmc_spi_write_multiple_close(void)
+{
+  spi_write(SD_MMC_SPI,MMC_STOPTRAN_WRITE);
+  spi_write(SD_MMC_SPI,0xFF);    // Nwr byte before the busy signal
+
+  // release chip select
+  spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
+
+  // let the card program the last block in the background
+  sd_mmc_spi_async_start(NULL);
+
   return true;
 }
 
@@ -936,14 +1652,77 @@ bool sd_mmc_spi_read_multiple_sector(uint16_t nb_sector)
 //!   The write succeeded      -> true
 bool sd_mmc_spi_write_multiple_sector(uint16_t nb_sector)
 {
+  bool status = true;
+
+  if (nb_sector == 0)
+    return true;
+
+  // All sectors go out in one transaction ended by the stop token
+  if (false == sd_mmc_spi_write_multiple_open(nb_sector))
+    return false;
+
   while (nb_sector--)
   {
     // Write the next sector
     sd_mmc_spi_write_multiple_sector_callback(sector_buf);
-    sd_mmc_spi_write_sector_from_ram(sector_buf);
+    if (false == sd_mmc_spi_write_block_data(sector_buf))
+    {
+      status = false;
+      break;
+    }
   }
 
-  return true;
+  if (false == sd_mmc_spi_write_multiple_close())
+    return false;
+
+  return status;
+}
+
+//! @brief This function writes several contiguous MMC sectors from a ram
+//!        buffer using one WRITE_MULTIPLE_BLOCK command
+//!
+//!         DATA FLOW is: RAM => SD/MMC
+//!
+//!
+//! NOTE:
+//!   - Must be preceded by a call to the sd_mmc_spi_write_open() function
+//!
+//! @param ram         pointer to ram buffer (nb_sector * 512 bytes)
+//! @param nb_sector   the number of sector to write
+//!
+//! @return bit
+//!   The write succeeded   -> true
+//!   The write failed      -> false
+//!
+bool sd_mmc_spi_write_multiple_sector_from_ram(const void *ram, uint16_t nb_sector)
+{
+  const uint8_t *_ram = ram;
+  bool status = true;
+
+  if (nb_sector == 0)
+    return true;
+
+  // A single sector does not need the multiple block overhead
+  if (nb_sector == 1)
+    return sd_mmc_spi_write_sector_from_ram(ram);
+
+  if (false == sd_mmc_spi_write_multiple_open(nb_sector))
+    return false;
+
+  while (nb_sector--)
+  {
+    if (false == sd_mmc_spi_write_block_data(_ram))
+    {
+      status = false;
+      break;
+    }
+    _ram += MMC_SECTOR_SIZE;
+  }
+
+  if (false == sd_mmc_spi_write_multiple_close())
+    return false;
+
+  return status;
 }
 
 //! @brief  This function erase a group of sectors
@@ -1126,10 +1905,6 @@ bool sd_mmc_spi_read_open_PDCA (uint32_t pos)
 //!/
 bool sd_mmc_spi_read_sector_to_ram(void *ram)
 {
-  uint8_t *_ram = ram;
-  uint16_t  i;
-  uint16_t  read_time_out;
-  unsigned short data_read;
   // wait for MMC not busy
   if (false == sd_mmc_spi_wait_not_busy())
     return false;
@@ -1150,39 +1925,14 @@ bool sd_mmc_spi_read_sector_to_ram(void *ram)
     return false;
   }
 
-  // wait for token (may be a datablock start token OR a data error token !)
-  read_time_out = 30000;
-  while((r1 = sd_mmc_spi_send_and_read(0xFF)) == 0xFF)
-  {
-     read_time_out--;
-     if (read_time_out == 0)   // TIME-OUT
-     {
-       spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS); // unselect SD_MMC_SPI
-       return false;
-     }
-  }
-
-  // check token
-  if (r1 != MMC_STARTBLOCK_READ)
+  // wait for token and store datablock
+  if (false == sd_mmc_spi_read_block_data(ram))
   {
     spi_write(SD_MMC_SPI,0xFF);
     spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
     return false;
   }
 
-  // store datablock
-  for(i=0;i<MMC_SECTOR_SIZE;i++)
-  {
-    spi_write(SD_MMC_SPI,0xFF);
-    spi_read(SD_MMC_SPI,&data_read);
-    *_ram++=data_read;
-  }
-  gl_ptr_mem += 512;     // Update the memory pointer.
-
-  // load 16-bit CRC (ignored)
-  spi_write(SD_MMC_SPI,0xFF);
-  spi_write(SD_MMC_SPI,0xFF);
-
   // continue delivering some clock cycles
   spi_write(SD_MMC_SPI,0xFF);
   spi_write(SD_MMC_SPI,0xFF);
@@ -1202,7 +1952,8 @@ bool sd_mmc_spi_read_sector_to_ram(void *ram)
 //! NOTE (please read) :
 //!   - First call (if sequential write) must be preceded by a call to the sd_mmc_spi_write_open() function
 //!   - An address error will not detected here, but with the call of sd_mmc_spi_get_status() function
-//!   - The program exits the functions with the memory card busy !
+//!   - The program exits the functions with the memory card busy, the busy
+//!     phase is completed by sd_mmc_spi_async_task() or the next access !
 //!
 //! @param ram         pointer to ram buffer
 //!
@@ -1210,11 +1961,8 @@ bool sd_mmc_spi_read_sector_to_ram(void *ram)
 //!   The write succeeded   -> true
 //!   The write failed      -> false
 //!
-bool sd_mmc_spi_write_sector_from_ram(const void *ram)
+static bool sd_mmc_spi_write_block(const void *ram, sd_mmc_spi_callback_t callback)
 {
-  const uint8_t *_ram = ram;
-  uint16_t i;
-
   // wait for MMC not busy
   if (false == sd_mmc_spi_wait_not_busy())
     return false;
@@ -1240,10 +1988,7 @@ bool sd_mmc_spi_write_sector_from_ram(const void *ram)
   // send data start token
   spi_write(SD_MMC_SPI,MMC_STARTBLOCK_WRITE);
   // write data
-  for(i=0;i<MMC_SECTOR_SIZE;i++)
-  {
-    spi_write(SD_MMC_SPI,*_ram++);
-  }
+  sd_mmc_spi_tx_block(ram);
 
   spi_write(SD_MMC_SPI,0xFF);    // send CRC (field required but value ignored)
   spi_write(SD_MMC_SPI,0xFF);
@@ -1265,17 +2010,42 @@ bool sd_mmc_spi_write_sector_from_ram(const void *ram)
   spi_unselectChip(SD_MMC_SPI, SD_MMC_SPI_NPCS);  // unselect SD_MMC_SPI
   gl_ptr_mem += 512;        // Update the memory pointer.
 
-  // wait card not busy after last programming operation
-  i=0;
-  while (false == sd_mmc_spi_wait_not_busy())
-  {
-    i++;
-    if (i == 10)
-      return false;
-  }
+  // the card is programming now, the next access (or sd_mmc_spi_async_task()) waits for it
+  sd_mmc_spi_async_start(callback);
 
   return true;                  // Write done
 }
 
+bool sd_mmc_spi_write_sector_from_ram(const void *ram)
+{
+  return sd_mmc_spi_write_block(ram, NULL);
+}
+
+//!
+//! @brief This function writes one sector and returns as soon as the card has
+//!        accepted the data, without waiting for the programming time.
+//!        The busy phase is polled by sd_mmc_spi_async_task(), which calls
+//!        callback (if not NULL) with the final status.
+//!
+//! @param sector      sector address to write
+//! @param ram         pointer to ram buffer, only read before this function returns
+//! @param callback    completion function, may run in interrupt context
+//!
+//! @return bit
+//!   The data was accepted by the card      -> true
+//!   The card is still busy or write failed -> false
+//!
+bool sd_mmc_spi_write_sector_async(uint32_t sector, const void *ram, sd_mmc_spi_callback_t callback)
+{
+  // only one block can be programming at a time
+  if (sd_mmc_spi_async_busy)
+    return false;
+
+  if (false == sd_mmc_spi_write_open(sector))
+    return false;
+
+  return sd_mmc_spi_write_block(ram, callback);
+}
+
 
 #endif  // SD_MMC_SPI_MEM == ENABLE
@@ -104,14 +104,18 @@
 // MMC commands (taken from MMC reference)
 #define MMC_GO_IDLE_STATE                 0     ///< initialize card to SPI-type access
 #define MMC_SEND_OP_COND                  1     ///< set card operational mode
+#define SD_SWITCH_FUNC                    6     ///< check or switch card function (high speed)
 #define MMC_CMD2                          2     ///< illegal in SPI mode !
 #define MMC_SEND_IF_COND                  8
 #define MMC_SEND_CSD                      9     ///< get card's CSD
 #define MMC_SEND_CID                      10    ///< get card's CID
+#define MMC_STOP_TRANSMISSION             12    ///< stop a multiple block read
 #define MMC_SEND_STATUS                   13
 #define MMC_SET_BLOCKLEN                  16    ///< Set number of bytes to transfer per block
 #define MMC_READ_SINGLE_BLOCK             17    ///< read a block
+#define MMC_READ_MULTIPLE_BLOCK           18    ///< read blocks until MMC_STOP_TRANSMISSION
 #define MMC_WRITE_BLOCK                   24    ///< write a block
+#define MMC_WRITE_MULTIPLE_BLOCK          25    ///< write blocks until MMC_STOPTRAN_WRITE token
 #define MMC_PROGRAM_CSD                   27
 #define MMC_SET_WRITE_PROT                28
 #define MMC_CLR_WRITE_PROT                29
@@ -125,6 +129,7 @@
 #define MMC_TAG_ERASE_GROUP_END           36    ///< Sets end of erase group (mass erase)
 #define MMC_UNTAG_ERASE_GROUP             37    ///< Untag (unset) erase group (mass erase)
 #define MMC_ERASE                         38    ///< Perform block/mass erase
+#define SD_SET_WR_BLK_ERASE_COUNT_ACMD    23              ///< Number of blocks to pre-erase before a multiple block write (must be preceded by CMD55)
 #define SD_SEND_OP_COND_ACMD              41              ///< Same as MMC_SEND_OP_COND but specific to SD (must be preceded by CMD55)
 #define MMC_LOCK_UNLOCK                   42              ///< To start a lock/unlock/pwd operation
 #define SD_APP_CMD55                      55              ///< Use before any specific command (type ACMD)
@@ -163,6 +168,9 @@
 
 #define SD_FAILURE                       -1
 #define SD_MMC                            0
+
+//! Completion callback of an asynchronous operation, status is false on time-out
+typedef void (*sd_mmc_spi_callback_t)(bool status);
 /*_____ D E C L A R A T I O N ______________________________________________*/
 
 //! Low-level functions (basic management)
@@ -180,6 +188,7 @@ extern bool sd_mmc_spi_get_status(void);                       // read the statu
 extern uint8_t   sd_mmc_spi_send_and_read(uint8_t);            // send a byte on SPI and returns the received byte
 extern uint8_t   sd_mmc_spi_send_command(uint8_t, uint32_t);   // send a single command + argument (R1 response expected and returned), with memory select then unselect
 extern uint8_t   sd_mmc_spi_command(uint8_t, uint32_t);        // send a command + argument (R1 response expected and returned), without memory select/unselect
+extern uint32_t  sd_mmc_spi_get_clock(void);                   // SPI clock in Hz negotiated with the card (TRAN_SPEED, SD_MMC_SPI_MASTER_SPEED and PBA)
 
 //! Protection functions (optionnal)
 extern bool is_sd_mmc_spi_write_pwd_locked(void);                    // check if the lock protection on the card is featured and enabled
@@ -208,9 +217,16 @@ bit     sd_mmc_spi_host_read_sector (uint16_t);
 
 //! Functions to read/write one sector (512btes) with ram buffer pointer
 extern bool sd_mmc_spi_read_sector_to_ram(void *ram);     // reads a data block and send it to a buffer (512b)
+extern bool sd_mmc_spi_read_multiple_sector_to_ram(void *ram, uint16_t nb_sector);  // reads nb_sector data blocks with one CMD18 (nb_sector*512b)
 extern bool sd_mmc_spi_write_sector_from_ram(const void *ram);  // writes a data block from a buffer (512b)
+extern bool sd_mmc_spi_write_multiple_sector_from_ram(const void *ram, uint16_t nb_sector);  // writes nb_sector data blocks with one CMD25 (nb_sector*512b)
 extern bool sd_mmc_spi_erase_sector_group(uint32_t, uint32_t);    // erase a group of sectors defined by start and end address (details in sd_mmc_spi.c)
 
+//! Functions to write without waiting for the card programming time
+extern bool sd_mmc_spi_write_sector_async(uint32_t sector, const void *ram, sd_mmc_spi_callback_t callback);  // writes a data block, callback is invoked once the card is no longer busy
+extern bool sd_mmc_spi_async_is_busy(void);    // true while the card is programming a block written without waiting
+extern void sd_mmc_spi_async_task(void);       // polls the card busy state once, call periodically (TC interrupt or main loop)
+
 
 //!functions used to make a transfer from SD_MMC to RAM using the PDCA
 //Max reading size is block
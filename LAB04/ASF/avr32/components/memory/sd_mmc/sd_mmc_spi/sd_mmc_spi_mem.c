@@ -283,14 +283,15 @@ Ctrl_status sd_mmc_spi_usb_write_10(uint32_t addr, uint16_t nb_sector)
    if (sd_mmc_spi_init_done)
    {
      Sd_mmc_spi_access_signal_on();
-     sd_mmc_spi_write_open(addr);
-     status = sd_mmc_spi_write_multiple_sector(nb_sector);
+     // The whole run of sectors is sent as one multiple block write
+     status = sd_mmc_spi_write_open(addr)
+           && sd_mmc_spi_write_multiple_sector(nb_sector);
      sd_mmc_spi_write_close();
      Sd_mmc_spi_access_signal_off();
      if (status)
        return CTRL_GOOD;
      else
-       return CTRL_NO_PRESENT;
+       return CTRL_FAIL;
    }
    else
      return CTRL_NO_PRESENT;
@@ -356,6 +357,51 @@ sd_mmc_spi_mem_2_ram_fail:
 }
 
 
+//! This function reads several contiguous sectors from SD/MMC to a ram
+//! buffer with one multiple block read command
+//!
+//!         DATA FLOW is: SD/MMC => RAM
+//!
+//! (sector = 512B)
+//! @param addr         Sector address to start the read from
+//! @param nb_sector    Number of sectors to transfer
+//! @param ram          Ram buffer pointer (nb_sector * 512B)
+//!
+//! @return                Ctrl_status
+//!   It is ready      ->    CTRL_GOOD
+//!   An error occurs  ->    CTRL_FAIL
+//!
+Ctrl_status sd_mmc_spi_mem_2_ram_multi(uint32_t addr, uint16_t nb_sector, void *ram)
+{
+   Sd_mmc_spi_access_signal_on();
+   sd_mmc_spi_check_presence();
+
+   if (!sd_mmc_spi_init_done)
+   {
+      sd_mmc_spi_mem_init();
+   }
+
+   if (!sd_mmc_spi_init_done)
+     return CTRL_NO_PRESENT;
+
+   if( !sd_mmc_spi_read_open(addr) )
+     goto sd_mmc_spi_mem_2_ram_multi_fail;
+
+   if( !sd_mmc_spi_read_multiple_sector_to_ram(ram, nb_sector))
+     goto sd_mmc_spi_mem_2_ram_multi_fail;
+
+   if( !sd_mmc_spi_read_close() )
+     goto sd_mmc_spi_mem_2_ram_multi_fail;
+
+   Sd_mmc_spi_access_signal_off();
+   return CTRL_GOOD;
+
+sd_mmc_spi_mem_2_ram_multi_fail:
+   Sd_mmc_spi_access_signal_off();
+   return CTRL_FAIL;
+}
+
+
 //! This function initializes the memory for a write operation
 //! from ram buffer to SD/MMC (1 sector)
 //!
@@ -381,12 +427,56 @@ Ctrl_status    sd_mmc_spi_ram_2_mem(uint32_t addr, const void *ram)
 
    if (sd_mmc_spi_init_done)
    {
-     sd_mmc_spi_write_open(addr);
-     if (!sd_mmc_spi_write_sector_from_ram(ram))
+     // write_open also reports a failed background write of the previous block
+     if (!sd_mmc_spi_write_open(addr)
+      || !sd_mmc_spi_write_sector_from_ram(ram))
+     {
+       sd_mmc_spi_write_close();
+       Sd_mmc_spi_access_signal_off();
+       return CTRL_FAIL;
+     }
+     sd_mmc_spi_write_close();
+     Sd_mmc_spi_access_signal_off();
+     return CTRL_GOOD;
+   }
+   Sd_mmc_spi_access_signal_off();
+
+   return CTRL_NO_PRESENT;
+}
+
+
+//! This function writes several contiguous sectors from a ram buffer to
+//! SD/MMC with one multiple block write command
+//!
+//!         DATA FLOW is: RAM => SD/MMC
+//!
+//! (sector = 512B)
+//! @param addr         Sector address to start the write at
+//! @param nb_sector    Number of sectors to transfer
+//! @param ram          Ram buffer pointer (nb_sector * 512B)
+//!
+//! @return                Ctrl_status
+//!   It is ready      ->    CTRL_GOOD
+//!   An error occurs  ->    CTRL_FAIL
+//!
+Ctrl_status    sd_mmc_spi_ram_2_mem_multi(uint32_t addr, uint16_t nb_sector, const void *ram)
+{
+   Sd_mmc_spi_access_signal_on();
+   sd_mmc_spi_check_presence();
+
+   if (!sd_mmc_spi_init_done)
+   {
+      sd_mmc_spi_mem_init();
+   }
+
+   if (sd_mmc_spi_init_done)
+   {
+     if (!sd_mmc_spi_write_open(addr)
+      || !sd_mmc_spi_write_multiple_sector_from_ram(ram, nb_sector))
      {
        sd_mmc_spi_write_close();
        Sd_mmc_spi_access_signal_off();
-       return CTRL_NO_PRESENT;
+       return CTRL_FAIL;
      }
      sd_mmc_spi_write_close();
      Sd_mmc_spi_access_signal_off();
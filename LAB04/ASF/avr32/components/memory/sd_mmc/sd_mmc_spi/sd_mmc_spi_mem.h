@@ -177,6 +177,22 @@ extern Ctrl_status    sd_mmc_spi_usb_write_10(uint32_t addr, uint16_t nb_sector)
 //!
 extern Ctrl_status    sd_mmc_spi_mem_2_ram(uint32_t addr, void *ram);
 
+//! This function reads several contiguous sectors from SD/MMC to a ram
+//! buffer with one multiple block read command
+//!
+//!         DATA FLOW is: SD/MMC => RAM
+//!
+//! (sector = 512B)
+//! @param addr         Sector address to start the read from
+//! @param nb_sector    Number of sectors to transfer
+//! @param ram          Ram buffer pointer (nb_sector * 512B)
+//!
+//! @return                Ctrl_status
+//!   It is ready      ->    CTRL_GOOD
+//!   An error occurs  ->    CTRL_FAIL
+//!
+extern Ctrl_status    sd_mmc_spi_mem_2_ram_multi(uint32_t addr, uint16_t nb_sector, void *ram);
+
 //! This function initializes the memory for a write operation
 //! from ram buffer to SD/MMC (1 sector)
 //!
@@ -192,6 +208,22 @@ extern Ctrl_status    sd_mmc_spi_mem_2_ram(uint32_t addr, void *ram);
 //!
 extern Ctrl_status    sd_mmc_spi_ram_2_mem(uint32_t addr, const void *ram);
 
+//! This function writes several contiguous sectors from a ram buffer to
+//! SD/MMC with one multiple block write command
+//!
+//!         DATA FLOW is: RAM => SD/MMC
+//!
+//! (sector = 512B)
+//! @param addr         Sector address to start the write at
+//! @param nb_sector    Number of sectors to transfer
+//! @param ram          Ram buffer pointer (nb_sector * 512B)
+//!
+//! @return                Ctrl_status
+//!   It is ready      ->    CTRL_GOOD
+//!   An error occurs  ->    CTRL_FAIL
+//!
+extern Ctrl_status    sd_mmc_spi_ram_2_mem_multi(uint32_t addr, uint16_t nb_sector, const void *ram);
+
 #endif // end #if ACCESS_MEM_TO_RAM == true
 
 /**
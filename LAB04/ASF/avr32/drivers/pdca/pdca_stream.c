@@ -0,0 +1,171 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief PDCA streaming over a ring of buffers.
+ *
+ ******************************************************************************/
+
+#include "pdca_stream.h"
+#include "intc.h"
+#include "interrupt.h"
+#include "preprocessor.h"
+
+/** Stream running on each channel. */
+static pdca_stream_t *pdca_stream_of[PDCA_STREAM_NB_CHANNELS];
+
+/** \brief Index of the buffer following \a index in the ring.
+ */
+static inline uint8_t pdca_stream_next(const pdca_stream_t *stream,
+		uint8_t index)
+{
+	return (index + 1 < stream->nb_buffers) ? index + 1 : 0;
+}
+
+/** \brief Puts the next free buffer in the reload registers.
+ *
+ * Without a free buffer the transfer complete interrupt is used instead to
+ * catch the end of the current buffer. Called with interrupts masked.
+ */
+static void pdca_stream_arm(pdca_stream_t *stream)
+{
+	if (stream->armed || stream->stalled) {
+		return;
+	}
+
+	/* The buffer being transferred and the delivered ones are busy. */
+	if (stream->owned + 2 <= stream->nb_buffers) {
+		pdca_reload_channel(stream->channel,
+				stream->buffers[pdca_stream_next(stream, stream->fill)],
+				stream->size);
+		stream->armed = true;
+		pdca_disable_interrupt_transfer_complete(stream->channel);
+		pdca_enable_interrupt_reload_counter_zero(stream->channel);
+	} else {
+		/* RCZ stays set while the reload counter is zero. */
+		pdca_disable_interrupt_reload_counter_zero(stream->channel);
+		pdca_enable_interrupt_transfer_complete(stream->channel);
+	}
+}
+
+/** \brief Channel interrupt: a buffer is complete.
+ */
+static void pdca_stream_handler(pdca_stream_t *stream)
+{
+	uint32_t status = pdca_get_transfer_status(stream->channel);
+	uint8_t done = stream->fill;
+
+	if (stream->armed && (status & PDCA_TRANSFER_COUNTER_RELOAD_IS_ZERO)) {
+		/* The reload buffer took over, the previous one is complete. */
+		stream->armed = false;
+	} else if (!stream->armed && (status & PDCA_TRANSFER_COMPLETE)) {
+		/* No buffer was ready in time, the channel stopped. */
+		pdca_disable_interrupt_transfer_complete(stream->channel);
+		stream->stalled = true;
+		stream->overruns++;
+	} else {
+		return;
+	}
+
+	stream->fill = pdca_stream_next(stream, done);
+	stream->owned++;
+	stream->buffers_done++;
+	pdca_stream_arm(stream);
+
+	if (stream->callback) {
+		stream->callback(stream, stream->buffers[done]);
+	}
+}
+
+#define PDCA_STREAM_IRQ(ch, unused) \
+	__attribute__((__interrupt__)) \
+	static void pdca_stream_irq_##ch(void) \
+	{ \
+		pdca_stream_handler(pdca_stream_of[ch]); \
+	}
+MREPEAT(PDCA_STREAM_NB_CHANNELS, PDCA_STREAM_IRQ, ~)
+#undef PDCA_STREAM_IRQ
+
+#define PDCA_STREAM_IRQ_ENTRY(ch, unused)  pdca_stream_irq_##ch,
+static void (*const pdca_stream_irq[PDCA_STREAM_NB_CHANNELS])(void) =
+{
+	MREPEAT(PDCA_STREAM_NB_CHANNELS, PDCA_STREAM_IRQ_ENTRY, ~)
+};
+#undef PDCA_STREAM_IRQ_ENTRY
+
+int32_t pdca_stream_init(pdca_stream_t *stream, uint32_t int_level)
+{
+	const pdca_channel_options_t options = {
+		.addr          = NULL,
+		.size          = 0,
+		.r_addr        = NULL,
+		.r_size        = 0,
+		.pid           = stream->pid,
+		.transfer_size = stream->transfer_size
+	};
+
+	if (stream->channel >= PDCA_STREAM_NB_CHANNELS ||
+			stream->nb_buffers < 2 || !stream->size) {
+		return PDCA_INVALID_ARGUMENT;
+	}
+
+	pdca_init_channel(stream->channel, &options);
+
+	stream->armed = false;
+	stream->stalled = false;
+	pdca_stream_of[stream->channel] = stream;
+
+	INTC_register_interrupt(pdca_stream_irq[stream->channel],
+			AVR32_PDCA_IRQ_0 + stream->channel, int_level);
+
+	return PDCA_SUCCESS;
+}
+
+void pdca_stream_start(pdca_stream_t *stream)
+{
+	irqflags_t flags = cpu_irq_save();
+
+	stream->fill = 0;
+	stream->owned = 0;
+	stream->armed = false;
+	stream->stalled = false;
+	stream->buffers_done = 0;
+	stream->overruns = 0;
+
+	pdca_load_channel(stream->channel, stream->buffers[0], stream->size);
+	pdca_stream_arm(stream);
+	pdca_enable(stream->channel);
+
+	cpu_irq_restore(flags);
+}
+
+void pdca_stream_stop(pdca_stream_t *stream)
+{
+	irqflags_t flags = cpu_irq_save();
+
+	pdca_disable(stream->channel);
+	pdca_disable_interrupt_reload_counter_zero(stream->channel);
+	pdca_disable_interrupt_transfer_complete(stream->channel);
+	stream->armed = false;
+
+	cpu_irq_restore(flags);
+}
+
+void pdca_stream_release(pdca_stream_t *stream)
+{
+	irqflags_t flags = cpu_irq_save();
+
+	if (stream->owned) {
+		stream->owned--;
+	}
+
+	if (stream->stalled) {
+		/* The released buffer is the one after the last completed. */
+		stream->stalled = false;
+		pdca_load_channel(stream->channel, stream->buffers[stream->fill],
+				stream->size);
+	}
+	pdca_stream_arm(stream);
+
+	cpu_irq_restore(flags);
+}
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief PDCA streaming over a ring of buffers.
+ *
+ * A channel is kept running over a ring of equally sized buffers: while one
+ * buffer is transferred the next one waits in the reload registers, so there
+ * is no gap between buffers. The reload counter zero interrupt hands the
+ * completed buffer to a callback and arms the next one.
+ *
+ ******************************************************************************/
+
+
+#ifndef _PDCA_STREAM_H_
+#define _PDCA_STREAM_H_
+
+/**
+ * \defgroup group_avr32_drivers_pdca_stream PDCA - Streaming ring
+ *
+ * \ingroup group_avr32_drivers_pdca
+ *
+ * Works for both directions:
+ *  - peripheral to memory (ADC, SPI RX, USART RX): the callback gets a
+ *    buffer full of data;
+ *  - memory to peripheral (SPI TX, USART TX): the callback gets a buffer
+ *    that has been sent and may be refilled. All buffers must hold data
+ *    before \ref pdca_stream_start.
+ *
+ * A delivered buffer belongs to the consumer until
+ * \ref pdca_stream_release gives it back, buffers are released in the order
+ * they were delivered. When no released buffer is left the channel stops at
+ * the end of the current buffer, this is counted in \a overruns and the
+ * stream restarts on the next release.
+ *
+ * \{
+ */
+
+#include <avr32/io.h>
+#include "compiler.h"
+#include "pdca.h"
+
+//! Number of PDCA channels that can run a stream (channels 0 to n-1).
+#ifndef PDCA_STREAM_NB_CHANNELS
+#define PDCA_STREAM_NB_CHANNELS   8
+#endif
+
+struct pdca_stream;
+
+/** \brief Buffer completion callback, called from the PDCA interrupt. */
+typedef void (*pdca_stream_callback_t)(struct pdca_stream *stream,
+		void *buffer);
+
+/** \brief A streaming PDCA channel. */
+typedef struct pdca_stream {
+	/** PDCA channel number. */
+	uint8_t channel;
+
+	/** Peripheral ID, see the AVR32_PDCA_PID_ defines. */
+	uint32_t pid;
+
+	/** Transfer size, e.g. \ref PDCA_TRANSFER_SIZE_HALF_WORD. */
+	uint32_t transfer_size;
+
+	/** Ring of buffers. */
+	void *const *buffers;
+
+	/** Number of buffers in the ring (2 or more). */
+	uint8_t nb_buffers;
+
+	/** Number of transfers per buffer. */
+	uint32_t size;
+
+	/** Called for each completed buffer (may be NULL). */
+	pdca_stream_callback_t callback;
+
+	/** Free for the caller, e.g. for the callback. */
+	void *arg;
+
+	/** Buffers completed since \ref pdca_stream_start. */
+	volatile uint32_t buffers_done;
+
+	/** Number of times the channel stopped for lack of a free buffer. */
+	volatile uint32_t overruns;
+
+	/** Index of the buffer being transferred, private. */
+	volatile uint8_t fill;
+
+	/** Buffers delivered and not released yet, private. */
+	volatile uint8_t owned;
+
+	/** Set when the next buffer is in the reload registers, private. */
+	volatile bool armed;
+
+	/** Set when the channel stopped for lack of a buffer, private. */
+	volatile bool stalled;
+} pdca_stream_t;
+
+/** \brief Sets up a stream and registers its interrupt.
+ *
+ * The user fields of \a stream must be filled in.
+ *
+ * \param stream    Stream to set up.
+ * \param int_level Interrupt priority level.
+ *
+ * \return PDCA_SUCCESS or PDCA_INVALID_ARGUMENT
+ */
+extern int32_t pdca_stream_init(pdca_stream_t *stream, uint32_t int_level);
+
+/** \brief Starts the stream on the first buffer of the ring.
+ */
+extern void pdca_stream_start(pdca_stream_t *stream);
+
+/** \brief Stops the stream, the current buffer is not delivered.
+ */
+extern void pdca_stream_stop(pdca_stream_t *stream);
+
+/** \brief Gives the oldest delivered buffer back to the ring.
+ *
+ * May be called from the callback itself or later from the main loop.
+ */
+extern void pdca_stream_release(pdca_stream_t *stream);
+
+/**
+ * \}
+ */
+
+#endif  // _PDCA_STREAM_H_
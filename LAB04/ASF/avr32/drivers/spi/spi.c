@@ -375,6 +375,163 @@ spi_status_t spi_read(volatile avr32_spi_t *spi, uint16_t *data)
 	return SPI_OK;
 }
 
+/** \brief Waits for a status flag, collecting the overrun flag on the way.
+ *
+ * Reading SR clears OVRES, so it is accumulated in \a ovres.
+ *
+ * \return The status read with a flag of \a mask set, 0 on timeout.
+ */
+static inline uint32_t spi_wait_status(volatile avr32_spi_t *spi,
+		uint32_t mask, uint32_t *ovres)
+{
+	uint32_t timeout = SPI_TIMEOUT;
+	uint32_t sr;
+
+	while (!((sr = spi->sr) & mask)) {
+		*ovres |= sr & AVR32_SPI_SR_OVRES_MASK;
+		if (!timeout--) {
+			return 0;
+		}
+	}
+	*ovres |= sr & AVR32_SPI_SR_OVRES_MASK;
+
+	return sr;
+}
+
+/** \brief Next frame to send, \a fill when \a tx is NULL. A 16-bit frame
+ *         takes two bytes, the first one in the MSB (shifted out first).
+ */
+static inline uint16_t spi_next_frame(const uint8_t **tx, uint16_t fill,
+		bool wide)
+{
+	const uint8_t *data = *tx;
+
+	if (!data) {
+		return fill;
+	}
+	*tx = data + (wide ? 2 : 1);
+
+	return wide ? (data[0] << 8) | data[1] : data[0];
+}
+
+/** \brief Full duplex transfer of \a len frames, \a fill is sent when
+ *         \a tx is NULL. With \a wide, each frame is 16 bits and moves two
+ *         bytes of the buffers.
+ */
+static spi_status_t spi_transfer_frames(volatile avr32_spi_t *spi,
+		const uint8_t *tx, uint16_t fill, uint8_t *rx, uint32_t len,
+		bool wide)
+{
+	uint32_t ovres = 0;
+	uint32_t queued;
+	uint32_t sr;
+	uint16_t frame;
+
+	if (!len) {
+		return SPI_OK;
+	}
+
+	/* Let previous frames finish so that RDR only receives ours. */
+	if (!spi_wait_status(spi, AVR32_SPI_SR_TXEMPTY_MASK, &ovres)) {
+		return SPI_ERROR_TIMEOUT;
+	}
+	(void)spi->rdr;
+	ovres = 0;
+
+	/* Prime the shifter, then keep the next frame waiting in TDR. */
+	spi->tdr = spi_next_frame(&tx, fill, wide) << AVR32_SPI_TDR_TD_OFFSET;
+	queued = len - 1;
+
+	while (len--) {
+		if (queued) {
+			if (!spi_wait_status(spi, AVR32_SPI_SR_TDRE_MASK, &ovres)) {
+				return SPI_ERROR_TIMEOUT;
+			}
+			spi->tdr = spi_next_frame(&tx, fill, wide) <<
+					AVR32_SPI_TDR_TD_OFFSET;
+			queued--;
+		}
+
+		sr = spi_wait_status(spi, AVR32_SPI_SR_RDRF_MASK |
+				AVR32_SPI_SR_TXEMPTY_MASK, &ovres);
+		if (!sr) {
+			return SPI_ERROR_TIMEOUT;
+		}
+
+		/* Idle with RDR empty: the frame was lost in an overrun. */
+		if (!(sr & AVR32_SPI_SR_RDRF_MASK)) {
+			return SPI_ERROR_OVERRUN;
+		}
+		frame = spi->rdr >> AVR32_SPI_RDR_RD_OFFSET;
+		if (wide) {
+			*rx++ = frame >> 8;
+		}
+		*rx++ = frame;
+	}
+
+	return ovres ? SPI_ERROR_OVERRUN : SPI_OK;
+}
+
+spi_status_t spi_write_buf(volatile avr32_spi_t *spi, const uint8_t *data,
+		uint32_t len)
+{
+	uint32_t timeout;
+
+	while (len--) {
+		timeout = SPI_TIMEOUT;
+		while (!(spi->sr & AVR32_SPI_SR_TDRE_MASK)) {
+			if (!timeout--) {
+				return SPI_ERROR_TIMEOUT;
+			}
+		}
+
+		spi->tdr = *data++ << AVR32_SPI_TDR_TD_OFFSET;
+	}
+
+	return SPI_OK;
+}
+
+spi_status_t spi_read_buf(volatile avr32_spi_t *spi, uint8_t *data,
+		uint32_t len, uint8_t dummy)
+{
+	return spi_transfer_frames(spi, NULL, dummy, data, len, false);
+}
+
+spi_status_t spi_transfer_buf(volatile avr32_spi_t *spi, const uint8_t *tx,
+		uint8_t *rx, uint32_t len)
+{
+	return spi_transfer_frames(spi, tx, 0, rx, len, false);
+}
+
+spi_status_t spi_write_packed16(volatile avr32_spi_t *spi,
+		const uint8_t *data, uint32_t len)
+{
+	spi_status_t status;
+
+	if (len & 1) {
+		return SPI_ERROR_ARGUMENT;
+	}
+
+	for (; len; len -= 2, data += 2) {
+		status = spi_write(spi, (data[0] << 8) | data[1]);
+		if (status != SPI_OK) {
+			return status;
+		}
+	}
+
+	return SPI_OK;
+}
+
+spi_status_t spi_read_packed16(volatile avr32_spi_t *spi,
+		uint8_t *data, uint32_t len, uint16_t dummy)
+{
+	if (len & 1) {
+		return SPI_ERROR_ARGUMENT;
+	}
+
+	return spi_transfer_frames(spi, NULL, dummy, data, len / 2, true);
+}
+
 uint8_t spi_getStatus(volatile avr32_spi_t *spi)
 {
 	spi_status_t ret = SPI_OK;
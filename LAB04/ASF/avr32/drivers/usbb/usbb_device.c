@@ -51,6 +51,7 @@
 #include "udd.h"
 #include "usbb_otg.h"
 #include "usbb_device.h"
+#include "cycle_counter.h"
 #include <string.h>
 
 // Fix the fact that, for some IAR header files, the AVR32_USBB_IRQ_GROUP define
@@ -111,7 +112,9 @@
  * Dynamic callbacks, called "endpoint job" , are registered
  * in udd_ep_job_t structure via the following functions:
  * - udd_ep_run()<br>
- *   To call it when a transfer is finish
+ *   To call it when a transfer is finish. While a transfer is on going,
+ *   up to UDD_EP_QUEUE_SIZE more are queued and started one after the
+ *   other from the DMA interrupt, without waiting for the callbacks.
  * - udd_ep_wait_stall_clear()<br>
  *   To call it when a endpoint halt is disabled
  *
@@ -392,6 +395,31 @@ static bool udd_ctrl_interrupt(void);
 //@{
 #if (0!=USB_DEVICE_MAX_EP)
 
+//! Number of transfers that can wait behind the one on going, per endpoint
+#ifndef UDD_EP_QUEUE_SIZE
+#  define UDD_EP_QUEUE_SIZE        2
+#endif
+
+//! A time without job longer than this is a pause of the class, not a gap
+#ifndef UDD_EP_STAT_PAUSE_US
+#  define UDD_EP_STAT_PAUSE_US     10000
+#endif
+
+//! Structure definition about a transfer waiting behind the job on going
+typedef struct {
+	//! Buffer located in internal RAM to send or fill
+	uint8_t *buf;
+
+	//! Size of buffer to send or fill
+	iram_size_t buf_size;
+
+	//! Callback to call at the end of transfer
+	udd_callback_trans_t call_trans;
+
+	//! A short packet is requested on endpoint IN
+	bool b_shortpacket;
+} udd_ep_queued_t;
+
 //! Structure definition about job registered on an endpoint
 typedef struct {
 	//! A job is registered on this endpoint
@@ -419,6 +447,27 @@ typedef struct {
 		//! Callback to call when the endpoint halt is cleared
 		udd_callback_halt_cleared_t call_nohalt;
 	};
+
+	//! Transfers registered while this job is on going, oldest first
+	udd_ep_queued_t queue[UDD_EP_QUEUE_SIZE];
+
+	//! Index of the oldest queued transfer
+	uint8_t queue_first;
+
+	//! Number of queued transfers
+	uint8_t queue_nb;
+
+	//! The endpoint ran out of jobs at \a idle_cycles
+	bool b_idle;
+
+	//! CPU cycle counter when the last job ended with no job queued
+	uint32_t idle_cycles;
+
+	//! Value of \a stat.nb_bytes one second ago
+	uint32_t last_nb_bytes;
+
+	//! Statistics of the endpoint
+	udd_ep_stat_t stat;
 } udd_ep_job_t;
 
 
@@ -446,6 +495,20 @@ static void udd_ep_abort_job(udd_ep_id_t ep);
  */
 static void udd_ep_finish_job(udd_ep_job_t * ptr_job, bool b_abort, uint8_t ep_num);
 
+/**
+ * \brief Start the job registered in \a ptr_job and account the time the
+ * endpoint spent without job.
+ *
+ * \param ptr_job  job to start, already marked busy
+ * \param ep       endpoint number without direction flag
+ */
+static void udd_ep_start_job(udd_ep_job_t * ptr_job, udd_ep_id_t ep);
+
+/**
+ * \brief Update the bytes per second statistics, called for each SOF
+ */
+static void udd_ep_stat_sof(void);
+
 /**
  * \brief Start the next transfer if necessary or complete the job associated.
  *
@@ -499,6 +562,9 @@ ISR(udd_interrupt, AVR32_USBB_IRQ_GROUP, UDD_USB_INT_LEVEL)
 		}
 #ifdef UDC_SOF_EVENT
 		UDC_SOF_EVENT();
+#endif
+#if (0 != USB_DEVICE_MAX_EP)
+		udd_ep_stat_sof();
 #endif
 		goto udd_interrupt_end;
 	}
@@ -1039,8 +1105,23 @@ bool udd_ep_run(udd_ep_id_t ep, bool b_shortpacket,
 
 	flags = cpu_irq_save();
 	if (ptr_job->busy == true) {
+		// Job already on going, queue this one behind it
+		udd_ep_queued_t *ptr_queued;
+
+		if (ptr_job->queue_nb >= UDD_EP_QUEUE_SIZE) {
+			cpu_irq_restore(flags);
+			return false; // Queue full
+		}
+		ptr_queued = &ptr_job->queue[(ptr_job->queue_first
+				+ ptr_job->queue_nb) % UDD_EP_QUEUE_SIZE];
+		ptr_queued->buf = buf;
+		ptr_queued->buf_size = buf_size;
+		ptr_queued->call_trans = callback;
+		ptr_queued->b_shortpacket = b_shortpacket;
+		ptr_job->queue_nb++;
+		ptr_job->stat.nb_queued++;
 		cpu_irq_restore(flags);
-		return false; // Job already on going
+		return true;
 	}
 	ptr_job->busy = true;
 	cpu_irq_restore(flags);
@@ -1049,13 +1130,11 @@ bool udd_ep_run(udd_ep_id_t ep, bool b_shortpacket,
 	//
 	ptr_job->buf = buf;
 	ptr_job->buf_size = buf_size;
-	ptr_job->nb_trans = 0;
 	ptr_job->call_trans = callback;
 	ptr_job->b_shortpacket = b_shortpacket;
 
-
 	// Request first transfer
-	udd_ep_trans_done(ep);
+	udd_ep_start_job(ptr_job, ep);
 	return true;
 }
 
@@ -1606,6 +1685,8 @@ static void udd_ep_job_table_reset(void)
 	for (i = 0; i < USB_DEVICE_MAX_EP; i++) {
 		udd_ep_job[i].busy = false;
 		udd_ep_job[i].stall_requested = false;
+		udd_ep_job[i].queue_nb = 0;
+		udd_ep_job[i].b_idle = false;
 	}
 }
 
@@ -1632,18 +1713,133 @@ static void udd_ep_abort_job(udd_ep_id_t ep)
 
 static void udd_ep_finish_job(udd_ep_job_t * ptr_job, bool b_abort, uint8_t ep_num)
 {
+	udd_callback_trans_t call_trans;
+	iram_size_t nb_trans;
+	udd_ep_queued_t aborted[UDD_EP_QUEUE_SIZE];
+	uint8_t nb_aborted = 0;
+	uint8_t ep_addr = ep_num;
+	uint8_t i;
+
 	if (ptr_job->busy == false) {
 		return; // No on-going job
 	}
 	ptr_job->busy = false;
-	if (NULL == ptr_job->call_trans) {
-		return; // No callback linked to job
-	}
+	call_trans = ptr_job->call_trans;
+	nb_trans = ptr_job->buf_size;
 	if (Is_udd_endpoint_in(ep_num)) {
-		ep_num |= USB_EP_DIR_IN;
+		ep_addr |= USB_EP_DIR_IN;
+	}
+
+	if (b_abort) {
+		// The queued transfers are aborted with the job on going
+		while (ptr_job->queue_nb) {
+			aborted[nb_aborted++] = ptr_job->queue[ptr_job->queue_first];
+			ptr_job->queue_first = (ptr_job->queue_first + 1)
+					% UDD_EP_QUEUE_SIZE;
+			ptr_job->queue_nb--;
+		}
+		ptr_job->b_idle = false;
+	} else {
+		ptr_job->stat.nb_jobs++;
+		ptr_job->stat.nb_bytes += nb_trans;
+		if (ptr_job->queue_nb) {
+			// Start the next transfer before calling back,
+			// so that the endpoint does not wait for the class
+			udd_ep_queued_t *ptr_queued =
+					&ptr_job->queue[ptr_job->queue_first];
+			ptr_job->queue_first = (ptr_job->queue_first + 1)
+					% UDD_EP_QUEUE_SIZE;
+			ptr_job->queue_nb--;
+			ptr_job->busy = true;
+			ptr_job->buf = ptr_queued->buf;
+			ptr_job->buf_size = ptr_queued->buf_size;
+			ptr_job->call_trans = ptr_queued->call_trans;
+			ptr_job->b_shortpacket = ptr_queued->b_shortpacket;
+			udd_ep_start_job(ptr_job, ep_num);
+		} else {
+			ptr_job->b_idle = true;
+			ptr_job->idle_cycles = Get_sys_count();
+		}
+	}
+
+	if (NULL != call_trans) {
+		call_trans((b_abort) ? UDD_EP_TRANSFER_ABORT :
+				UDD_EP_TRANSFER_OK, nb_trans, ep_addr);
+	}
+	for (i = 0; i < nb_aborted; i++) {
+		if (NULL != aborted[i].call_trans) {
+			aborted[i].call_trans(UDD_EP_TRANSFER_ABORT, 0, ep_addr);
+		}
+	}
+}
+
+
+static void udd_ep_start_job(udd_ep_job_t * ptr_job, udd_ep_id_t ep)
+{
+	if (ptr_job->b_idle) {
+		uint32_t gap_us = (Get_sys_count()
+				- ptr_job->idle_cycles) / (sysclk_get_cpu_hz() / 1000000);
+
+		ptr_job->b_idle = false;
+		if (gap_us > UDD_EP_STAT_PAUSE_US) {
+			ptr_job->stat.nb_pauses++;
+		} else {
+			ptr_job->stat.nb_gaps++;
+			ptr_job->stat.gap_us += gap_us;
+			if (gap_us > ptr_job->stat.max_gap_us) {
+				ptr_job->stat.max_gap_us = gap_us;
+			}
+		}
+	}
+	ptr_job->nb_trans = 0;
+	udd_ep_trans_done(ep);
+}
+
+
+static void udd_ep_stat_sof(void)
+{
+	static uint16_t nb_sof = 0;
+	uint8_t i;
+
+	if (++nb_sof < 1000) {
+		return;
+	}
+	nb_sof = 0;
+	for (i = 0; i < USB_DEVICE_MAX_EP; i++) {
+		udd_ep_job[i].stat.bytes_per_s = udd_ep_job[i].stat.nb_bytes
+				- udd_ep_job[i].last_nb_bytes;
+		udd_ep_job[i].last_nb_bytes = udd_ep_job[i].stat.nb_bytes;
 	}
-	ptr_job->call_trans((b_abort) ? UDD_EP_TRANSFER_ABORT :
-			UDD_EP_TRANSFER_OK, ptr_job->buf_size, ep_num);
+}
+
+
+bool udd_ep_get_stat(udd_ep_id_t ep, udd_ep_stat_t *stat)
+{
+	irqflags_t flags;
+
+	ep &= USB_EP_ADDR_MASK;
+	if ((0 == ep) || (USB_DEVICE_MAX_EP < ep)) {
+		return false;
+	}
+	flags = cpu_irq_save();
+	*stat = udd_ep_job[ep - 1].stat;
+	cpu_irq_restore(flags);
+	return true;
+}
+
+
+void udd_ep_clear_stat(udd_ep_id_t ep)
+{
+	irqflags_t flags;
+
+	ep &= USB_EP_ADDR_MASK;
+	if ((0 == ep) || (USB_DEVICE_MAX_EP < ep)) {
+		return;
+	}
+	flags = cpu_irq_save();
+	memset(&udd_ep_job[ep - 1].stat, 0, sizeof(udd_ep_stat_t));
+	udd_ep_job[ep - 1].last_nb_bytes = 0;
+	cpu_irq_restore(flags);
 }
 
 static void udd_ep_trans_done(udd_ep_id_t ep)
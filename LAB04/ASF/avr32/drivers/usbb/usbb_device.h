@@ -50,6 +50,7 @@
 #include "compiler.h"
 #include "preprocessor.h"
 #include "usbb_otg.h"
+#include "udd.h"
 
 
 //! \ingroup udd_group
@@ -606,6 +607,38 @@ typedef struct {
 //! @}
 //! @}
 
+//! @name USBB Device endpoint job statistics
+//! udd_ep_run() queues up to UDD_EP_QUEUE_SIZE transfers behind the job on
+//! going, the next one is started from the DMA interrupt of the previous one.
+//! These counters tell whether the class layer keeps the endpoint busy.
+//! @{
+
+//! Statistics of a bulk/interrupt/isochronous endpoint
+typedef struct {
+	uint32_t nb_jobs;       //!< Transfers completed
+	uint32_t nb_bytes;      //!< Bytes moved by the completed transfers
+	uint32_t nb_queued;     //!< Transfers queued behind another one
+	uint32_t nb_gaps;       //!< Transfers started after the endpoint ran out of jobs
+	uint32_t gap_us;        //!< Total time without job before these transfers
+	uint32_t max_gap_us;    //!< Longest time without job before these transfers
+	uint32_t nb_pauses;     //!< Times without job longer than UDD_EP_STAT_PAUSE_US, not counted as gaps
+	uint32_t bytes_per_s;   //!< Bytes moved during the last second
+} udd_ep_stat_t;
+
+//! @brief Gets the statistics of an endpoint
+//!
+//! @param ep    Endpoint address, the direction bit is ignored
+//! @param stat  Location of the copy
+//!
+//! @return \c false if the endpoint does not exist
+extern bool udd_ep_get_stat(udd_ep_id_t ep, udd_ep_stat_t *stat);
+
+//! @brief Clears the statistics of an endpoint
+//!
+//! @param ep    Endpoint address, the direction bit is ignored
+extern void udd_ep_clear_stat(udd_ep_id_t ep);
+//! @}
+
 //! @}
 
 #endif // _USBB_DEVICE_H_
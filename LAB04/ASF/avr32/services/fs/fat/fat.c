@@ -77,6 +77,29 @@ _MEM_TYPE_SLOW_     Fs_clusterlist_cache fs_g_cache_clusterlist[FS_NB_CACHE_CLUS
 _MEM_TYPE_SLOW_     uint8_t  fs_g_u8_current_cache;
 //! @}
 
+#if (FS_NB_EXTENT_MAP != 0)
+//! \name Variables to manage file extent maps
+//! @{
+_MEM_TYPE_SLOW_     Fs_extent_map fs_g_extent_map[FS_NB_EXTENT_MAP];
+//! @}
+
+//! \name Status of the fat_extent_map_read() function
+//! @{
+#define  FS_EXTENT_FOUND            0        // Segment found in the map
+#define  FS_EXTENT_NOT_FOUND        1        // Position after the extents stored, the FAT must be read
+#define  FS_EXTENT_OUT_LIST         2        // Position outside the cluster list
+#define  FS_EXTENT_ERROR            3        // Error during the FAT reading
+//! @}
+#endif
+
+//! \name Variables to manage the sector cache
+//! @{
+COMPILER_WORD_ALIGNED
+_MEM_TYPE_SLOW_     uint8_t  fs_g_sector_buf[FS_NB_CACHE_SECTOR][FS_CACHE_SIZE];
+_MEM_TYPE_SLOW_     Fs_sector_cache fs_g_sectorcache[FS_NB_CACHE_SECTOR];
+_MEM_TYPE_SLOW_     Fs_sector_cache *fs_g_sectorcache_sel;   //!< Cache of fs_g_sector
+//! @}
+
 //_____ D E C L A R A T I O N S ____________________________________________
 
 
@@ -84,6 +107,14 @@ void  fat_cache_clusterlist_update_start  ( bool b_for_file );
 void  fat_cache_clusterlist_update_finish ( void );
 bool  fat_cache_clusterlist_update_read   ( bool b_for_file );
 void  fat_cache_clusterlist_update_select ( void );
+bool  fat_cache_select_clusterlist        ( uint32_t u32_start , uint32_t u32_pos );
+#if (FS_NB_EXTENT_MAP != 0)
+Fs_extent_map *fat_extent_map_select      ( void );
+bool  fat_extent_map_extend               ( Fs_extent_map *map , uint32_t u32_cluster_pos );
+uint8_t  fat_extent_map_read              ( uint8_t opt_action );
+#endif
+void  fat_cache_select                    ( uint8_t u8_i );
+bool  fat_cache_writeback                 ( Fs_sector_cache *cache );
 
 
 
@@ -136,10 +167,7 @@ bool  fat_check_device( void )
       }
 #endif
       // If the internal cache corresponding at device then clean it
-      if( fs_g_nav.u8_lun == fs_g_sectorcache.u8_lun )
-      {
-         fat_cache_reset();
-      }
+      fat_cache_reset_lun( fs_g_nav.u8_lun );
       fat_cache_clusterlist_reset();
 
       fs_g_status = FS_ERR_HW;                     // By default HW error
@@ -422,14 +450,24 @@ bool  fat_cluster_list( uint8_t opt_action, bool b_for_file )
    // Management of cluster list caches
    if( FS_CLUST_ACT_CLR != opt_action )
    {
+#if (FS_NB_EXTENT_MAP != 0)
+      if( b_for_file && (0 != fs_g_seg.u32_addr) )
+      {
+         // Search the segment in the extent map of the file
+         u8_cluster_status = fat_extent_map_read( opt_action );
+         if( FS_EXTENT_FOUND == u8_cluster_status )
+            return true;
+         if( FS_EXTENT_NOT_FOUND != u8_cluster_status )
+            return false;        // Error or position outside the cluster list
+         // The map is full, then read the FAT after the cluster list cache
+      }
+#endif
       if( fat_cache_clusterlist_update_read( b_for_file ) )
          return true;            // Segment found in cache
       // Segment not found & cache ready to update
    }else{
       fat_cache_clusterlist_reset();   // It is a clear action then clear cluster list caches
-#if (FS_LEVEL_FEATURES > FSFEATURE_READ)
-      fat_clear_info_fat_mod();        // Init cache on fat modification range
-#endif  // FS_LEVEL_FEATURES
+      // The FAT modification range isn't cleared, it may contain modifications not yet copied in FAT2
    }
 
    // Init loop with a start segment no found
@@ -650,22 +688,12 @@ bool  fat_cluster_val( bool b_mode )
    if (b_mode)
    {
       // Update information about FAT modification
-      if( fs_g_u32_first_mod_fat > u32_offset_fat )
-      {
-         fs_g_u32_first_mod_fat = u32_offset_fat;
-      }
-      if( fs_g_u32_last_mod_fat < u32_offset_fat )
-      {
-         fs_g_u32_last_mod_fat = u32_offset_fat;
-      }
+      fat_set_info_fat_mod( u32_offset_fat );
       if ( Is_fat12 )
       {  // A cluster may be stored on two sectors
          if( fs_g_u16_pos_fat == (FS_CACHE_SIZE-1) )
          {  // Count the next FAT sector
-            if( fs_g_u32_last_mod_fat < (u32_offset_fat+1) )
-            {
-               fs_g_u32_last_mod_fat = (u32_offset_fat+1);
-            }
+            fat_set_info_fat_mod( u32_offset_fat+1 );
          }
       }
    }
@@ -727,6 +755,25 @@ bool  fat_cluster_val( bool b_mode )
       }
    } else {
 #if (FS_LEVEL_FEATURES > FSFEATURE_READ)
+      bool b_was_free;
+
+      //**** Save the free state of the old value, used to update the free cluster count
+      if ( Is_fat32 )
+      {
+         b_was_free = (0 == (u8_data1 | u8_data2 | u8_data3 | (u8_data4 & 0x0F)));
+      }
+      else if ( Is_fat16 )
+      {
+         b_was_free = (0 == (u8_data1 | u8_data2));
+      }
+      else if ( 0x01 & LSB0(fs_g_cluster.u32_pos) )
+      {  // FAT 12, cluster ODD
+         b_was_free = (0 == ((u8_data1 & 0xF0) | u8_data2));
+      } else {
+         // FAT 12, cluster EVEN
+         b_was_free = (0 == (u8_data1 | (u8_data2 & 0x0F)));
+      }
+
       //**** Write the cluster value
       if ( Is_fat12 )
       {
@@ -753,6 +800,7 @@ bool  fat_cluster_val( bool b_mode )
             // Modify the previous sector
             fs_g_sector[ FS_CACHE_SIZE-1 ] = u8_data1;
             fat_cache_mark_sector_as_dirty();
+            fat_freemap_update( b_was_free );
             return true;
          }
       }
@@ -771,6 +819,8 @@ bool  fat_cluster_val( bool b_mode )
       u8_ptr_cluster[0] = u8_data1;
       u8_ptr_cluster[1] = u8_data2;
       fat_cache_mark_sector_as_dirty();
+      // Update the free cluster count and bitmap
+      fat_freemap_update( b_was_free );
 #else
       fs_g_status = FS_ERR_COMMAND;
       return false;
@@ -894,6 +944,18 @@ void  fat_cache_clusterlist_reset( void )
       fs_g_cache_clusterlist[u8_i].u8_lun = 0xFF;
       fs_g_cache_clusterlist[u8_i].u8_level_use = 0xFF;
    }
+#if (FS_NB_EXTENT_MAP != 0)
+   for( u8_i=0; u8_i<FS_NB_EXTENT_MAP; u8_i++ )
+   {
+      fs_g_extent_map[u8_i].u8_lun = 0xFF;
+      fs_g_extent_map[u8_i].u8_level_use = 0xFF;
+   }
+#endif
+   // The positions in cluster list of the sectors cached may be wrong too
+   for( u8_i=0; u8_i<FS_NB_CACHE_SECTOR; u8_i++ )
+   {
+      fs_g_sectorcache[u8_i].u32_clusterlist_start = 0xFFFFFFFF;
+   }
 }
 
 
@@ -1019,6 +1081,227 @@ bool  fat_cache_clusterlist_update_read( bool b_for_file )
 //! @}
 
 
+//! \name Internal functions to manage file extent maps
+//! @{
+
+#if (FS_NB_EXTENT_MAP != 0)
+//! This function selects the extent map of a cluster list, a new map is initialized if it isn't found
+//!
+//! @return    the extent map
+//!
+//! @verbatim
+//! Global variable used
+//! IN :
+//!   fs_g_cluster.u32_pos    first cluster of cluster list
+//! @endverbatim
+//!
+Fs_extent_map *fat_extent_map_select( void )
+{
+   Fs_extent_map *map;
+   uint8_t u8_i;
+   uint8_t u8_level_to_update;
+
+   // Search the map of cluster list, else get the OLD map (=max level used)
+   map = &fs_g_extent_map[0];
+   for( u8_i=0; u8_i<FS_NB_EXTENT_MAP; u8_i++ )
+   {
+      if( (fs_g_extent_map[u8_i].u8_lun      == fs_g_nav.u8_lun )
+      &&  (fs_g_extent_map[u8_i].u32_cluster == fs_g_cluster.u32_pos ) )
+      {
+         map = &fs_g_extent_map[u8_i];
+         break;
+      }
+      if( map->u8_level_use < fs_g_extent_map[u8_i].u8_level_use )
+         map = &fs_g_extent_map[u8_i];
+   }
+   if( FS_NB_EXTENT_MAP == u8_i )
+   {
+      // Map no found, then the map starts with the first cluster only
+      map->u8_lun                = fs_g_nav.u8_lun;
+      map->u32_cluster           = fs_g_cluster.u32_pos;
+      map->u8_nb_extent          = 1;
+      map->b_complete            = false;
+      map->u32_nb_cluster        = 1;
+      map->extent[0].u32_start   = 0;
+      map->extent[0].u32_cluster = fs_g_cluster.u32_pos;
+   }
+
+   // Update the "level used" of maps
+   u8_level_to_update = map->u8_level_use;
+   for( u8_i=0; u8_i<FS_NB_EXTENT_MAP; u8_i++ )
+   {
+      if( u8_level_to_update > fs_g_extent_map[u8_i].u8_level_use )
+         fs_g_extent_map[u8_i].u8_level_use++;
+   }
+   map->u8_level_use = 0;
+   return map;
+}
+
+
+//! This function reads the cluster list in FAT after the last cluster stored in an extent map
+//!
+//! @param     map               extent map to extend
+//! @param     u32_cluster_pos   position in cluster list to reach (unit cluster)
+//!
+//! @return    false in case of error, see global value "fs_g_status" for more detail
+//! @return    true otherwise (the position may stay outside the map, if the map is full or complete)
+//!
+bool  fat_extent_map_extend( Fs_extent_map *map , uint32_t u32_cluster_pos )
+{
+   Fs_extent *extent;
+
+   while( (u32_cluster_pos >= map->u32_nb_cluster) && !map->b_complete )
+   {
+      // Read the value of the last cluster stored
+      extent = &map->extent[ map->u8_nb_extent-1 ];
+      fs_g_cluster.u32_pos = extent->u32_cluster + (map->u32_nb_cluster - 1 - extent->u32_start);
+      if( !fat_cluster_val( FS_CLUST_VAL_READ ))
+         return false;
+
+      switch( fat_checkcluster() )
+      {
+         case FS_CLUS_BAD:
+         return false;
+
+         case FS_CLUS_END:
+         map->b_complete = true;
+         continue;
+      }
+
+      if( (fs_g_cluster.u32_pos+1) != fs_g_cluster.u32_val )
+      {
+         // The cluster list jumps, then start a new extent
+         if( FS_NB_EXTENT == map->u8_nb_extent )
+            break;               // The map is full
+         extent++;
+         extent->u32_start   = map->u32_nb_cluster;
+         extent->u32_cluster = fs_g_cluster.u32_val;
+         map->u8_nb_extent++;
+      }
+      map->u32_nb_cluster++;
+   }
+   return true;
+}
+
+
+//! This function gets the segment at a position in a file cluster list from the extent map of file
+//!
+//! @param     opt_action        FS_CLUST_ACT_SEG or FS_CLUST_ACT_ONE, see fat_cluster_list()
+//!
+//! @return    FS_EXTENT_FOUND      segment found, global variable fs_g_seg updated
+//! @return    FS_EXTENT_NOT_FOUND  position after the last extent of a full map, fs_g_cluster and fs_g_seg unchanged
+//! @return    FS_EXTENT_OUT_LIST   position outside the cluster list, same outputs as fat_cluster_list()
+//! @return    FS_EXTENT_ERROR      error, see global value "fs_g_status" for more detail
+//!
+//! @verbatim
+//! The map is read by dichotomy, the FAT is read only on the part of cluster list not yet stored.
+//! Global variable used
+//! IN :
+//!   fs_g_cluster.u32_pos       first cluster of cluster list
+//!   fs_g_seg.u32_size_or_pos   position in cluster list (unit 512B)
+//! OUT:
+//!   fs_g_seg                   segment corresponding at the position
+//! @endverbatim
+//!
+uint8_t  fat_extent_map_read( uint8_t opt_action )
+{
+   Fs_extent_map *map;
+   Fs_extent *extent;
+   uint32_t u32_cluster_pos, u32_end, u32_tmp;
+   uint8_t u8_sector_offset;
+   uint8_t u8_min, u8_max, u8_mid;
+
+   map = fat_extent_map_select();
+   u32_cluster_pos  = fs_g_seg.u32_size_or_pos / fs_g_nav.u8_BPB_SecPerClus;
+   u8_sector_offset = fs_g_seg.u32_size_or_pos % fs_g_nav.u8_BPB_SecPerClus;
+
+   if( !fat_extent_map_extend( map , u32_cluster_pos ))
+      return FS_EXTENT_ERROR;
+
+   if( u32_cluster_pos >= map->u32_nb_cluster )
+   {
+      if( !map->b_complete )
+      {
+         // The map is full, then restore the cluster list start
+         fs_g_cluster.u32_pos = map->u32_cluster;
+         return FS_EXTENT_NOT_FOUND;
+      }
+
+      // The position is outside the cluster list
+      extent = &map->extent[ map->u8_nb_extent-1 ];
+      u32_tmp = fs_g_seg.u32_size_or_pos - ((map->u32_nb_cluster-1) * fs_g_nav.u8_BPB_SecPerClus); // Number of sector remaining from the last cluster
+      // Store the last cluster in cluster list cache, like fat_cluster_list(), to take time during the allocation
+      fs_g_cluster.u32_pos = map->u32_cluster;
+      fat_cache_clusterlist_update_start( true );
+      fs_g_cache_clusterlist[fs_g_u8_current_cache].u32_start -= u32_tmp;
+      fs_g_cluster.u32_pos = extent->u32_cluster + (map->u32_nb_cluster - 1 - extent->u32_start);
+      fs_g_seg.u32_addr = ((fs_g_cluster.u32_pos - 2) * fs_g_nav.u8_BPB_SecPerClus)
+                        + fs_g_nav.u32_ptr_fat + fs_g_nav.u32_offset_data;
+      fs_g_seg.u32_size_or_pos = fs_g_nav.u8_BPB_SecPerClus;
+      fat_cache_clusterlist_update_finish();
+
+      fs_g_seg.u32_addr = fs_g_cluster.u32_pos;    // Send the last cluster value
+      fs_g_seg.u32_size_or_pos = u32_tmp;          // Send number of sector remaining
+      fs_g_status = FS_ERR_OUT_LIST;
+      return FS_EXTENT_OUT_LIST;
+   }
+
+   // Search the last extent which starts before the position
+   u8_min = 0;
+   u8_max = map->u8_nb_extent-1;
+   while( u8_min < u8_max )
+   {
+      u8_mid = (u8_min + u8_max + 1) / 2;
+      if( map->extent[u8_mid].u32_start <= u32_cluster_pos )
+         u8_min = u8_mid;
+      else
+         u8_max = u8_mid-1;
+   }
+   extent = &map->extent[u8_min];
+   u32_end = ((u8_min+1) < map->u8_nb_extent) ? extent[1].u32_start : map->u32_nb_cluster;
+
+   // Compute the segment
+   fs_g_seg.u32_addr = ((extent->u32_cluster + (u32_cluster_pos - extent->u32_start) - 2) * fs_g_nav.u8_BPB_SecPerClus)
+                     + fs_g_nav.u32_ptr_fat + fs_g_nav.u32_offset_data + u8_sector_offset;
+   if( FS_CLUST_ACT_ONE == opt_action )
+   {
+      fs_g_seg.u32_size_or_pos = 1;
+   }else{
+      fs_g_seg.u32_size_or_pos = ((u32_end - u32_cluster_pos) * fs_g_nav.u8_BPB_SecPerClus) - u8_sector_offset;
+   }
+   return FS_EXTENT_FOUND;
+}
+#endif  // FS_NB_EXTENT_MAP
+
+
+//! This function signals that clusters are linked at the end of the cluster list of the selected file
+//!
+//! The extent map of file isn't complete anymore, the new clusters are read by the next access.
+//!
+//! @verbatim
+//! Global variable used
+//! IN :
+//!   fs_g_nav_entry.u32_cluster    First cluster of the selected file
+//! @endverbatim
+//!
+void  fat_extent_map_append( void )
+{
+#if (FS_NB_EXTENT_MAP != 0)
+   uint8_t u8_i;
+   for( u8_i=0; u8_i<FS_NB_EXTENT_MAP; u8_i++ )
+   {
+      if( (fs_g_extent_map[u8_i].u8_lun      == fs_g_nav.u8_lun )
+      &&  (fs_g_extent_map[u8_i].u32_cluster == fs_g_nav_entry.u32_cluster ) )
+      {
+         fs_g_extent_map[u8_i].b_complete = false;
+      }
+   }
+#endif
+}
+
+//! @}
+
+
 //! This function gets or clears a cluster list at the current position in the selected file
 //!
 //! @param     mode              Choose action <br>
@@ -1045,9 +1328,7 @@ bool  fat_read_file( uint8_t mode )
 
    if(FS_CLUST_ACT_ONE  == mode)
    {
-      if( (fs_g_sectorcache.u8_lun                 == fs_g_nav.u8_lun )
-      &&  (fs_g_sectorcache.u32_clusterlist_start  == fs_g_nav_entry.u32_cluster )
-      &&  (fs_g_sectorcache.u32_clusterlist_pos    == u32_sector_pos ) )
+      if( fat_cache_select_clusterlist( fs_g_nav_entry.u32_cluster , u32_sector_pos ) )
       {
          return true;      // The internal cache contains the sector requested
       }
@@ -1084,8 +1365,8 @@ bool  fat_read_file( uint8_t mode )
          fs_gu32_addrsector = fs_g_seg.u32_addr ;
          if( fat_cache_read_sector( true ) )
          {
-            fs_g_sectorcache.u32_clusterlist_start  = fs_g_nav_entry.u32_cluster;
-            fs_g_sectorcache.u32_clusterlist_pos    = u32_sector_pos;
+            fs_g_sectorcache_sel->u32_clusterlist_start  = fs_g_nav_entry.u32_cluster;
+            fs_g_sectorcache_sel->u32_clusterlist_pos    = u32_sector_pos;
             return true;
          }
       }
@@ -1154,6 +1435,9 @@ bool  fat_write_file( uint8_t mode , uint32_t u32_nb_sector_write )
       fs_g_seg.u32_size_or_pos = 1;                                                          // only one sector
    }
 
+   // The extent map of file continues on the new clusters (even if the allocation fails after a first link)
+   fat_extent_map_append();
+
    //note: fs_g_seg.u32_addr is already initialized with the last cluster value (see fat_cluster_list())
    if( !fat_allocfreespace())
       return false;
@@ -1203,9 +1487,7 @@ bool  fat_read_dir( void )
    // Compute the cluster list position corresponding of the current entry
    u32_cluster_pos = fs_g_nav_fast.u16_entry_pos_sel_file >> (FS_512B_SHIFT_BIT - FS_SHIFT_B_TO_FILE_ENTRY);
 
-   if( (fs_g_sectorcache.u8_lun                 == fs_g_nav.u8_lun )
-   &&  (fs_g_sectorcache.u32_clusterlist_start  == fs_g_nav.u32_cluster_sel_dir )
-   &&  (fs_g_sectorcache.u32_clusterlist_pos    == u32_cluster_pos ) )
+   if( fat_cache_select_clusterlist( fs_g_nav.u32_cluster_sel_dir , u32_cluster_pos ) )
    {
          return true;      // The internal cache contains the sector asked
    }
@@ -1220,8 +1502,8 @@ bool  fat_read_dir( void )
       if( fat_cache_read_sector( true ) )
       {
          // Update information about internal sector cache
-         fs_g_sectorcache.u32_clusterlist_start  = fs_g_nav.u32_cluster_sel_dir;
-         fs_g_sectorcache.u32_clusterlist_pos    = u32_cluster_pos;
+         fs_g_sectorcache_sel->u32_clusterlist_start  = fs_g_nav.u32_cluster_sel_dir;
+         fs_g_sectorcache_sel->u32_clusterlist_pos    = u32_cluster_pos;
          return true;
       }
    }
@@ -1782,6 +2064,9 @@ PTR_CACHE fat_get_ptr_entry( void )
 
 //! This function loads a memory sector in internal cache sector
 //!
+//! The cache stores FS_NB_CACHE_SECTOR sectors. When the sector is not in cache,
+//! the sector used the least recently is replaced (and written if it is modified).
+//!
 //! @param     b_load   true,  load the cache with the memory sector corresponding <br>
 //!                     false, Don't change the sector cache but change the memory address of cache <br>
 //!
@@ -1793,48 +2078,156 @@ PTR_CACHE fat_get_ptr_entry( void )
 //! IN :
 //!   fs_g_nav.u8_lun      drive number to read
 //!   fs_gu32_addrsector   address to read (unit sector)
+//! OUT:
+//!   fs_g_sector          sector cache corresponding
 //! @endverbatim
 //!
 bool  fat_cache_read_sector( bool b_load )
 {
-   // Check if the sector asked is the same in cache
-   if( (fs_g_sectorcache.u8_lun     == fs_g_nav.u8_lun )
-   &&  (fs_g_sectorcache.u32_addr   == fs_gu32_addrsector ) )
+   uint8_t u8_i;
+   uint8_t u8_old = 0;
+   Fs_sector_cache *cache;
+
+   // Check if the sector asked is in cache
+   for( u8_i=0; u8_i<FS_NB_CACHE_SECTOR; u8_i++ )
    {
-      return true;
+      cache = &fs_g_sectorcache[u8_i];
+      if( (cache->u8_lun     == fs_g_nav.u8_lun )
+      &&  (cache->u32_addr   == fs_gu32_addrsector ) )
+      {
+         fs_g_sectorcache_stat.u32_hit++;
+         if( !b_load && (cache != fs_g_sectorcache_sel) )
+         {
+            // The content of the current cache becomes the content of this sector
+            memcpy_ram2ram( fs_g_sector_buf[u8_i] , fs_g_sector , FS_CACHE_SIZE );
+            cache->u32_clusterlist_start = 0xFFFFFFFF;
+         }
+         fat_cache_select( u8_i );
+         return true;
+      }
+      // Search a free cache or the oldest cache
+      if( (FS_BUF_SECTOR_EMPTY != fs_g_sectorcache[u8_old].u8_lun)
+      &&  ( (FS_BUF_SECTOR_EMPTY == cache->u8_lun)
+         || (cache->u8_level_use > fs_g_sectorcache[u8_old].u8_level_use) ) )
+      {
+         u8_old = u8_i;
+      }
    }
+   fs_g_sectorcache_stat.u32_miss++;
 
-   // Write previous cache before fill cache with a new sector
-   if( !fat_cache_flush())
+   // Write the old sector before fill cache with a new sector
+   cache = &fs_g_sectorcache[u8_old];
+   if( FS_BUF_SECTOR_EMPTY != cache->u8_lun )
+      fs_g_sectorcache_stat.u32_eviction++;
+   if( !fat_cache_writeback( cache ))
       return false;
 
-   // Delete informations about the caches
-   fat_cache_reset();
-
    // Init sector cache
-   fs_g_sectorcache.u32_addr = fs_gu32_addrsector;
+   cache->u8_lun = FS_BUF_SECTOR_EMPTY;
+   cache->u32_clusterlist_start = 0xFFFFFFFF;
+   cache->u32_addr = fs_gu32_addrsector;
    if( b_load )
    {
       // Load the sector from memory
-      if( CTRL_GOOD != memory_2_ram( fs_g_nav.u8_lun  , fs_g_sectorcache.u32_addr, fs_g_sector))
+      if( CTRL_GOOD != memory_2_ram( fs_g_nav.u8_lun  , cache->u32_addr, fs_g_sector_buf[u8_old]))
       {
          fs_g_status = FS_ERR_HW;
          return false;
       }
    }
+   else if( cache != fs_g_sectorcache_sel )
+   {
+      // Keep the content of the current cache
+      memcpy_ram2ram( fs_g_sector_buf[u8_old] , fs_g_sector , FS_CACHE_SIZE );
+   }
    // Valid sector cache
-   fs_g_sectorcache.u8_lun = fs_g_nav.u8_lun;
+   cache->u8_lun = fs_g_nav.u8_lun;
+   fat_cache_select( u8_old );
    return true;
 }
 
 
+//! This function selects a sector cache as fs_g_sector and updates the use levels
+//!
+//! @param     u8_i     cache number
+//!
+void  fat_cache_select( uint8_t u8_i )
+{
+   uint8_t u8_j;
+
+   for( u8_j=0; u8_j<FS_NB_CACHE_SECTOR; u8_j++ )
+   {
+      if( fs_g_sectorcache[u8_j].u8_level_use < fs_g_sectorcache[u8_i].u8_level_use )
+         fs_g_sectorcache[u8_j].u8_level_use++;
+   }
+   fs_g_sectorcache[u8_i].u8_level_use = 0;
+   fs_g_sectorcache_sel = &fs_g_sectorcache[u8_i];
+   fs_g_sector = fs_g_sector_buf[u8_i];
+}
+
+
+//! This function selects the sector cache corresponding at a position in a cluster list
+//!
+//! @param     u32_start   first cluster of cluster list
+//! @param     u32_pos     position in cluster list (unit 512B)
+//!
+//! @return    true, the sector is in cache and selected
+//! @return    false, otherwise
+//!
+bool  fat_cache_select_clusterlist( uint32_t u32_start , uint32_t u32_pos )
+{
+   uint8_t u8_i;
+
+   for( u8_i=0; u8_i<FS_NB_CACHE_SECTOR; u8_i++ )
+   {
+      if( (fs_g_sectorcache[u8_i].u8_lun                 == fs_g_nav.u8_lun )
+      &&  (fs_g_sectorcache[u8_i].u32_clusterlist_start  == u32_start )
+      &&  (fs_g_sectorcache[u8_i].u32_clusterlist_pos    == u32_pos ) )
+      {
+         fs_g_sectorcache_stat.u32_hit++;
+         fat_cache_select( u8_i );
+         return true;
+      }
+   }
+   return false;
+}
+
+
 //! This function resets the sector cache
 //!
 void  fat_cache_reset( void )
 {
-   fs_g_sectorcache.u8_lun                = FS_BUF_SECTOR_EMPTY;
-   fs_g_sectorcache.u8_dirty              = false;
-   fs_g_sectorcache.u32_clusterlist_start = 0xFFFFFFFF;
+   uint8_t u8_i;
+
+   for( u8_i=0; u8_i<FS_NB_CACHE_SECTOR; u8_i++ )
+   {
+      fs_g_sectorcache[u8_i].u8_lun                = FS_BUF_SECTOR_EMPTY;
+      fs_g_sectorcache[u8_i].u8_dirty              = false;
+      fs_g_sectorcache[u8_i].u32_clusterlist_start = 0xFFFFFFFF;
+      fs_g_sectorcache[u8_i].u8_level_use          = u8_i;
+   }
+   fs_g_sectorcache_sel = &fs_g_sectorcache[0];
+   fs_g_sector = fs_g_sector_buf[0];
+}
+
+
+//! This function resets the sectors of a device in sector cache
+//!
+//! @param     u8_lun   device number
+//!
+void  fat_cache_reset_lun( uint8_t u8_lun )
+{
+   uint8_t u8_i;
+
+   for( u8_i=0; u8_i<FS_NB_CACHE_SECTOR; u8_i++ )
+   {
+      if( u8_lun == fs_g_sectorcache[u8_i].u8_lun )
+      {
+         fs_g_sectorcache[u8_i].u8_lun                = FS_BUF_SECTOR_EMPTY;
+         fs_g_sectorcache[u8_i].u8_dirty              = false;
+         fs_g_sectorcache[u8_i].u32_clusterlist_start = 0xFFFFFFFF;
+      }
+   }
 }
 
 
@@ -1851,28 +2244,41 @@ void  fat_cache_clear( void )
 //!
 void  fat_cache_mark_sector_as_dirty( void )
 {
-   fs_g_sectorcache.u8_dirty = true;
+   fs_g_sectorcache_sel->u8_dirty = true;
+}
+
+
+//! This function writes the current sector cache on the memory now if it is modified
+//!
+//! @return    false in case of error, see global value "fs_g_status" for more detail
+//! @return    true otherwise
+//!
+bool  fat_cache_write_sector( void )
+{
+   return fat_cache_writeback( fs_g_sectorcache_sel );
 }
 #endif  // FS_LEVEL_FEATURES
 
 
-//! This function flushes the sector cache on the memory if necessary
+//! This function writes a sector cache on the memory if it is modified
+//!
+//! @param     cache    sector cache to write
 //!
 //! @return    false in case of error, see global value "fs_g_status" for more detail
 //! @return    true otherwise
 //!
-bool  fat_cache_flush( void )
+bool  fat_cache_writeback( Fs_sector_cache *cache )
 {
-   // If the cache is modified, then write the sector cache on the device
-   if ( true == fs_g_sectorcache.u8_dirty )
+   if ( true == cache->u8_dirty )
    {
-      fs_g_sectorcache.u8_dirty = false; // Always clear, although an error occur
-      if( mem_wr_protect( fs_g_sectorcache.u8_lun  ))
+      cache->u8_dirty = false; // Always clear, although an error occur
+      fs_g_sectorcache_stat.u32_writeback++;
+      if( mem_wr_protect( cache->u8_lun  ))
       {
          fs_g_status = FS_LUN_WP;
          return false;
       }
-      if (CTRL_GOOD != ram_2_memory( fs_g_sectorcache.u8_lun , fs_g_sectorcache.u32_addr , fs_g_sector ))
+      if (CTRL_GOOD != ram_2_memory( cache->u8_lun , cache->u32_addr , fs_g_sector_buf[cache - fs_g_sectorcache] ))
       {
          fs_g_status = FS_ERR_HW;
          return false;
@@ -1882,6 +2288,74 @@ bool  fat_cache_flush( void )
 }
 
 
+//! This function flushes the sector cache on the memory if necessary
+//!
+//! @return    false in case of error, see global value "fs_g_status" for more detail
+//! @return    true otherwise
+//!
+bool  fat_cache_flush( void )
+{
+   uint8_t u8_i;
+   bool b_ok = true;
+
+#if (FS_LEVEL_FEATURES > FSFEATURE_READ)
+   // Copy the FAT modifications in FAT2 before writing
+   if( !fat_update_fat2_now())
+      b_ok = false;
+#endif  // FS_LEVEL_FEATURES
+
+   // Write all modified sectors, continue after an error to lose the least data
+   for( u8_i=0; u8_i<FS_NB_CACHE_SECTOR; u8_i++ )
+   {
+      if( !fat_cache_writeback( &fs_g_sectorcache[u8_i] ))
+         b_ok = false;
+   }
+   return b_ok;
+}
+
+
+//! This function synchronizes the sector cache with a segment transferred without cache
+//!
+//! @param     b_discard   true,  the segment will be written, the sectors cached are removed <br>
+//!                        false, the segment will be read, the sectors cached modified are written <br>
+//!
+//! @return    false in case of error, see global value "fs_g_status" for more detail
+//! @return    true otherwise
+//!
+//! @verbatim
+//! Global variable used
+//! IN :
+//!   fs_g_nav.u8_lun            drive number
+//!   fs_g_seg.u32_addr          first sector of segment
+//!   fs_g_seg.u32_size_or_pos   number of sectors of segment
+//! @endverbatim
+//!
+bool  fat_cache_flush_segment( bool b_discard )
+{
+   uint8_t u8_i;
+   Fs_sector_cache *cache;
+
+   for( u8_i=0; u8_i<FS_NB_CACHE_SECTOR; u8_i++ )
+   {
+      cache = &fs_g_sectorcache[u8_i];
+      if( (cache->u8_lun   == fs_g_nav.u8_lun )
+      &&  (cache->u32_addr >= fs_g_seg.u32_addr )
+      &&  (cache->u32_addr <  (fs_g_seg.u32_addr + fs_g_seg.u32_size_or_pos)) )
+      {
+         if( b_discard )
+         {
+            cache->u8_lun   = FS_BUF_SECTOR_EMPTY;
+            cache->u8_dirty = false;
+         }
+         else if( !fat_cache_writeback( cache ))
+         {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
 
 #if (FS_NB_NAVIGATOR > 1)
 //! This function checks write access
@@ -236,6 +236,41 @@
 #define  FS_CACHE_SIZE              512      // Cache size used by module (unit 512B)
 //! @}
 
+//! Number of sectors in the sector cache (may be defined in conf_explorer.h)
+#ifndef  FS_NB_CACHE_SECTOR
+#  define FS_NB_CACHE_SECTOR        1
+#endif
+
+//! Size (unit byte) of the free cluster bitmap, 0 to scan the FAT at each allocation (may be defined in conf_explorer.h)
+//! The bitmap is used only if it has a bit for each cluster of the partition.
+//! FS_FREE_MAP_ADDR may give the address of the bitmap, e.g. in an external SDRAM.
+#ifndef  FS_FREE_MAP_SIZE
+#  define FS_FREE_MAP_SIZE          0
+#endif
+
+//! Number of file extent maps, 0 to read the FAT at each seek out of the cluster list cache (may be defined in conf_explorer.h)
+#ifndef  FS_NB_EXTENT_MAP
+#  define FS_NB_EXTENT_MAP          0
+#endif
+
+//! Number of extents (runs of contiguous clusters) stored in a file extent map (may be defined in conf_explorer.h)
+//! The part of a file after the last extent stored is read in FAT.
+#ifndef  FS_NB_EXTENT
+#  define FS_NB_EXTENT              8
+#endif
+
+//! Number of FAT updates (allocation or release of a cluster list) between two copies of FAT1 in FAT2, 0 to copy at each update (may be defined in conf_explorer.h)
+//! The FAT2 is also copied by fat_cache_flush(), e.g. at the file close.
+#ifndef  FS_FAT2_MIRROR_INTERVAL
+#  define FS_FAT2_MIRROR_INTERVAL   0
+#endif
+
+//! Size (unit byte) of the bitmap of FAT sectors to copy in FAT2 (may be defined in conf_explorer.h)
+//! On a large FAT, a bit covers several sectors.
+#ifndef  FS_FAT2_DIRTY_MAP_SIZE
+#  define FS_FAT2_DIRTY_MAP_SIZE    32
+#endif
+
 //! Signal that sector cache is not valid
 #define  FS_BUF_SECTOR_EMPTY        0xFF
 
@@ -354,6 +389,24 @@ typedef struct {
 } Fs_clusterlist_cache;
 
 
+//! Structure to store an extent (run of contiguous clusters) of a cluster list
+typedef struct {
+   uint32_t   u32_start;                    //!< Position of the extent in the cluster list (unit cluster)
+   uint32_t   u32_cluster;                  //!< First cluster of the extent
+} Fs_extent;
+
+//! Structure to store the extent map of a file cluster list
+typedef struct {
+   uint8_t    u8_lun;                       //!< LUN of cluster list, 0xFF if the map is free
+   uint8_t    u8_level_use;                 //!< Map level, 0 for the last used and up to FS_NB_EXTENT_MAP-1 for the oldest access
+   uint8_t    u8_nb_extent;                 //!< Number of extents stored
+   bool       b_complete;                   //!< true, if the last extent ends the cluster list
+   uint32_t   u32_cluster;                  //!< First cluster of cluster list
+   uint32_t   u32_nb_cluster;               //!< Number of clusters read in the cluster list
+   Fs_extent  extent[FS_NB_EXTENT];         //!< Extents sorted by position
+} Fs_extent_map;
+
+
 //! Structure to store the information about sector cache (=last sector read or write on disk)
 typedef struct {
    uint8_t    u8_lun;                       //!< LUN of sector
@@ -362,8 +415,17 @@ typedef struct {
                                        //!< if the sector is a sector from a cluster list THEN
    uint32_t   u32_clusterlist_start;        //!< first cluster of cluster list
    uint32_t   u32_clusterlist_pos;          //!< position in cluster list (unit 512B)
+   uint8_t    u8_level_use;                 //!< Cache level, 0 for the last used and up to FS_NB_CACHE_SECTOR-1 for the oldest access
 } Fs_sector_cache;
 
+//! Structure to store the sector cache statistics
+typedef struct {
+   uint32_t   u32_hit;                      //!< Sectors found in cache
+   uint32_t   u32_miss;                     //!< Sectors not found in cache
+   uint32_t   u32_eviction;                 //!< Sectors removed from cache to store an other sector
+   uint32_t   u32_writeback;                //!< Modified sectors written on the device
+} Fs_sector_cache_stat;
+
 
 //**** Definition of value used by the STRUCTURES of communication
 
@@ -426,8 +488,8 @@ _GLOBEXT_   _MEM_TYPE_SLOW_   uint32_t                  fs_g_u32_last_mod_fat;
 
 //! \name Variables used to manage the sector cache
 //! @{
-_GLOBEXT_   _MEM_TYPE_SLOW_   uint8_t                   fs_g_sector[ FS_CACHE_SIZE ];
-_GLOBEXT_   _MEM_TYPE_SLOW_   Fs_sector_cache      fs_g_sectorcache;
+_GLOBEXT_   _MEM_TYPE_SLOW_   uint8_t                   *fs_g_sector;           //!< Sector selected by the last fat_cache_read_sector()
+_GLOBEXT_   _MEM_TYPE_SLOW_   Fs_sector_cache_stat fs_g_sectorcache_stat;
 _GLOBEXT_   _MEM_TYPE_SLOW_   uint32_t                  fs_gu32_addrsector;     //!< Store the address of future cache (unit 512B)
 typedef uint8_t  _MEM_TYPE_SLOW_   * PTR_CACHE;
 //!}@
@@ -466,6 +528,8 @@ bool        fat_serialnumber              ( bool b_action , uint8_t _MEM_TYPE_SL
 //! @{
 uint32_t         fat_getfreespace              ( void );
 uint8_t          fat_getfreespace_percent      ( void );
+uint32_t         fat_count_freecluster         ( void );
+bool             fat_freespace_verify          ( void );
 bool        fat_write_fat32_FSInfo        ( uint32_t u32_nb_free_cluster );
 uint32_t         fat_read_fat32_FSInfo         ( void );
 //! @}
@@ -475,13 +539,25 @@ uint32_t         fat_read_fat32_FSInfo         ( void );
 //! @{
 bool        fat_cluster_list              ( uint8_t opt_action, bool b_for_file );
 void        fat_cache_clusterlist_reset   ( void );
+void        fat_extent_map_append         ( void );
 bool        fat_cluster_val               ( bool b_mode );
 bool        fat_cluster_readnext          ( void );
 uint8_t          fat_checkcluster              ( void );
 bool        fat_allocfreespace            ( void );
 void        fat_clear_info_fat_mod        ( void );
+void        fat_set_info_fat_mod          ( uint32_t u32_offset_fat );
 bool        fat_clear_cluster             ( void );
 bool        fat_update_fat2               ( void );
+bool        fat_update_fat2_now           ( void );
+//! @}
+
+
+//! \name Functions to manage the free cluster bitmap and count
+//! @{
+void        fat_freemap_reset             ( void );
+void        fat_freemap_update            ( bool b_was_free );
+bool        fat_freemap_build             ( void );
+uint32_t    fat_freemap_find              ( uint32_t u32_start , uint32_t u32_nb );
 //! @}
 
 
@@ -523,9 +599,12 @@ bool        fat_entry_label               ( bool b_action , FS_STRING sz_label )
 //! @{
 bool        fat_cache_read_sector         ( bool b_load );
 void        fat_cache_reset               ( void );
+void        fat_cache_reset_lun           ( uint8_t u8_lun );
 void        fat_cache_clear               ( void );
 void        fat_cache_mark_sector_as_dirty( void );
+bool        fat_cache_write_sector        ( void );
 bool        fat_cache_flush               ( void );
+bool        fat_cache_flush_segment       ( bool b_discard );
 //! @}
 
 
@@ -123,6 +123,9 @@ bool  fat_mount( void )
    fs_g_nav_fast.u8_type_fat = FS_TYPE_FAT_UNM;
    fs_gu32_addrsector = 0;    // Start read at the beginning of memory
 
+   // The FAT may have been modified since the free cluster bitmap was built
+   fat_freemap_reset();
+
    // Check if the drive is available
    if( !fat_check_device() )
       return false;
@@ -348,6 +351,9 @@ bool  fat_format( uint8_t u8_fat_type )
    fs_g_nav.u8_partition = 0;
 #endif
 
+   // The FAT is rewritten without updating the free cluster bitmap, and without copy in FAT2
+   fat_freemap_reset();
+   fat_clear_info_fat_mod();
 
    // Get drive capacity (= last LBA)
    mem_read_capacity( fs_g_nav.u8_lun , &fs_s_u32_size_partition );
@@ -2127,12 +2133,23 @@ bool  fat_delete_file( bool b_cluster_list )
 
 
 
-//! This function returns the space free in the partition
+//! \name Free cluster count of a partition, kept up to date by fat_cluster_val()
+//! @{
+_MEM_TYPE_SLOW_   uint8_t   fs_g_freecount_lun;        //!< LUN of the count, FS_BUF_SECTOR_EMPTY if no count
+_MEM_TYPE_SLOW_   uint32_t  fs_g_freecount_ptr_fat;    //!< FAT address of the partition of the count
+_MEM_TYPE_SLOW_   uint32_t  fs_g_freecount_nb_cluster; //!< Number of free clusters
+//! @}
+
+#define  Is_freecount_valid()       ((fs_g_freecount_lun     == fs_g_nav.u8_lun ) \
+                                   &&(fs_g_freecount_ptr_fat == fs_g_nav.u32_ptr_fat ))
+
+
+//! This function counts the free clusters with a scan of all FAT
 //!
-//! @return    the number of sector free <br>
-//!            if 0, then error or full
+//! @return    the number of free clusters <br>
+//!            if 0xFFFFFFFF, then error
 //!
-uint32_t   fat_getfreespace( void )
+uint32_t   fat_count_freecluster( void )
 {
    uint32_t u32_nb_free_cluster = 0;
 
@@ -2147,7 +2164,7 @@ uint32_t   fat_getfreespace( void )
       {
          // Get the value of the cluster
          if ( !fat_cluster_val( FS_CLUST_VAL_READ ) )
-            return 0;
+            return 0xFFFFFFFF;
 
          if ( 0 == fs_g_cluster.u32_val )
             u32_nb_free_cluster++;
@@ -2155,17 +2172,10 @@ uint32_t   fat_getfreespace( void )
    }
    else
    {
-      if( Is_fat32 )
-      {
-         u32_nb_free_cluster = fat_read_fat32_FSInfo();
-         if( 0xFFFFFFFF != u32_nb_free_cluster )
-            goto endof_fat_getfreespace;
-         u32_nb_free_cluster = 0;
-      }
       // Speed optimization only for FAT16 and FAT32
       // init first value used by fat_cluster_readnext()
       if( !fat_cluster_val( FS_CLUST_VAL_READ ))
-         return false;
+         return 0xFFFFFFFF;
       for(
       ;     fs_g_cluster.u32_pos < fs_g_nav.u32_CountofCluster
       ;     fs_g_cluster.u32_pos++ )
@@ -2173,21 +2183,94 @@ uint32_t   fat_getfreespace( void )
          if ( 0 == fs_g_cluster.u32_val )
             u32_nb_free_cluster++;
          if( !fat_cluster_readnext() )
-            return false;
+            return 0xFFFFFFFF;
       }
+   }
+   return u32_nb_free_cluster;
+}
+
+
+//! This function returns the space free in the partition
+//!
+//! @return    the number of sector free <br>
+//!            if 0, then error or full
+//!
+//! @verbatim
+//! The FAT is scanned only on the first call after the mount,
+//! then the count is updated on each cluster allocation or release.
+//! @endverbatim
+//!
+uint32_t   fat_getfreespace( void )
+{
+   uint32_t u32_nb_free_cluster;
+
+   if( Is_freecount_valid() )
+   {
+      u32_nb_free_cluster = fs_g_freecount_nb_cluster;
+      goto endof_fat_getfreespace;
+   }
+
+   if( Is_fat32 )
+   {
+      u32_nb_free_cluster = fat_read_fat32_FSInfo();
+      if( 0xFFFFFFFF != u32_nb_free_cluster )
+         goto endof_fat_getfreespace;
+   }
+
+   u32_nb_free_cluster = fat_count_freecluster();
+   if( 0xFFFFFFFF == u32_nb_free_cluster )
+      return 0;
+
 #if (FSFEATURE_WRITE_COMPLET == (FS_LEVEL_FEATURES & FSFEATURE_WRITE_COMPLET) )
-      if( Is_fat32 )
-      {
-         // Save value for the future call
-         fat_write_fat32_FSInfo( u32_nb_free_cluster );
-      }
-#endif
+   if( Is_fat32 )
+   {
+      // Save value for the future call
+      fat_write_fat32_FSInfo( u32_nb_free_cluster );
    }
+#endif
+   // Save value for the future call
+   fs_g_freecount_nb_cluster = u32_nb_free_cluster;
+   fs_g_freecount_lun        = fs_g_nav.u8_lun;
+   fs_g_freecount_ptr_fat    = fs_g_nav.u32_ptr_fat;
+
 endof_fat_getfreespace:
    return (u32_nb_free_cluster * fs_g_nav.u8_BPB_SecPerClus);
 }
 
 
+//! This function checks the free cluster count with a scan of all FAT
+//!
+//! @return    false in case of error or if the count was wrong, see global value "fs_g_status" for more detail
+//! @return    true otherwise
+//!
+//! @verbatim
+//! After this routine the count is valid, a wrong count is corrected.
+//! @endverbatim
+//!
+bool  fat_freespace_verify( void )
+{
+   uint32_t u32_nb_free_cluster;
+   bool b_ok = true;
+
+   u32_nb_free_cluster = fat_count_freecluster();
+   if( 0xFFFFFFFF == u32_nb_free_cluster )
+      return false;
+
+   if( Is_freecount_valid()
+   &&  (fs_g_freecount_nb_cluster != u32_nb_free_cluster) )
+   {
+      fs_g_status = FS_ERR_FS;   // The count has missed a FAT modification
+      b_ok = false;
+   }
+
+   // Resynchronize the count
+   fs_g_freecount_nb_cluster = u32_nb_free_cluster;
+   fs_g_freecount_lun        = fs_g_nav.u8_lun;
+   fs_g_freecount_ptr_fat    = fs_g_nav.u32_ptr_fat;
+   return b_ok;
+}
+
+
 //! This function returns the space free in percent
 //!
 //! @return    percent of free space (1 to 100)
@@ -2203,8 +2286,8 @@ uint8_t    fat_getfreespace_percent( void )
    uint16_t u16_pos;
    uint32_t u32_tmp;
 
-   if( Is_fat12 )
-   {  // No speed optimization necessary on FAT12
+   if( Is_freecount_valid() || Is_fat12 )
+   {  // The count is already known, or no speed optimization necessary on FAT12
       return (((fat_getfreespace()/fs_g_nav.u8_BPB_SecPerClus)*100) / fs_g_nav.u32_CountofCluster);
    }
 
@@ -2277,6 +2360,223 @@ endof_fat_getfreespace_percent:
 
 
 
+#if (FS_FREE_MAP_SIZE != 0)
+//! \name Free cluster bitmap, one bit per cluster set if the cluster is used
+//! @{
+#ifdef FS_FREE_MAP_ADDR
+#  define fs_g_freemap_bits   ((uint32_t *)(FS_FREE_MAP_ADDR))
+#else
+_MEM_TYPE_SLOW_   uint32_t  fs_g_freemap_bits[FS_FREE_MAP_SIZE/4];
+#endif
+_MEM_TYPE_SLOW_   uint8_t   fs_g_freemap_lun;       //!< LUN of the bitmap, FS_BUF_SECTOR_EMPTY if no bitmap
+_MEM_TYPE_SLOW_   uint32_t  fs_g_freemap_ptr_fat;   //!< FAT address of the partition of the bitmap
+//! @}
+
+#define  Is_freemap_used( pos )     (fs_g_freemap_bits[(pos)>>5] &  (1UL<<((pos)&31)))
+#define  Freemap_set_used( pos )    (fs_g_freemap_bits[(pos)>>5] |= (1UL<<((pos)&31)))
+#define  Freemap_set_free( pos )    (fs_g_freemap_bits[(pos)>>5] &= ~(1UL<<((pos)&31)))
+#endif
+
+
+//! This function removes the free cluster bitmap and the free cluster count
+//!
+//! The bitmap is built again by the next allocation,
+//! the count by the next request of free space.
+//!
+void  fat_freemap_reset( void )
+{
+   fs_g_freecount_lun = FS_BUF_SECTOR_EMPTY;
+#if (FS_FREE_MAP_SIZE != 0)
+   fs_g_freemap_lun = FS_BUF_SECTOR_EMPTY;
+#endif
+}
+
+
+//! This function updates the free cluster count and bitmap with a cluster value written in FAT
+//!
+//! @param     b_was_free  true, if the old cluster value was free
+//!
+//! @verbatim
+//! Global variables used
+//! IN :
+//!   fs_g_cluster.u32_pos    cluster position
+//!   fs_g_cluster.u32_val    new cluster value
+//! @endverbatim
+//!
+void  fat_freemap_update( bool b_was_free )
+{
+   if( b_was_free == (0 == fs_g_cluster.u32_val) )
+      return;     // The cluster state doesn't change
+
+   if( Is_freecount_valid() )
+   {
+      if( b_was_free )
+         fs_g_freecount_nb_cluster--;
+      else
+         fs_g_freecount_nb_cluster++;
+   }
+
+#if (FS_FREE_MAP_SIZE != 0)
+   if( (fs_g_freemap_lun     != fs_g_nav.u8_lun )
+   ||  (fs_g_freemap_ptr_fat != fs_g_nav.u32_ptr_fat ) )
+      return;     // No bitmap for this partition
+
+   if( 0 == fs_g_cluster.u32_val )
+      Freemap_set_free( fs_g_cluster.u32_pos );
+   else
+      Freemap_set_used( fs_g_cluster.u32_pos );
+#endif
+}
+
+
+#if (FS_FREE_MAP_SIZE != 0)
+//! This function builds the free cluster bitmap of the current partition, if necessary
+//!
+//! @return    false, no bitmap (RAM too small for the partition or error)
+//! @return    true otherwise
+//!
+bool  fat_freemap_build( void )
+{
+   uint32_t u32_nb_free_cluster = 0;
+
+   if( (fs_g_freemap_lun     == fs_g_nav.u8_lun )
+   &&  (fs_g_freemap_ptr_fat == fs_g_nav.u32_ptr_fat ) )
+      return true;   // Bitmap already built
+
+   if( fs_g_nav.u32_CountofCluster > (FS_FREE_MAP_SIZE*8UL) )
+      return false;  // The bitmap doesn't fit, the FAT is scanned instead
+
+   // All clusters used by default, it covers the reserved clusters and the end of the last word
+   memset( fs_g_freemap_bits , 0xFF , ((fs_g_nav.u32_CountofCluster+31)/32)*4 );
+
+   // Read ALL FAT1
+   fs_g_cluster.u32_pos = 2;
+   if( !fat_cluster_val( FS_CLUST_VAL_READ ))
+      return false;
+   for(
+   ;     fs_g_cluster.u32_pos < fs_g_nav.u32_CountofCluster
+   ;     fs_g_cluster.u32_pos++ )
+   {
+      if( Is_fat12 )
+      {
+         if( !fat_cluster_val( FS_CLUST_VAL_READ ))
+            return false;
+      }
+      if( 0 == fs_g_cluster.u32_val )
+      {
+         Freemap_set_free( fs_g_cluster.u32_pos );
+         u32_nb_free_cluster++;
+      }
+      if( !Is_fat12 )
+      {
+         // Speed optimization only for FAT16 and FAT32
+         if( !fat_cluster_readnext() )
+            return false;
+      }
+   }
+
+   fs_g_freemap_lun     = fs_g_nav.u8_lun;
+   fs_g_freemap_ptr_fat = fs_g_nav.u32_ptr_fat;
+   // The scan gives also the free cluster count
+   fs_g_freecount_nb_cluster = u32_nb_free_cluster;
+   fs_g_freecount_lun        = fs_g_nav.u8_lun;
+   fs_g_freecount_ptr_fat    = fs_g_nav.u32_ptr_fat;
+   return true;
+}
+
+
+//! This function searches a run of free clusters in the bitmap
+//!
+//! The search starts at u32_start, continues until the end of the partition
+//! then restarts at the beginning of the partition.
+//! A full word of the bitmap (32 clusters) is checked at once.
+//!
+//! @param     u32_start   first cluster to check
+//! @param     u32_nb      number of clusters wanted
+//!
+//! @return    the first cluster of the first run of u32_nb free clusters <br>
+//!            else the first cluster of the longest run of free clusters <br>
+//!            fs_g_nav.u32_CountofCluster if no free cluster
+//!
+uint32_t fat_freemap_find( uint32_t u32_start , uint32_t u32_nb )
+{
+   uint32_t u32_pos, u32_end, u32_word;
+   uint32_t u32_run = 0, u32_run_pos = 0;
+   uint32_t u32_best = 0, u32_best_pos = fs_g_nav.u32_CountofCluster;
+   bool b_wrap = false;
+
+   if( (u32_start < 2) || (u32_start >= fs_g_nav.u32_CountofCluster) )
+      u32_start = 2;
+   if( 0 == u32_nb )
+      u32_nb = 1;
+   u32_pos = u32_start;
+   u32_end = fs_g_nav.u32_CountofCluster;
+
+   while( 1 )
+   {
+      if( u32_pos >= u32_end )
+      {
+         // End of range, a run doesn't continue at the beginning of partition
+         if( u32_run > u32_best )
+         {
+            u32_best = u32_run;
+            u32_best_pos = u32_run_pos;
+         }
+         if( b_wrap )
+            break;
+         b_wrap = true;
+         u32_run = 0;
+         u32_pos = 2;
+         u32_end = u32_start;
+         continue;
+      }
+
+      u32_word = fs_g_freemap_bits[u32_pos>>5];
+      if( (0 == (u32_pos & 31))
+      &&  ((u32_pos+32) <= u32_end)
+      &&  ((0 == u32_word) || (0xFFFFFFFF == u32_word)) )
+      {
+         // 32 clusters with the same state
+         if( 0 == u32_word )
+         {
+            if( 0 == u32_run )
+               u32_run_pos = u32_pos;
+            u32_run += 32;
+         }else{
+            if( u32_run > u32_best )
+            {
+               u32_best = u32_run;
+               u32_best_pos = u32_run_pos;
+            }
+            u32_run = 0;
+         }
+         u32_pos += 32;
+      }
+      else
+      {
+         if( 0 == (u32_word & (1UL<<(u32_pos&31))) )
+         {
+            if( 0 == u32_run )
+               u32_run_pos = u32_pos;
+            u32_run++;
+         }else{
+            if( u32_run > u32_best )
+            {
+               u32_best = u32_run;
+               u32_best_pos = u32_run_pos;
+            }
+            u32_run = 0;
+         }
+         u32_pos++;
+      }
+      if( u32_run >= u32_nb )
+         return u32_run_pos;  // Run large enough
+   }
+   return u32_best_pos;
+}
+#endif  // FS_FREE_MAP_SIZE
+
+
 #if (FSFEATURE_WRITE == (FS_LEVEL_FEATURES & FSFEATURE_WRITE))
 //! This function allocs a cluster list
 //!
@@ -2300,6 +2600,10 @@ bool  fat_allocfreespace( void )
    bool first_cluster_free_is_found = false;
    // If true then use a quick procedure but don't scan all FAT else use a slow procedure but scan all FAT
    bool b_quick_find = true;
+#if (FS_FREE_MAP_SIZE != 0)
+   // If true then the free clusters are searched in the bitmap
+   bool b_freemap = fat_freemap_build();
+#endif
 
    if( Is_fat32 )
    {
@@ -2318,7 +2622,21 @@ fat_allocfreespace_start:
       fs_g_cluster.u32_pos = fs_g_seg.u32_addr+1;
    }
 
-   fat_clear_info_fat_mod();
+#if (FS_FREE_MAP_SIZE != 0)
+   if( b_freemap )
+   {
+      // The bitmap gives the free clusters, the FAT is only read on the run allocated
+      b_quick_find = false;
+      if( (0xFF == MSB0(fs_g_seg.u32_addr))
+      ||  (fs_g_cluster.u32_pos >= fs_g_nav.u32_CountofCluster)
+      ||  Is_freemap_used( fs_g_cluster.u32_pos ) )
+      {
+         // Take the first run large enough for the size asked, else the largest run
+         fs_g_cluster.u32_pos = fat_freemap_find( fs_g_cluster.u32_pos ,
+               (fs_g_seg.u32_size_or_pos + fs_g_nav.u8_BPB_SecPerClus - 1) / fs_g_nav.u8_BPB_SecPerClus );
+      }  // else the cluster following the cluster list is free, the list stays continue
+   }
+#endif
 
    // Read ALL FAT1
    for(
@@ -2423,41 +2741,144 @@ fat_allocfreespace_start:
 
 
 #if (FS_LEVEL_FEATURES > FSFEATURE_READ)
+//! \name Information about the FAT modifications not yet copied in FAT2
+//! The range fs_g_u32_first_mod_fat..fs_g_u32_last_mod_fat bounds the bitmap
+//! @{
+_MEM_TYPE_SLOW_   uint8_t   fs_g_fat2_dirty[FS_FAT2_DIRTY_MAP_SIZE];   //!< Bitmap of FAT sectors modified, one bit for 2^fs_g_u8_fat2_shift sectors
+_MEM_TYPE_SLOW_   uint8_t   fs_g_u8_fat2_shift;                        //!< Number of FAT sectors by bit (power of 2)
+_MEM_TYPE_SLOW_   uint8_t   fs_g_u8_mod_fat_lun;                       //!< LUN of the modifications, FS_BUF_SECTOR_EMPTY if no modification
+_MEM_TYPE_SLOW_   uint32_t  fs_g_u32_mod_fat_ptr;                      //!< FAT address of the partition of the modifications
+#if (FS_FAT2_MIRROR_INTERVAL != 0)
+_MEM_TYPE_SLOW_   uint16_t  fs_g_u16_fat2_nb_update;                   //!< Number of FAT updates since the last copy in FAT2
+#endif
+//! @}
+
+#define  Is_fat2_dirty( offset )    (fs_g_fat2_dirty[((offset)>>fs_g_u8_fat2_shift)>>3] &  (1<<(((offset)>>fs_g_u8_fat2_shift)&7)))
+#define  Fat2_set_dirty( offset )   (fs_g_fat2_dirty[((offset)>>fs_g_u8_fat2_shift)>>3] |= (1<<(((offset)>>fs_g_u8_fat2_shift)&7)))
+
+
 //! This function clears the cache information about FAT modifications
 //!
 void  fat_clear_info_fat_mod( void )
 {
    fs_g_u32_first_mod_fat = 0xFFFFFFFF;
    fs_g_u32_last_mod_fat = 0;
+   fs_g_u8_mod_fat_lun = FS_BUF_SECTOR_EMPTY;
+   memset( fs_g_fat2_dirty , 0 , sizeof(fs_g_fat2_dirty) );
 }
-#endif  // FS_LEVEL_FEATURES
 
 
-#if (FS_LEVEL_FEATURES > FSFEATURE_READ)
-//! This function copies the modifications of the first FAT to the second FAT
+//! This function signals a modification of a FAT1 sector
+//!
+//! @param     u32_offset_fat    offset of sector in FAT (unit 512B)
+//!
+//! @verbatim
+//! The modifications not yet copied on an other partition are lost,
+//! the FAT2 of this partition stays old (the FAT1 is the reference).
+//! @endverbatim
+//!
+void  fat_set_info_fat_mod( uint32_t u32_offset_fat )
+{
+   if( (fs_g_u8_mod_fat_lun  != fs_g_nav.u8_lun )
+   ||  (fs_g_u32_mod_fat_ptr != fs_g_nav.u32_ptr_fat ) )
+   {
+      // First modification on this partition
+      fat_clear_info_fat_mod();
+      fs_g_u8_mod_fat_lun  = fs_g_nav.u8_lun;
+      fs_g_u32_mod_fat_ptr = fs_g_nav.u32_ptr_fat;
+      // Compute the number of sectors by bit to cover all FAT with the bitmap
+      fs_g_u8_fat2_shift = 0;
+      while( ((fs_g_nav.u32_fat_size-1) >> fs_g_u8_fat2_shift) >= (FS_FAT2_DIRTY_MAP_SIZE*8UL) )
+         fs_g_u8_fat2_shift++;
+   }
+
+   if( fs_g_u32_first_mod_fat > u32_offset_fat )
+   {
+      fs_g_u32_first_mod_fat = u32_offset_fat;
+   }
+   if( fs_g_u32_last_mod_fat < u32_offset_fat )
+   {
+      fs_g_u32_last_mod_fat = u32_offset_fat;
+   }
+   Fat2_set_dirty( u32_offset_fat );
+}
+
+
+//! This function signals the end of a FAT update (allocation or release of a cluster list)
 //!
 //! @return    false in case of error, see global value "fs_g_status" for more detail
 //! @return    true otherwise
 //!
+//! @verbatim
+//! The FAT2 is updated only every FS_FAT2_MIRROR_INTERVAL updates,
+//! and by fat_cache_flush() (e.g. at the file close).
+//! @endverbatim
+//!
 bool  fat_update_fat2( void )
 {
-  while( fs_g_u32_first_mod_fat <= fs_g_u32_last_mod_fat )
-  {
-     // Compute the modification position of FAT 1
-     fs_gu32_addrsector = fs_g_nav.u32_ptr_fat + fs_g_u32_first_mod_fat;
-     // Read FAT1
+#if (FS_FAT2_MIRROR_INTERVAL != 0)
+   if( ++fs_g_u16_fat2_nb_update < FS_FAT2_MIRROR_INTERVAL )
+      return true;   // The copy is delayed
+#endif
+   return fat_update_fat2_now();
+}
+
+
+//! This function copies the modifications of the first FAT to the second FAT
+//!
+//! @return    false in case of error, see global value "fs_g_status" for more detail
+//! @return    true otherwise
+//!
+//! @verbatim
+//! Only the sectors signaled in the bitmap are copied.
+//! When the copy is delayed (FS_FAT2_MIRROR_INTERVAL != 0), a modified FAT1
+//! sector is written before its copy is staged, so that after a power loss
+//! FAT2 holds at worst an older FAT1. Otherwise both stay in the cache.
+//! @endverbatim
+//!
+bool  fat_update_fat2_now( void )
+{
+   uint32_t u32_offset_fat;
+
+#if (FS_FAT2_MIRROR_INTERVAL != 0)
+   fs_g_u16_fat2_nb_update = 0;
+#endif
+   if( (fs_g_u8_mod_fat_lun  != fs_g_nav.u8_lun )
+   ||  (fs_g_u32_mod_fat_ptr != fs_g_nav.u32_ptr_fat ) )
+      return true;   // No modification on this partition
+   if( FS_TYPE_FAT_UNM == fs_g_nav_fast.u8_type_fat )
+      return true;   // The partition isn't mounted, the modifications are kept
+
+   for( u32_offset_fat = fs_g_u32_first_mod_fat
+   ;    u32_offset_fat <= fs_g_u32_last_mod_fat
+   ;    u32_offset_fat++ )
+   {
+      if( !Is_fat2_dirty( u32_offset_fat ))
+      {
+         // Go to the last sector of the group of sectors not modified
+         u32_offset_fat |= (1UL<<fs_g_u8_fat2_shift)-1;
+         continue;
+      }
+      // Compute the modification position of FAT 1
+      fs_gu32_addrsector = fs_g_nav.u32_ptr_fat + u32_offset_fat;
+      // Read FAT1
       if( !fat_cache_read_sector( true ))
          return false;
-     // Compute the modification position of FAT 2
-     fs_gu32_addrsector = fs_g_nav.u32_ptr_fat + (fs_g_u32_first_mod_fat + fs_g_nav.u32_fat_size);
-     // Init the sector FAT2 with the previous sector of the FAT1
-     if( !fat_cache_read_sector( false ))
+#if (FS_FAT2_MIRROR_INTERVAL != 0)
+      // Write FAT1 before its copy, so that on the memory FAT2 is never ahead of FAT1
+      if( !fat_cache_write_sector())
          return false;
-     // Flag the sector FAT2 like modify
-     fat_cache_mark_sector_as_dirty();
-     fs_g_u32_first_mod_fat++;
-  }
-  return true;
+#endif
+      // Compute the modification position of FAT 2
+      fs_gu32_addrsector = fs_g_nav.u32_ptr_fat + (u32_offset_fat + fs_g_nav.u32_fat_size);
+      // Init the sector FAT2 with the previous sector of the FAT1
+      if( !fat_cache_read_sector( false ))
+         return false;
+      // Flag the sector FAT2 like modify
+      fat_cache_mark_sector_as_dirty();
+   }
+   fat_clear_info_fat_mod();
+   return true;
 }
 #endif  // FS_LEVEL_FEATURES
 
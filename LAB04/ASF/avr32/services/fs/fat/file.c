@@ -60,14 +60,6 @@
 
 //_____ D E C L A R A T I O N S ____________________________________________
 
-//! Use "FAT sector cache" to store a sector from a file (see file_putc(), file_getc(), file_read_buf(), file_write_buf())
-#if (defined __GNUC__) && (defined __AVR32__)
-__attribute__((__aligned__(4)))
-#elif (defined __ICCAVR32__)
-#pragma data_alignment = 4
-#endif
-extern   _MEM_TYPE_SLOW_   uint8_t    fs_g_sector[ FS_CACHE_SIZE ];
-
 static   void  file_load_segment_value( Fs_file_segment _MEM_TYPE_SLOW_ *segment );
 
 
@@ -314,18 +306,17 @@ uint16_t   file_read_buf( uint8_t _MEM_TYPE_SLOW_ *buffer , uint16_t u16_buf_siz
             fs_g_seg.u32_size_or_pos = u16_nb_read_tmp;
          }
 
-         // Directly data transfers from memory to buffer
-         while( 0 != fs_g_seg.u32_size_or_pos )
+         // The sectors modified in internal cache must be written before
+         if( !fat_cache_flush_segment( false ))
+            return u16_nb_read;
+
+         // Directly data transfers from memory to buffer, the whole segment in one memory command
+         if( CTRL_GOOD != memory_2_ram_multi( fs_g_nav.u8_lun  , fs_g_seg.u32_addr, u16_nb_read_tmp, buffer))
          {
-            if( CTRL_GOOD != memory_2_ram( fs_g_nav.u8_lun  , fs_g_seg.u32_addr, buffer))
-            {
-               fs_g_status = FS_ERR_HW;
-               return u16_nb_read;
-            }
-            fs_g_seg.u32_size_or_pos--;
-            fs_g_seg.u32_addr++;
-            buffer += FS_512B;
+            fs_g_status = FS_ERR_HW;
+            return u16_nb_read;
          }
+         buffer += u16_nb_read_tmp * FS_512B;
          // Translate from sector unit to byte unit
          u16_nb_read_tmp *= FS_512B;
       }
@@ -535,18 +526,17 @@ uint16_t   file_write_buf( uint8_t _MEM_TYPE_SLOW_ *buffer , uint16_t u16_buf_si
             u16_nb_write_tmp = fs_g_seg.u32_size_or_pos;
          }
 
-         // Directly data transfers from buffer to memory
-         while( 0 != fs_g_seg.u32_size_or_pos )
+         // The sectors in internal cache are replaced by the buffer
+         if( !fat_cache_flush_segment( true ))
+            return false;
+
+         // Directly data transfers from buffer to memory, the whole segment in one memory command
+         if( CTRL_GOOD != ram_2_memory_multi( fs_g_nav.u8_lun  , fs_g_seg.u32_addr, u16_nb_write_tmp, buffer))
          {
-            if( CTRL_GOOD != ram_2_memory( fs_g_nav.u8_lun  , fs_g_seg.u32_addr, buffer))
-            {
-               fs_g_status = FS_ERR_HW;
-               return u16_nb_write;
-            }
-            fs_g_seg.u32_size_or_pos--;
-            fs_g_seg.u32_addr++;
-            buffer += FS_512B;
+            fs_g_status = FS_ERR_HW;
+            return u16_nb_write;
          }
+         buffer += u16_nb_write_tmp * FS_512B;
          // Translate from sector unit to byte unit
          u16_nb_write_tmp *= FS_512B;
       }
@@ -252,6 +252,9 @@ bool  nav_select( uint8_t u8_idnav )
 #if (FS_NB_NAVIGATOR > 1)
    if( fs_g_u8_nav_selected != u8_idnav )
    {
+#if (FS_LEVEL_FEATURES > FSFEATURE_READ)
+      fat_update_fat2_now();                    // The FAT2 modifications delayed are for the partition of previous navigator
+#endif
       fat_invert_nav( fs_g_u8_nav_selected );   // Deselect previous navigator = Select default navigator
       fat_invert_nav( u8_idnav );               // Select new navigator
       fs_g_u8_nav_selected = u8_idnav;
@@ -343,6 +346,10 @@ bool  nav_drive_set( uint8_t u8_number )
    if ( fs_g_nav.u8_lun == u8_number)
       return true;   // It is the same drive number
 
+#if (FS_LEVEL_FEATURES > FSFEATURE_READ)
+   fat_update_fat2_now();                 // The FAT2 modifications delayed are for the previous drive
+#endif
+
    // Go to the device
    fs_g_nav.u8_lun = u8_number;
    fs_g_nav_fast.u8_type_fat = FS_TYPE_FAT_UNM;
@@ -640,6 +647,23 @@ uint8_t    nav_partition_freespace_percent( void )
    return fat_getfreespace_percent();
 }
 
+//! This function checks the free space count of the partition with a scan of all FAT
+//!
+//! @return    false in case of error or if the count was wrong, see global value "fs_g_status" for more detail
+//! @return    true otherwise
+//!
+//! @verbatim
+//! The free space count is kept up to date on each cluster allocation or release,
+//! this routine is a debug help to check it. A wrong count is corrected.
+//! @endverbatim
+//!
+bool  nav_partition_freespace_verify( void )
+{
+   if ( !fat_check_mount())
+      return false;
+   return fat_freespace_verify();
+}
+
 
 //**********************************************************************
 //****************** File list navigation functions ********************
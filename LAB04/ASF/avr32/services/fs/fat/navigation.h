@@ -333,6 +333,18 @@ uint32_t   nav_partition_freespace( void );
 //!
 uint8_t    nav_partition_freespace_percent( void );
 
+//! This function checks the free space count of the partition with a scan of all FAT
+//!
+//! @return    false in case of error or if the count was wrong, see global value "fs_g_status" for more detail
+//! @return    true otherwise
+//!
+//! @verbatim
+//! The free space count is kept up to date on each cluster allocation or release,
+//! this routine is a debug help to check it. A wrong count is corrected.
+//! @endverbatim
+//!
+bool  nav_partition_freespace_verify( void );
+
 
 //**********************************************************************
 //****************** File list navigation functions ********************
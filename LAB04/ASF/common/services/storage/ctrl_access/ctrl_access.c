@@ -109,6 +109,12 @@ static xSemaphoreHandle ctrl_access_semphr = NULL;
 
 //! @}
 
+//! Set while a user holds the LUNs, see ctrl_access_lock().
+static volatile bool ctrl_access_locked = false;
+
+//! Number of times the LUNs have been locked.
+static volatile U32 ctrl_access_nb_locks = 0;
+
 #endif  // FREERTOS_USED
 
 
@@ -132,6 +138,8 @@ static xSemaphoreHandle ctrl_access_semphr = NULL;
     TPASTE3(Lun_, lun, _usb_write_10),\
     TPASTE3(Lun_, lun, _mem_2_ram),\
     TPASTE3(Lun_, lun, _ram_2_mem),\
+    TPASTE3(Lun_, lun, _mem_2_ram_multi),\
+    TPASTE3(Lun_, lun, _ram_2_mem_multi),\
     TPASTE3(LUN_, lun, _NAME)\
   }
 #elif ACCESS_USB == true
@@ -156,6 +164,8 @@ static xSemaphoreHandle ctrl_access_semphr = NULL;
     TPASTE3(Lun_, lun, _removal),\
     TPASTE3(Lun_, lun, _mem_2_ram),\
     TPASTE3(Lun_, lun, _ram_2_mem),\
+    TPASTE3(Lun_, lun, _mem_2_ram_multi),\
+    TPASTE3(Lun_, lun, _ram_2_mem_multi),\
     TPASTE3(LUN_, lun, _NAME)\
   }
 #else
@@ -185,6 +195,8 @@ static const struct
 #if ACCESS_MEM_TO_RAM == true
   Ctrl_status (*mem_2_ram)(U32, void *);
   Ctrl_status (*ram_2_mem)(U32, const void *);
+  Ctrl_status (*mem_2_ram_multi)(U32, U16, void *);
+  Ctrl_status (*ram_2_mem_multi)(U32, U16, const void *);
 #endif
   const char *name;
 } lun_desc[MAX_LUN] =
@@ -192,48 +204,96 @@ static const struct
 #if LUN_0 == ENABLE
 # ifndef Lun_0_unload
 #  define Lun_0_unload NULL
+# endif
+# ifndef Lun_0_mem_2_ram_multi
+#  define Lun_0_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_0_ram_2_mem_multi
+#  define Lun_0_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(0),
 #endif
 #if LUN_1 == ENABLE
 # ifndef Lun_1_unload
 #  define Lun_1_unload NULL
+# endif
+# ifndef Lun_1_mem_2_ram_multi
+#  define Lun_1_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_1_ram_2_mem_multi
+#  define Lun_1_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(1),
 #endif
 #if LUN_2 == ENABLE
 # ifndef Lun_2_unload
 #  define Lun_2_unload NULL
+# endif
+# ifndef Lun_2_mem_2_ram_multi
+#  define Lun_2_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_2_ram_2_mem_multi
+#  define Lun_2_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(2),
 #endif
 #if LUN_3 == ENABLE
 # ifndef Lun_3_unload
 #  define Lun_3_unload NULL
+# endif
+# ifndef Lun_3_mem_2_ram_multi
+#  define Lun_3_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_3_ram_2_mem_multi
+#  define Lun_3_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(3),
 #endif
 #if LUN_4 == ENABLE
 # ifndef Lun_4_unload
 #  define Lun_4_unload NULL
+# endif
+# ifndef Lun_4_mem_2_ram_multi
+#  define Lun_4_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_4_ram_2_mem_multi
+#  define Lun_4_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(4),
 #endif
 #if LUN_5 == ENABLE
 # ifndef Lun_5_unload
 #  define Lun_5_unload NULL
+# endif
+# ifndef Lun_5_mem_2_ram_multi
+#  define Lun_5_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_5_ram_2_mem_multi
+#  define Lun_5_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(5),
 #endif
 #if LUN_6 == ENABLE
 # ifndef Lun_6_unload
 #  define Lun_6_unload NULL
+# endif
+# ifndef Lun_6_mem_2_ram_multi
+#  define Lun_6_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_6_ram_2_mem_multi
+#  define Lun_6_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(6),
 #endif
 #if LUN_7 == ENABLE
 # ifndef Lun_7_unload
 #  define Lun_7_unload NULL
+# endif
+# ifndef Lun_7_mem_2_ram_multi
+#  define Lun_7_mem_2_ram_multi NULL
+# endif
+# ifndef Lun_7_ram_2_mem_multi
+#  define Lun_7_ram_2_mem_multi NULL
 # endif
   Lun_desc_entry(7)
 #endif
@@ -285,6 +345,36 @@ static bool ctrl_access_lock(void)
   return true;
 }
 
+#else
+
+bool ctrl_access_lock(void)
+{
+  irqflags_t flags = cpu_irq_save();
+  bool locked = !ctrl_access_locked;
+
+  if (locked)
+  {
+    ctrl_access_locked = true;
+    ctrl_access_nb_locks++;
+  }
+
+  cpu_irq_restore(flags);
+
+  return locked;
+}
+
+
+void ctrl_access_unlock(void)
+{
+  ctrl_access_locked = false;
+}
+
+
+U32 ctrl_access_get_nb_locks(void)
+{
+  return ctrl_access_nb_locks;
+}
+
 #endif  // FREERTOS_USED
 
 
@@ -591,6 +681,68 @@ Ctrl_status ram_2_memory(U8 lun, U32 addr, const void *ram)
 }
 
 
+Ctrl_status memory_2_ram_multi(U8 lun, U32 addr, U16 nb_sector, void *ram)
+{
+  Ctrl_status status = CTRL_GOOD;
+  U8 *sector = ram;
+
+#if MAX_LUN
+  if (lun < MAX_LUN && lun_desc[lun].mem_2_ram_multi)
+  {
+    if (!Ctrl_access_lock()) return CTRL_FAIL;
+
+    memory_start_read_action(nb_sector);
+    status = lun_desc[lun].mem_2_ram_multi(addr, nb_sector, ram);
+    memory_stop_read_action();
+
+    Ctrl_access_unlock();
+
+    return status;
+  }
+#endif
+
+  // No multiple sector support in the LUN: read sector by sector.
+  while (nb_sector--)
+  {
+    if ((status = memory_2_ram(lun, addr++, sector)) != CTRL_GOOD) break;
+    sector += SECTOR_SIZE;
+  }
+
+  return status;
+}
+
+
+Ctrl_status ram_2_memory_multi(U8 lun, U32 addr, U16 nb_sector, const void *ram)
+{
+  Ctrl_status status = CTRL_GOOD;
+  const U8 *sector = ram;
+
+#if MAX_LUN
+  if (lun < MAX_LUN && lun_desc[lun].ram_2_mem_multi)
+  {
+    if (!Ctrl_access_lock()) return CTRL_FAIL;
+
+    memory_start_write_action(nb_sector);
+    status = lun_desc[lun].ram_2_mem_multi(addr, nb_sector, ram);
+    memory_stop_write_action();
+
+    Ctrl_access_unlock();
+
+    return status;
+  }
+#endif
+
+  // No multiple sector support in the LUN: write sector by sector.
+  while (nb_sector--)
+  {
+    if ((status = ram_2_memory(lun, addr++, sector)) != CTRL_GOOD) break;
+    sector += SECTOR_SIZE;
+  }
+
+  return status;
+}
+
+
 //! @}
 
 #endif  // ACCESS_MEM_TO_RAM == true
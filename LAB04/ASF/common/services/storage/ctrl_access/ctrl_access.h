@@ -193,6 +193,33 @@ extern bool g_wr_protect;
  */
 extern bool ctrl_access_init(void);
 
+#else
+
+/*! \brief Takes the LUNs for a user, without waiting.
+ *
+ * Without an RTOS the LUN functions below are not locked one by one. Instead
+ * the users sharing the memories (the USB Mass Storage interface and the
+ * local file system) hold the lock around each command or session, so that
+ * one of them never works on data the other one is changing.
+ *
+ * \return \c true if the LUNs were free and are now locked, else \c false.
+ */
+extern bool ctrl_access_lock(void);
+
+/*! \brief Gives the LUNs back.
+ */
+extern void ctrl_access_unlock(void);
+
+/*! \brief Returns the number of times the LUNs have been locked.
+ *
+ * A user that finds this count changed by more than its own locks knows
+ * that somebody else accessed the memories in between, e.g. that its cached
+ * copy of the file system may be stale.
+ *
+ * \return Number of successful calls to \ref ctrl_access_lock.
+ */
+extern U32 ctrl_access_get_nb_locks(void);
+
 #endif  // FREERTOS_USED
 
 /*! \brief Returns the number of LUNs.
@@ -337,6 +364,34 @@ extern Ctrl_status memory_2_ram(U8 lun, U32 addr, void *ram);
  */
 extern Ctrl_status ram_2_memory(U8 lun, U32 addr, const void *ram);
 
+/*! \brief Copies several contiguous data sectors from the memory to RAM.
+ *
+ * LUNs providing a \c Lun_x_mem_2_ram_multi function transfer all sectors in
+ * one memory command, others fall back to sector by sector reads.
+ *
+ * \param lun       Logical Unit Number.
+ * \param addr      Address of first memory sector to read.
+ * \param nb_sector Number of sectors to transfer.
+ * \param ram       Pointer to RAM buffer to write (\a nb_sector sectors).
+ *
+ * \return Status.
+ */
+extern Ctrl_status memory_2_ram_multi(U8 lun, U32 addr, U16 nb_sector, void *ram);
+
+/*! \brief Copies several contiguous data sectors from RAM to the memory.
+ *
+ * LUNs providing a \c Lun_x_ram_2_mem_multi function transfer all sectors in
+ * one memory command, others fall back to sector by sector writes.
+ *
+ * \param lun       Logical Unit Number.
+ * \param addr      Address of first memory sector to write.
+ * \param nb_sector Number of sectors to transfer.
+ * \param ram       Pointer to RAM buffer to read (\a nb_sector sectors).
+ *
+ * \return Status.
+ */
+extern Ctrl_status ram_2_memory_multi(U8 lun, U32 addr, U16 nb_sector, const void *ram);
+
 //! @}
 
 #endif  // ACCESS_MEM_TO_RAM == true
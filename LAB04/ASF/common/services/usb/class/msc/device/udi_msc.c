@@ -0,0 +1,914 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief USB Device Mass Storage Class (MSC) interface.
+ *
+ ******************************************************************************/
+
+#include "conf_usb.h"
+#include "usb_protocol.h"
+#include "usb_protocol_msc.h"
+#include "spc_protocol.h"
+#include "sbc_protocol.h"
+#include "udd.h"
+#include "udc.h"
+#include "udi_msc.h"
+#include "ctrl_access.h"
+#include <string.h>
+
+#ifndef UDI_MSC_NOTIFY_TRANS_EXT
+#  define UDI_MSC_NOTIFY_TRANS_EXT()
+#endif
+
+/**
+ * \ingroup udi_msc_group
+ * \defgroup udi_msc_group_udc Interface with USB Device Core (UDC)
+ *
+ * Structures and functions required by UDC.
+ *
+ * @{
+ */
+bool udi_msc_enable(void);
+void udi_msc_disable(void);
+bool udi_msc_setup(void);
+uint8_t udi_msc_getsetting(void);
+
+//! Global structure which contains standard UDI API for UDC
+UDC_DESC_STORAGE udi_api_t udi_api_msc = {
+	.enable = udi_msc_enable,
+	.disable = udi_msc_disable,
+	.setup = udi_msc_setup,
+	.getsetting = udi_msc_getsetting,
+	.sof_notify = NULL,
+};
+//@}
+
+
+/**
+ * \ingroup udi_msc_group
+ * \defgroup udi_msc_group_internal Implementation of UDI MSC
+ *
+ * Class internal implementation
+ * @{
+ */
+
+//! Size of the sectors exchanged with the memories
+#define UDI_MSC_BLOCK_SIZE   512
+
+//! Number of sectors read from the memory that can wait to be sent
+#define UDI_MSC_NB_READ_BUF  2
+
+/**
+ * \name Variables to manage SCSI requests
+ */
+//@{
+
+//! Structure to receive a CBW packet
+COMPILER_WORD_ALIGNED
+static struct usb_msc_cbw udi_msc_cbw;
+
+//! Structure to send a CSW packet
+COMPILER_WORD_ALIGNED
+static struct usb_msc_csw udi_msc_csw =
+		{.dCSWSignature = CPU_TO_BE32(USB_CSW_SIGNATURE) };
+
+//! Structure with current SCSI sense data
+COMPILER_WORD_ALIGNED
+static struct scsi_request_sense_data udi_msc_sense;
+
+//! Buffer for the small data phases (inquiry, capacities, mode sense)
+COMPILER_WORD_ALIGNED
+static uint8_t udi_msc_data[36];
+
+//! Number of the last LUN, sent to the host by GET_MAX_LUN
+static uint8_t udi_msc_nb_lun;
+
+//! Data bytes expected by the host and not transferred yet
+static uint32_t udi_msc_residue;
+
+//! Set by the USB interrupt when a valid CBW is waiting
+static volatile bool udi_msc_b_cbw_received = false;
+
+//! Set when a CBW was invalid, the endpoints stay halted until a reset
+static volatile bool udi_msc_b_cbw_invalid = false;
+
+//! Set when a transfer ended and its status is known
+static volatile bool udi_msc_b_ack_trans = true;
+
+//! Set when the current command was aborted (reset, disconnection)
+static volatile bool udi_msc_b_abort_trans = false;
+
+//! ctrl_access lock count after the last access of this interface
+static uint32_t udi_msc_nb_locks;
+
+//! Copies of the sectors read, sent while the memory reads the next ones
+COMPILER_WORD_ALIGNED
+static uint8_t udi_msc_read_buf[UDI_MSC_NB_READ_BUF][UDI_MSC_BLOCK_SIZE];
+
+//! Next buffer of \ref udi_msc_read_buf to fill
+static uint8_t udi_msc_read_next;
+
+//! Number of sectors of \ref udi_msc_read_buf queued on the IN endpoint
+static volatile uint8_t udi_msc_nb_read_pending;
+
+//@}
+
+
+/**
+ * \name Internal routines
+ */
+//@{
+
+/**
+ * \name Routines to process CBW packet
+ */
+//@{
+
+/**
+ * \brief Stops the reception of CBW packets because a wrong one was received.
+ *
+ * Both endpoints are halted and halted again when the host clears them,
+ * until a Mass Storage Reset.
+ */
+static void udi_msc_cbw_invalid(void);
+static void udi_msc_csw_invalid(void);
+
+/**
+ * \brief Starts the reception of a CBW packet.
+ */
+static void udi_msc_cbw_wait(void);
+
+/**
+ * \brief Callback called after CBW reception. Checks the packet, the
+ * command itself is executed by \ref udi_msc_process_trans.
+ */
+static void udi_msc_cbw_received(udd_ep_status_t status,
+		iram_size_t nb_received, udd_ep_id_t ep);
+//@}
+
+/**
+ * \name Routines to process the SCSI commands
+ */
+//@{
+static void udi_msc_sense_fail(uint8_t sense_key, uint16_t add_sense,
+		uint32_t lba);
+static void udi_msc_sense_pass(void);
+static bool udi_msc_data_check(bool b_read, uint32_t size);
+static void udi_msc_data_send(uint8_t * buffer, uint32_t size);
+static bool udi_msc_lock(void);
+static void udi_msc_unlock(void);
+static bool udi_msc_sense_status(Ctrl_status status, uint16_t fail_sense,
+		uint32_t lba);
+static void udi_msc_spc_inquiry(void);
+static void udi_msc_spc_test_unit_ready(void);
+static void udi_msc_spc_mode_sense(bool b_mode10);
+static void udi_msc_sbc_read_capacity(void);
+static void udi_msc_sbc_read_format_capacities(void);
+static void udi_msc_sbc_trans(bool b_read);
+//@}
+
+/**
+ * \name Routines to process CSW packet
+ */
+//@{
+
+/**
+ * \brief Ends the command: halts the data endpoint if the data phase was
+ * shorter than expected, then sends the CSW.
+ */
+static void udi_msc_csw_process(void);
+
+/**
+ * \brief Sends the CSW, waits for the data endpoint halt to be cleared.
+ */
+static void udi_msc_csw_send(void);
+
+/**
+ * \brief Callback called after CSW sent, waits for the next CBW.
+ */
+static void udi_msc_csw_sent(udd_ep_status_t status, iram_size_t nb_sent,
+		udd_ep_id_t ep);
+
+/**
+ * \brief Callback of \ref udi_msc_trans_block, when no callback is given.
+ */
+static void udi_msc_trans_ack(udd_ep_status_t status, iram_size_t n,
+		udd_ep_id_t ep);
+
+/**
+ * \brief Queues a copy of a sector read on the IN endpoint, waits only
+ * for a free copy buffer.
+ */
+static bool udi_msc_read_queue(uint8_t * block);
+
+/**
+ * \brief Callback called when a sector queued by \ref udi_msc_read_queue
+ * is sent.
+ */
+static void udi_msc_read_ack(udd_ep_status_t status, iram_size_t n,
+		udd_ep_id_t ep);
+
+/**
+ * \brief Waits until all the sectors queued by \ref udi_msc_read_queue
+ * are sent.
+ *
+ * \return \c false if the transfer was aborted.
+ */
+static bool udi_msc_read_flush(void);
+//@}
+
+//@}
+
+
+bool udi_msc_enable(void)
+{
+	udi_msc_b_cbw_received = false;
+	udi_msc_b_cbw_invalid = false;
+	udi_msc_b_abort_trans = false;
+	udi_msc_b_ack_trans = true;
+	udi_msc_nb_read_pending = 0;
+	udi_msc_nb_locks = ctrl_access_get_nb_locks();
+
+	udi_msc_nb_lun = get_nb_lun();
+	if (0 == udi_msc_nb_lun) {
+		return false; // No lun available, then not authorize to enable interface
+	}
+	udi_msc_nb_lun--;
+
+	// Call application callback
+	// to initialize memories or signal that interface is enabled
+	if (!UDI_MSC_ENABLE_EXT()) {
+		return false;
+	}
+
+	// Start MSC process by CBW reception
+	udi_msc_cbw_wait();
+	return true;
+}
+
+
+void udi_msc_disable(void)
+{
+	udi_msc_b_cbw_received = false;
+	udi_msc_b_abort_trans = true;
+	UDI_MSC_DISABLE_EXT();
+}
+
+
+bool udi_msc_setup(void)
+{
+	if (Udd_setup_is_in()) {
+		// Requests Interface GET
+		if (Udd_setup_type() == USB_REQ_TYPE_CLASS) {
+			// Requests Class Interface Get
+			switch (udd_g_ctrlreq.req.bRequest) {
+			case USB_REQ_MSC_GET_MAX_LUN:
+				// Give the number of memories available
+				if (1 != udd_g_ctrlreq.req.wLength)
+					return false; // Error for USB host
+				if (0 != udd_g_ctrlreq.req.wValue)
+					return false;
+				udd_g_ctrlreq.payload = &udi_msc_nb_lun;
+				udd_g_ctrlreq.payload_size = 1;
+				return true;
+			}
+		}
+	}
+	if (Udd_setup_is_out()) {
+		// Requests Interface SET
+		if (Udd_setup_type() == USB_REQ_TYPE_CLASS) {
+			// Requests Class Interface Set
+			switch (udd_g_ctrlreq.req.bRequest) {
+			case USB_REQ_MSC_BULK_RESET:
+				// Reset MSC interface
+				if (0 != udd_g_ctrlreq.req.wLength)
+					return false;
+				if (0 != udd_g_ctrlreq.req.wValue)
+					return false;
+				udi_msc_b_cbw_invalid = false;
+				udi_msc_b_cbw_received = false;
+				udi_msc_b_abort_trans = true;
+				// Abort all tasks (transfer or clear stall wait) on endpoints
+				udd_ep_abort(UDI_MSC_EP_OUT);
+				udd_ep_abort(UDI_MSC_EP_IN);
+				// Restart by CBW wait
+				udi_msc_cbw_wait();
+				return true;
+			}
+		}
+	}
+	return false;  // Not supported request
+}
+
+uint8_t udi_msc_getsetting(void)
+{
+	return 0;  // MSC don't have multiple alternate setting
+}
+
+
+// ------------------------
+//------- Routines to process CBW packet
+
+static void udi_msc_cbw_invalid(void)
+{
+	if (!udi_msc_b_cbw_invalid)
+		return;  // Don't re-stall endpoint if error reset by setup
+	udd_ep_set_halt(UDI_MSC_EP_OUT);
+	// If stall cleared then re-stall it. Only Setup MSC Reset can clear it
+	udd_ep_wait_stall_clear(UDI_MSC_EP_OUT, udi_msc_cbw_invalid);
+}
+
+static void udi_msc_csw_invalid(void)
+{
+	if (!udi_msc_b_cbw_invalid)
+		return;  // Don't re-stall endpoint if error reset by setup
+	udd_ep_set_halt(UDI_MSC_EP_IN);
+	// If stall cleared then re-stall it. Only Setup MSC Reset can clear it
+	udd_ep_wait_stall_clear(UDI_MSC_EP_IN, udi_msc_csw_invalid);
+}
+
+static void udi_msc_cbw_wait(void)
+{
+	// Register buffer and callback on OUT endpoint
+	if (!udd_ep_run(UDI_MSC_EP_OUT, true,
+					(uint8_t *) & udi_msc_cbw,
+					sizeof(udi_msc_cbw),
+					udi_msc_cbw_received)) {
+		// OUT endpoint not available (halted), then wait a clear of halt.
+		udd_ep_wait_stall_clear(UDI_MSC_EP_OUT, udi_msc_cbw_wait);
+	}
+}
+
+
+static void udi_msc_cbw_received(udd_ep_status_t status,
+		iram_size_t nb_received, udd_ep_id_t ep)
+{
+	UNUSED(ep);
+	// Check status of transfer
+	if (UDD_EP_TRANSFER_OK != status) {
+		return;  // Transfer aborted
+	}
+	// Check CBW integrity:
+	// transfer status/CBW length/CBW signature
+	if ((sizeof(udi_msc_cbw) != nb_received)
+			|| (udi_msc_cbw.dCBWSignature !=
+					CPU_TO_BE32(USB_CBW_SIGNATURE))) {
+		// (5.2.1) Devices receiving a CBW with an invalid signature should stall
+		// further traffic on the Bulk In pipe, and either stall further traffic
+		// or accept and discard further traffic on the Bulk Out pipe, until
+		// reset recovery.
+		udi_msc_b_cbw_invalid = true;
+		udi_msc_cbw_invalid();
+		udi_msc_csw_invalid();
+		return;
+	}
+
+	// The command is executed from the main loop
+	udi_msc_b_cbw_received = true;
+	UDI_MSC_NOTIFY_TRANS_EXT();
+}
+
+
+bool udi_msc_process_trans(void)
+{
+	if (!udi_msc_b_cbw_received) {
+		return false;
+	}
+	udi_msc_b_cbw_received = false;
+	udi_msc_b_abort_trans = false;
+
+	// Prepare CSW residue field with the size requested
+	udi_msc_residue = le32_to_cpu(udi_msc_cbw.dCBWDataTransferLength);
+	udi_msc_csw.dCSWTag = udi_msc_cbw.dCBWTag;
+	udi_msc_cbw.bCBWLUN &= USB_CBW_LUN_MASK;
+
+	// Check LUN asked
+	if (udi_msc_cbw.bCBWLUN > udi_msc_nb_lun) {
+		// Bad LUN, then stop command process
+		udi_msc_sense_fail(SCSI_SK_ILLEGAL_REQUEST,
+				SCSI_ASC_LOGICAL_UNIT_NOT_SUPPORTED, 0);
+		udi_msc_csw_process();
+		return true;
+	}
+
+	// Decode opcode
+	switch (udi_msc_cbw.CDB[0]) {
+	case SPC_REQUEST_SENSE:
+		// The sense data is sent as is, the next command starts clean
+		memcpy(udi_msc_data, &udi_msc_sense, sizeof(udi_msc_sense));
+		udi_msc_sense_pass();
+		udi_msc_data_send(udi_msc_data, min(sizeof(udi_msc_sense),
+				udi_msc_cbw.CDB[4]));
+		break;
+
+	case SPC_INQUIRY:
+		udi_msc_spc_inquiry();
+		break;
+
+	case SPC_MODE_SENSE6:
+		udi_msc_spc_mode_sense(false);
+		break;
+	case SPC_MODE_SENSE10:
+		udi_msc_spc_mode_sense(true);
+		break;
+
+	case SPC_TEST_UNIT_READY:
+		udi_msc_spc_test_unit_ready();
+		break;
+
+	case SBC_READ_CAPACITY10:
+		udi_msc_sbc_read_capacity();
+		break;
+
+	case SBC_READ_FORMAT_CAPACITIES:
+		udi_msc_sbc_read_format_capacities();
+		break;
+
+	case SBC_START_STOP_UNIT:
+	case SPC_PREVENT_ALLOW_MEDIUM_REMOVAL:
+		// The medium is given back to the device by the ctrl_access lock,
+		// the host has nothing to lock or eject
+		udi_msc_sense_pass();
+		break;
+
+	case SBC_READ10:
+		udi_msc_sbc_trans(true);
+		break;
+
+	case SBC_WRITE10:
+		udi_msc_sbc_trans(false);
+		break;
+
+	default:
+		udi_msc_sense_fail(SCSI_SK_ILLEGAL_REQUEST,
+				SCSI_ASC_INVALID_COMMAND_OPERATION_CODE, 0);
+		break;
+	}
+
+	if (udi_msc_b_abort_trans) {
+		// Reset or disconnection during the command, no CSW
+		return true;
+	}
+	udi_msc_csw_process();
+	return true;
+}
+
+
+bool udi_msc_trans_block(bool b_read, uint8_t * block, iram_size_t block_size,
+		void (*callback) (udd_ep_status_t status, iram_size_t n, udd_ep_id_t ep))
+{
+	if (udi_msc_b_abort_trans) {
+		return false;
+	}
+	if (b_read && (NULL == callback)
+			&& (UDI_MSC_BLOCK_SIZE == block_size)) {
+		// The memory may reuse its buffer at once, send a copy
+		return udi_msc_read_queue(block);
+	}
+	udi_msc_b_ack_trans = false;
+	if (!udd_ep_run((b_read) ? UDI_MSC_EP_IN : UDI_MSC_EP_OUT,
+					false,
+					block,
+					block_size,
+					(NULL == callback) ? udi_msc_trans_ack : callback)) {
+		udi_msc_b_ack_trans = true;
+		return false;
+	}
+	if (NULL == callback) {
+		// Wait end of transfer, the USB interrupt sets the flag
+		while (!udi_msc_b_ack_trans);
+		if (udi_msc_b_abort_trans) {
+			return false;
+		}
+		udi_msc_residue -= block_size;
+	}
+	return true;
+}
+
+
+static void udi_msc_trans_ack(udd_ep_status_t status, iram_size_t n,
+		udd_ep_id_t ep)
+{
+	UNUSED(ep);
+	UNUSED(n);
+	// Update variable to signal the end of transfer
+	if (UDD_EP_TRANSFER_OK != status) {
+		udi_msc_b_abort_trans = true;
+	}
+	udi_msc_b_ack_trans = true;
+}
+
+
+static bool udi_msc_read_queue(uint8_t * block)
+{
+	uint8_t *buf;
+	irqflags_t flags;
+
+	// Wait for a copy buffer, the endpoint sends the others meanwhile
+	while ((UDI_MSC_NB_READ_BUF <= udi_msc_nb_read_pending)
+			&& !udi_msc_b_abort_trans);
+	if (udi_msc_b_abort_trans) {
+		return false;
+	}
+	buf = udi_msc_read_buf[udi_msc_read_next];
+	memcpy(buf, block, UDI_MSC_BLOCK_SIZE);
+	// The count is decremented by the USB interrupt
+	flags = cpu_irq_save();
+	udi_msc_nb_read_pending++;
+	cpu_irq_restore(flags);
+	if (!udd_ep_run(UDI_MSC_EP_IN, false, buf, UDI_MSC_BLOCK_SIZE,
+			udi_msc_read_ack)) {
+		flags = cpu_irq_save();
+		udi_msc_nb_read_pending--;
+		cpu_irq_restore(flags);
+		return false;
+	}
+	udi_msc_read_next = (udi_msc_read_next + 1) % UDI_MSC_NB_READ_BUF;
+	udi_msc_residue -= UDI_MSC_BLOCK_SIZE;
+	return true;
+}
+
+
+static void udi_msc_read_ack(udd_ep_status_t status, iram_size_t n,
+		udd_ep_id_t ep)
+{
+	UNUSED(ep);
+	UNUSED(n);
+	if (UDD_EP_TRANSFER_OK != status) {
+		udi_msc_b_abort_trans = true;
+	}
+	udi_msc_nb_read_pending--;
+}
+
+
+static bool udi_msc_read_flush(void)
+{
+	while (udi_msc_nb_read_pending && !udi_msc_b_abort_trans);
+	return !udi_msc_b_abort_trans;
+}
+
+
+// ------------------------
+//------- Routines to process the SCSI commands
+
+static void udi_msc_sense_fail(uint8_t sense_key, uint16_t add_sense,
+		uint32_t lba)
+{
+	memset(&udi_msc_sense, 0, sizeof(udi_msc_sense));
+	udi_msc_sense.valid_reponse_code = SCSI_SENSE_VALID | SCSI_SENSE_CURRENT;
+	udi_msc_sense.sense_flag_key = sense_key;
+	udi_msc_sense.information[0] = lba >> 24;
+	udi_msc_sense.information[1] = lba >> 16;
+	udi_msc_sense.information[2] = lba >> 8;
+	udi_msc_sense.information[3] = lba;
+	udi_msc_sense.AddSenseLen =
+			SCSI_SENSE_ADDL_LEN(sizeof(udi_msc_sense));
+	udi_msc_sense.AddSenseCode = add_sense >> 8;
+	udi_msc_sense.AddSnsCodeQlfr = add_sense;
+	udi_msc_csw.bCSWStatus = USB_CSW_STATUS_FAIL;
+}
+
+static void udi_msc_sense_pass(void)
+{
+	udi_msc_sense_fail(SCSI_SK_NO_SENSE,
+			SCSI_ASC_NO_ADDITIONAL_SENSE_INFO, 0);
+	udi_msc_csw.bCSWStatus = USB_CSW_STATUS_PASS;
+}
+
+
+/**
+ * \brief Checks the data phase the host asked for against the command.
+ *
+ * \param b_read  Data from device to host, if true
+ * \param size    Size of the data phase given by the command
+ *
+ * \return \c true if both agree, else the command fails with a phase error.
+ */
+static bool udi_msc_data_check(bool b_read, uint32_t size)
+{
+	bool b_dir_in = (udi_msc_cbw.bmCBWFlags & USB_CBW_DIRECTION_IN);
+
+	if ((udi_msc_residue < size)
+			|| (size && (b_dir_in != b_read))) {
+		udi_msc_sense_fail(SCSI_SK_ILLEGAL_REQUEST,
+				SCSI_ASC_INVALID_FIELD_IN_CDB, 0);
+		udi_msc_csw.bCSWStatus = USB_CSW_STATUS_PE;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Sends a small data phase, up to the length asked by the host.
+ */
+static void udi_msc_data_send(uint8_t * buffer, uint32_t size)
+{
+	if (!(udi_msc_cbw.bmCBWFlags & USB_CBW_DIRECTION_IN)) {
+		udi_msc_data_check(true, size);
+		return;
+	}
+	size = min(size, udi_msc_residue);
+	if (size) {
+		udi_msc_trans_block(true, buffer, size, NULL);
+	}
+}
+
+
+/**
+ * \brief Takes the ctrl_access lock for a command accessing the memory.
+ *
+ * Fails the command while the memory is used by another user, and once
+ * after such a use to report that the medium may have changed.
+ *
+ * \return \c true if the lock is held.
+ */
+static bool udi_msc_lock(void)
+{
+	uint32_t nb_locks = ctrl_access_get_nb_locks();
+
+	if (!ctrl_access_lock()) {
+		udi_msc_sense_fail(SCSI_SK_NOT_READY,
+				SCSI_ASC_MEDIUM_NOT_PRESENT, 0);
+		return false;
+	}
+	if (nb_locks != udi_msc_nb_locks) {
+		// Somebody else used the memory since the last command
+		udi_msc_nb_locks = nb_locks + 1;
+		ctrl_access_unlock();
+		udi_msc_sense_fail(SCSI_SK_UNIT_ATTENTION,
+				SCSI_ASC_NOT_READY_TO_READY_CHANGE, 0);
+		return false;
+	}
+	return true;
+}
+
+static void udi_msc_unlock(void)
+{
+	udi_msc_nb_locks = ctrl_access_get_nb_locks();
+	ctrl_access_unlock();
+}
+
+
+/**
+ * \brief Sets the sense data from a memory status.
+ *
+ * \return \c true if the status is good.
+ */
+static bool udi_msc_sense_status(Ctrl_status status, uint16_t fail_sense,
+		uint32_t lba)
+{
+	switch (status) {
+	case CTRL_GOOD:
+		udi_msc_sense_pass();
+		return true;
+	case CTRL_BUSY:
+		udi_msc_sense_fail(SCSI_SK_UNIT_ATTENTION,
+				SCSI_ASC_NOT_READY_TO_READY_CHANGE, 0);
+		return false;
+	case CTRL_NO_PRESENT:
+		udi_msc_sense_fail(SCSI_SK_NOT_READY,
+				SCSI_ASC_MEDIUM_NOT_PRESENT, 0);
+		return false;
+	case CTRL_FAIL:
+	default:
+		udi_msc_sense_fail(SCSI_SK_MEDIUM_ERROR, fail_sense, lba);
+		return false;
+	}
+}
+
+
+static void udi_msc_spc_inquiry(void)
+{
+	struct scsi_inquiry_data *inquiry =
+			(struct scsi_inquiry_data *)udi_msc_data;
+	const char *name;
+	uint8_t i;
+
+	// CMDT and EPVD bits are not at 0
+	if ((udi_msc_cbw.CDB[1] & 0x03) || (udi_msc_cbw.CDB[2])) {
+		udi_msc_sense_fail(SCSI_SK_ILLEGAL_REQUEST,
+				SCSI_ASC_INVALID_FIELD_IN_CDB, 0);
+		return;
+	}
+
+	memset(inquiry, 0, sizeof(struct scsi_inquiry_data));
+	inquiry->pq_pdt = SCSI_INQ_PQ_CONNECTED | SCSI_INQ_DT_DIR_ACCESS;
+	inquiry->flags1 = SCSI_INQ_RMB;
+	inquiry->version = SCSI_INQ_VER_SPC2;
+	inquiry->flags3 = SCSI_INQ_RSP_SPC2;
+	inquiry->addl_len = SCSI_INQ_ADDL_LEN(sizeof(struct scsi_inquiry_data));
+	memcpy(inquiry->vendor_id, UDI_MSC_GLOBAL_VENDOR_ID,
+			sizeof(inquiry->vendor_id));
+	memcpy(inquiry->product_rev, UDI_MSC_GLOBAL_PRODUCT_VERSION,
+			sizeof(inquiry->product_rev));
+
+	// Product name is the LUN name without its quotes, padded with spaces
+	memset(inquiry->product_id, ' ', sizeof(inquiry->product_id));
+	name = mem_name(udi_msc_cbw.bCBWLUN);
+	if (name && (*name == '"')) {
+		name++;
+	}
+	for (i = 0; name && name[i] && (name[i] != '"')
+			&& (i < sizeof(inquiry->product_id)); i++) {
+		inquiry->product_id[i] = name[i];
+	}
+
+	udi_msc_sense_pass();
+	udi_msc_data_send(udi_msc_data, min(sizeof(struct scsi_inquiry_data),
+			udi_msc_cbw.CDB[4]));
+}
+
+
+static void udi_msc_spc_test_unit_ready(void)
+{
+	Ctrl_status status;
+
+	if (!udi_msc_lock()) {
+		return;
+	}
+	status = mem_test_unit_ready(udi_msc_cbw.bCBWLUN);
+	udi_msc_unlock();
+	udi_msc_sense_status(status, SCSI_ASC_LOGICAL_UNIT_NOT_READY, 0);
+}
+
+
+static void udi_msc_spc_mode_sense(bool b_mode10)
+{
+	uint8_t wp;
+	uint8_t length;
+
+	if (!udi_msc_lock()) {
+		return;
+	}
+	wp = mem_wr_protect(udi_msc_cbw.bCBWLUN) ? SCSI_MS_SBC_WP : 0;
+	udi_msc_unlock();
+
+	// Only the header, no block descriptor and no mode page
+	memset(udi_msc_data, 0, sizeof(udi_msc_data));
+	if (b_mode10) {
+		struct scsi_mode_param_header10 *header =
+				(struct scsi_mode_param_header10 *)udi_msc_data;
+		header->mode_data_length = cpu_to_be16(sizeof(*header) - 2);
+		header->device_specific_parameter = wp;
+		length = min(sizeof(*header), ((uint16_t)udi_msc_cbw.CDB[7] << 8)
+				| udi_msc_cbw.CDB[8]);
+	} else {
+		struct scsi_mode_param_header6 *header =
+				(struct scsi_mode_param_header6 *)udi_msc_data;
+		header->mode_data_length = sizeof(*header) - 1;
+		header->device_specific_parameter = wp;
+		length = min(sizeof(*header), udi_msc_cbw.CDB[4]);
+	}
+
+	udi_msc_sense_pass();
+	udi_msc_data_send(udi_msc_data, length);
+}
+
+
+static void udi_msc_sbc_read_capacity(void)
+{
+	struct sbc_read_capacity10_data *capacity =
+			(struct sbc_read_capacity10_data *)udi_msc_data;
+	uint32_t last_lba;
+	Ctrl_status status;
+
+	if (!udi_msc_lock()) {
+		return;
+	}
+	status = mem_read_capacity(udi_msc_cbw.bCBWLUN, &last_lba);
+	udi_msc_unlock();
+	if (!udi_msc_sense_status(status, SCSI_ASC_LOGICAL_UNIT_NOT_READY, 0)) {
+		return;
+	}
+
+	capacity->max_lba = cpu_to_be32(last_lba);
+	capacity->block_len = cpu_to_be32(UDI_MSC_BLOCK_SIZE);
+	udi_msc_data_send(udi_msc_data, sizeof(*capacity));
+}
+
+
+static void udi_msc_sbc_read_format_capacities(void)
+{
+	struct sbc_read_format_capacities_data *format =
+			(struct sbc_read_format_capacities_data *)udi_msc_data;
+	uint32_t last_lba;
+	Ctrl_status status = CTRL_NO_PRESENT;
+	uint16_t length = ((uint16_t)udi_msc_cbw.CDB[7] << 8)
+			| udi_msc_cbw.CDB[8];
+
+	if (udi_msc_lock()) {
+		status = mem_read_capacity(udi_msc_cbw.bCBWLUN, &last_lba);
+		udi_msc_unlock();
+	}
+
+	// The list is sent even without medium, as "no media present"
+	memset(format, 0, sizeof(*format));
+	format->list_len = 8;
+	if (CTRL_GOOD == status) {
+		format->nb_blocks = cpu_to_be32(last_lba + 1);
+		format->descriptor_type = SBC_FORMAT_FORMATTED;
+	} else {
+		format->nb_blocks = 0xFFFFFFFF;
+		format->descriptor_type = SBC_FORMAT_NO_MEDIA;
+	}
+	format->block_len[1] = UDI_MSC_BLOCK_SIZE >> 8;
+	format->block_len[2] = UDI_MSC_BLOCK_SIZE & 0xFF;
+
+	udi_msc_sense_pass();
+	udi_msc_data_send(udi_msc_data, min(sizeof(*format), length));
+}
+
+
+static void udi_msc_sbc_trans(bool b_read)
+{
+	uint32_t lba;
+	uint16_t nb_block;
+	Ctrl_status status;
+
+	// Read/Write command fields (address and number of block)
+	lba = ((uint32_t)udi_msc_cbw.CDB[2] << 24)
+			| ((uint32_t)udi_msc_cbw.CDB[3] << 16)
+			| ((uint32_t)udi_msc_cbw.CDB[4] << 8)
+			| udi_msc_cbw.CDB[5];
+	nb_block = ((uint16_t)udi_msc_cbw.CDB[7] << 8) | udi_msc_cbw.CDB[8];
+
+	// Compute number of byte to transfer and valid it
+	if (!udi_msc_data_check(b_read, (uint32_t)nb_block * UDI_MSC_BLOCK_SIZE)) {
+		return;
+	}
+	if (!nb_block) {
+		udi_msc_sense_pass();
+		return;
+	}
+
+	if (!udi_msc_lock()) {
+		return;
+	}
+	if (!b_read && mem_wr_protect(udi_msc_cbw.bCBWLUN)) {
+		udi_msc_unlock();
+		udi_msc_sense_fail(SCSI_SK_DATA_PROTECT,
+				SCSI_ASC_WRITE_PROTECTED, 0);
+		return;
+	}
+
+	// The memory moves each sector with udi_msc_trans_block()
+	if (b_read) {
+		status = memory_2_usb(udi_msc_cbw.bCBWLUN, lba, nb_block);
+		// The last sectors are still on the way to the host
+		udi_msc_read_flush();
+	} else {
+		status = usb_2_memory(udi_msc_cbw.bCBWLUN, lba, nb_block);
+	}
+	udi_msc_unlock();
+
+	udi_msc_sense_status(status, b_read ? SCSI_ASC_UNRECOVERED_READ_ERROR
+			: SCSI_ASC_WRITE_ERROR, lba);
+}
+
+
+// ------------------------
+//------- Routines to process CSW packet
+
+static void udi_msc_csw_process(void)
+{
+	if (0 != udi_msc_residue) {
+		// Residue not NULL
+		// then STALL next request from USB host on corresponding endpoint
+		if (udi_msc_cbw.bmCBWFlags & USB_CBW_DIRECTION_IN)
+			udd_ep_set_halt(UDI_MSC_EP_IN);
+		else
+			udd_ep_set_halt(UDI_MSC_EP_OUT);
+	}
+	// Prepare and send CSW
+	udi_msc_csw.dCSWDataResidue = cpu_to_le32(udi_msc_residue);
+	udi_msc_csw_send();
+}
+
+
+static void udi_msc_csw_send(void)
+{
+	// Sends CSW on IN endpoint
+	if (!udd_ep_run(UDI_MSC_EP_IN, false,
+					(uint8_t *) & udi_msc_csw,
+					sizeof(udi_msc_csw),
+					udi_msc_csw_sent)) {
+		// Endpoint not available
+		// then restart CSW sent when endpoint IN STALL will be cleared
+		udd_ep_wait_stall_clear(UDI_MSC_EP_IN, udi_msc_csw_send);
+	}
+}
+
+
+static void udi_msc_csw_sent(udd_ep_status_t status, iram_size_t nb_sent,
+		udd_ep_id_t ep)
+{
+	UNUSED(ep);
+	UNUSED(status);
+	UNUSED(nb_sent);
+	// CSW is sent or not
+	// In all case, restart process and wait CBW
+	udi_msc_cbw_wait();
+}
+
+//@}
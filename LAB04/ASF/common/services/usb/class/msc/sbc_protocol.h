@@ -0,0 +1,67 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief SCSI Block Commands (SBC) definitions.
+ *
+ * The subset of the SCSI block commands used by a USB Mass Storage device.
+ *
+ ******************************************************************************/
+
+
+#ifndef _SBC_PROTOCOL_H_
+#define _SBC_PROTOCOL_H_
+
+#include "compiler.h"
+
+/**
+ * \ingroup usb_msc_protocol
+ * \defgroup usb_msc_protocol_sbc SCSI Block Commands protocol definitions
+ *
+ * @{
+ */
+
+//! \name SCSI commands defined by SBC-2
+//@{
+#define  SBC_FORMAT_UNIT                 0x04
+#define  SBC_READ6                       0x08
+#define  SBC_WRITE6                      0x0A
+#define  SBC_START_STOP_UNIT             0x1B
+#define  SBC_READ_FORMAT_CAPACITIES      0x23
+#define  SBC_READ_CAPACITY10             0x25
+#define  SBC_READ10                      0x28
+#define  SBC_WRITE10                     0x2A
+#define  SBC_VERIFY10                    0x2F
+//@}
+
+//! \name Fields of the START STOP UNIT command (CDB byte 4)
+//@{
+#define  SBC_START_STOP_START            0x01   //!< Load/start the medium
+#define  SBC_START_STOP_LOEJ             0x02   //!< Load or eject the medium
+//@}
+
+COMPILER_PACK_SET(1)
+
+//! \brief SBC-2 Read Capacity (10) parameter data
+struct sbc_read_capacity10_data {
+	be32_t max_lba;         //!< LBA of last logical block
+	be32_t block_len;       //!< Number of bytes in the last logical block
+};
+
+//! \brief UFI Read Format Capacities data: header and one descriptor
+struct sbc_read_format_capacities_data {
+	uint8_t reserved[3];
+	uint8_t list_len;       //!< Capacity list length (8)
+	be32_t nb_blocks;       //!< Number of blocks
+	uint8_t descriptor_type; //!< See SBC_FORMAT_*
+	uint8_t block_len[3];   //!< Block length, big endian
+};
+
+#define  SBC_FORMAT_FORMATTED            0x02   //!< Formatted media
+#define  SBC_FORMAT_NO_MEDIA             0x03   //!< No media present
+
+COMPILER_PACK_RESET()
+
+//@}
+
+#endif // _SBC_PROTOCOL_H_
@@ -0,0 +1,137 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief SCSI Primary Commands (SPC) definitions.
+ *
+ * The subset of the SCSI primary commands, sense codes and data formats used
+ * by a USB Mass Storage device.
+ *
+ ******************************************************************************/
+
+
+#ifndef _SPC_PROTOCOL_H_
+#define _SPC_PROTOCOL_H_
+
+#include "compiler.h"
+
+/**
+ * \ingroup usb_msc_protocol
+ * \defgroup usb_msc_protocol_spc SCSI Primary Commands protocol definitions
+ *
+ * @{
+ */
+
+//! \name SCSI commands defined by SPC-2
+//@{
+#define  SPC_TEST_UNIT_READY             0x00
+#define  SPC_REQUEST_SENSE               0x03
+#define  SPC_INQUIRY                     0x12
+#define  SPC_MODE_SELECT6                0x15
+#define  SPC_MODE_SENSE6                 0x1A
+#define  SPC_SEND_DIAGNOSTIC             0x1D
+#define  SPC_PREVENT_ALLOW_MEDIUM_REMOVAL 0x1E
+#define  SPC_MODE_SELECT10               0x55
+#define  SPC_MODE_SENSE10                0x5A
+//@}
+
+//! \name SCSI peripheral device types
+//@{
+#define  SCSI_INQ_PQ_CONNECTED           0x00   //!< Peripheral connected
+#define  SCSI_INQ_DT_DIR_ACCESS          0x00   //!< Direct access device
+#define  SCSI_INQ_RMB                    0x80   //!< Removable medium
+#define  SCSI_INQ_VER_SPC2               0x04   //!< Conforms to SPC-2
+#define  SCSI_INQ_RSP_SPC2               0x02   //!< Response data format
+//@}
+
+COMPILER_PACK_SET(1)
+
+//! \brief SCSI Standard Inquiry data structure
+struct scsi_inquiry_data {
+	uint8_t pq_pdt;         //!< Peripheral Qualifier / Device Type
+	uint8_t flags1;         //!< Removable medium bit
+	uint8_t version;        //!< Version
+	uint8_t flags3;         //!< Response data format
+	uint8_t addl_len;       //!< Additional length (n-4)
+	uint8_t flags5;
+	uint8_t flags6;
+	uint8_t flags7;
+	uint8_t vendor_id[8];   //!< T10 vendor identification
+	uint8_t product_id[16]; //!< Vendor-defined product ID
+	uint8_t product_rev[4]; //!< Vendor-defined product revision
+};
+
+#define  SCSI_INQ_ADDL_LEN(tot)   ((tot) - 5) //!< Total length is \a tot
+
+//! \brief Fixed format sense data
+struct scsi_request_sense_data {
+	uint8_t valid_reponse_code;  //!< Valid bit and response code (0x70)
+	uint8_t obsolete;
+	uint8_t sense_flag_key;      //!< Sense key in bits 0-3
+	uint8_t information[4];
+	uint8_t AddSenseLen;         //!< Additional sense length (n-7)
+	uint8_t CmdSpecINFO[4];
+	uint8_t AddSenseCode;        //!< Additional sense code
+	uint8_t AddSnsCodeQlfr;      //!< Additional sense code qualifier
+	uint8_t FldReplUnitCode;
+	uint8_t SenseKeySpec[3];
+};
+
+#define  SCSI_SENSE_VALID                0x80   //!< Information field valid
+#define  SCSI_SENSE_CURRENT              0x70   //!< Current errors
+#define  SCSI_SENSE_ADDL_LEN(total_len)  ((total_len) - 8)
+
+//! \brief Mode parameter header, 6 bytes CDB
+struct scsi_mode_param_header6 {
+	uint8_t mode_data_length;    //!< Number of bytes after this one
+	uint8_t medium_type;
+	uint8_t device_specific_parameter; //!< Write protect in bit 7
+	uint8_t block_descriptor_length;
+};
+
+//! \brief Mode parameter header, 10 bytes CDB
+struct scsi_mode_param_header10 {
+	be16_t mode_data_length;     //!< Number of bytes after this one
+	uint8_t medium_type;
+	uint8_t device_specific_parameter; //!< Write protect in bit 7
+	uint8_t reserved[2];
+	be16_t block_descriptor_length;
+};
+
+#define  SCSI_MS_MODE_ALL                0x3F   //!< Mode sense: all pages
+#define  SCSI_MS_SBC_WP                  0x80   //!< Write protected medium
+
+COMPILER_PACK_RESET()
+
+//! \name Sense keys
+//@{
+#define  SCSI_SK_NO_SENSE                0x0
+#define  SCSI_SK_RECOVERED_ERROR         0x1
+#define  SCSI_SK_NOT_READY               0x2
+#define  SCSI_SK_MEDIUM_ERROR            0x3
+#define  SCSI_SK_HARDWARE_ERROR          0x4
+#define  SCSI_SK_ILLEGAL_REQUEST         0x5
+#define  SCSI_SK_UNIT_ATTENTION          0x6
+#define  SCSI_SK_DATA_PROTECT            0x7
+#define  SCSI_SK_ABORTED_COMMAND         0xB
+//@}
+
+//! \name Additional sense codes and qualifiers (ASC << 8 | ASCQ)
+//@{
+#define  SCSI_ASC_NO_ADDITIONAL_SENSE_INFO         0x0000
+#define  SCSI_ASC_LOGICAL_UNIT_NOT_READY           0x0400
+#define  SCSI_ASC_WRITE_ERROR                      0x0C00
+#define  SCSI_ASC_UNRECOVERED_READ_ERROR           0x1100
+#define  SCSI_ASC_INVALID_COMMAND_OPERATION_CODE   0x2000
+#define  SCSI_ASC_LBA_OUT_OF_RANGE                 0x2100
+#define  SCSI_ASC_INVALID_FIELD_IN_CDB             0x2400
+#define  SCSI_ASC_LOGICAL_UNIT_NOT_SUPPORTED       0x2500
+#define  SCSI_ASC_WRITE_PROTECTED                  0x2700
+#define  SCSI_ASC_NOT_READY_TO_READY_CHANGE        0x2800
+#define  SCSI_ASC_MEDIUM_NOT_PRESENT               0x3A00
+#define  SCSI_ASC_INTERNAL_TARGET_FAILURE          0x4400
+//@}
+
+//@}
+
+#endif // _SPC_PROTOCOL_H_
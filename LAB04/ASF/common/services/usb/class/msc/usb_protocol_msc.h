@@ -0,0 +1,100 @@
+/*****************************************************************************
+ *
+ * \file
+ *
+ * \brief USB Mass Storage Class protocol definitions.
+ *
+ * Class codes, class requests and the Bulk-Only Transport wrappers (CBW and
+ * CSW) of the USB Mass Storage Class specification.
+ *
+ ******************************************************************************/
+
+
+#ifndef _USB_PROTOCOL_MSC_H_
+#define _USB_PROTOCOL_MSC_H_
+
+#include "compiler.h"
+
+/**
+ * \ingroup usb_protocol_group
+ * \defgroup usb_msc_protocol USB Mass Storage Class definitions
+ *
+ * @{
+ */
+
+//! \name Possible Class value
+//@{
+#define  MSC_CLASS                  0x08
+//@}
+
+//! \name Possible SubClass value
+//@{
+#define  MSC_SUBCLASS_RBC           0x01   //!< Reduced Block Commands
+#define  MSC_SUBCLASS_SFF_8020I     0x02   //!< ATAPI, e.g. CD/DVD
+#define  MSC_SUBCLASS_QIC_157       0x03   //!< QIC-157 tapes
+#define  MSC_SUBCLASS_UFI           0x04   //!< Floppy disk
+#define  MSC_SUBCLASS_SFF_8070I     0x05   //!< LS-120 floppy
+#define  MSC_SUBCLASS_TRANSPARENT   0x06   //!< SCSI transparent command set
+//@}
+
+//! \name Possible protocol value
+//@{
+#define  MSC_PROTOCOL_CBI           0x00   //!< Command/Bulk/Interrupt with command completion
+#define  MSC_PROTOCOL_CBI_ALT       0x01   //!< Command/Bulk/Interrupt without command completion
+#define  MSC_PROTOCOL_BULK          0x50   //!< Bulk-Only Transport
+//@}
+
+
+//! \name MSC Bulk-Only Transport class requests
+//@{
+#define  USB_REQ_MSC_BULK_RESET     0xFF   //!< Mass Storage Reset
+#define  USB_REQ_MSC_GET_MAX_LUN    0xFE   //!< Get Max LUN
+//@}
+
+
+COMPILER_PACK_SET(1)
+
+/**
+ * \name A Command Block Wrapper (CBW).
+ */
+//@{
+struct usb_msc_cbw {
+	le32_t dCBWSignature;          //!< Must contain 'USBC'
+	le32_t dCBWTag;                //!< Unique command ID
+	le32_t dCBWDataTransferLength; //!< Number of bytes to transfer
+	uint8_t bmCBWFlags;            //!< Direction in bit 7
+	uint8_t bCBWLUN;               //!< Logical Unit Number
+	uint8_t bCBWCBLength;          //!< Number of valid CDB bytes
+	uint8_t CDB[16];               //!< SCSI Command Descriptor Block
+};
+
+#define  USB_CBW_SIGNATURE          0x55534243   //!< dCBWSignature value
+#define  USB_CBW_DIRECTION_IN       (1<<7)       //!< Data from device to host
+#define  USB_CBW_DIRECTION_OUT      (0<<7)       //!< Data from host to device
+#define  USB_CBW_LUN_MASK           0x0F         //!< Valid bits in bCBWLUN
+#define  USB_CBW_LEN_MASK           0x1F         //!< Valid bits in bCBWCBLength
+//@}
+
+
+/**
+ * \name A Command Status Wrapper (CSW).
+ */
+//@{
+struct usb_msc_csw {
+	le32_t dCSWSignature;          //!< Must contain 'USBS'
+	le32_t dCSWTag;                //!< Same as dCBWTag
+	le32_t dCSWDataResidue;        //!< Number of bytes not transferred
+	uint8_t bCSWStatus;            //!< Status code
+};
+
+#define  USB_CSW_SIGNATURE          0x55534253   //!< dCSWSignature value
+#define  USB_CSW_STATUS_PASS        0x00         //!< Command Passed
+#define  USB_CSW_STATUS_FAIL        0x01         //!< Command Failed
+#define  USB_CSW_STATUS_PE          0x02         //!< Phase Error
+//@}
+
+COMPILER_PACK_RESET()
+
+//@}
+
+#endif // _USB_PROTOCOL_MSC_H_
@@ -52,6 +52,59 @@
 
 static bool stdio_usb_interface_enable = false;
 
+#ifdef STDIO_USB_TX_BUFFER_SIZE
+//! Output ring, the indexes run freely and are masked on access
+static char stdio_usb_tx_buf[STDIO_USB_TX_BUFFER_SIZE];
+static volatile uint16_t stdio_usb_tx_head;
+static volatile uint16_t stdio_usb_tx_tail;
+
+//! Characters dropped because the ring was full
+static volatile uint32_t stdio_usb_tx_dropped;
+
+void stdio_usb_flush(void)
+{
+	irqflags_t flags;
+	iram_size_t free;
+	uint16_t count;
+	uint16_t pos;
+
+	if (stdio_usb_tx_head == stdio_usb_tx_tail) {
+		return;
+	}
+
+	// The main loop and the SOF interrupt both drain the ring
+	flags = cpu_irq_save();
+
+	free = udi_cdc_get_free_tx_buffer();
+	count = stdio_usb_tx_head - stdio_usb_tx_tail;
+	while (count && free) {
+		// Contiguous part, no more than the CDC buffer takes now
+		pos = stdio_usb_tx_tail & (STDIO_USB_TX_BUFFER_SIZE - 1);
+		iram_size_t chunk = min(count, STDIO_USB_TX_BUFFER_SIZE - pos);
+		chunk = min(chunk, free);
+
+		udi_cdc_write_buf(&stdio_usb_tx_buf[pos], chunk);
+		stdio_usb_tx_tail += chunk;
+		count -= chunk;
+		free = udi_cdc_get_free_tx_buffer();
+	}
+
+	cpu_irq_restore(flags);
+}
+
+void stdio_usb_sof_action(void)
+{
+	if (stdio_usb_interface_enable) {
+		stdio_usb_flush();
+	}
+}
+
+uint32_t stdio_usb_get_dropped(void)
+{
+	return stdio_usb_tx_dropped;
+}
+#endif
+
 int stdio_usb_putchar (volatile void * unused, char data)
 {
 	/* A negative return value should be used to indicate that data
@@ -61,7 +114,30 @@ int stdio_usb_putchar (volatile void * unused, char data)
 		return 0;  // -1
 	}
 
+#ifdef STDIO_USB_TX_BUFFER_SIZE
+	uint16_t count = stdio_usb_tx_head - stdio_usb_tx_tail;
+
+	if (count >= STDIO_USB_TX_BUFFER_SIZE) {
+		// Make room if the host reads, otherwise drop
+		stdio_usb_flush();
+		count = stdio_usb_tx_head - stdio_usb_tx_tail;
+		if (count >= STDIO_USB_TX_BUFFER_SIZE) {
+			stdio_usb_tx_dropped++;
+			return -1;
+		}
+	}
+
+	stdio_usb_tx_buf[stdio_usb_tx_head & (STDIO_USB_TX_BUFFER_SIZE - 1)] = data;
+	barrier();
+	stdio_usb_tx_head++;
+
+	if ((data == '\n') || (count + 1 >= STDIO_USB_TX_THRESHOLD)) {
+		stdio_usb_flush();
+	}
+	return 0;
+#else
 	return udi_cdc_putc(data) ? 0 : -1;
+#endif
 }
 
 void stdio_usb_getchar (void volatile * unused, char *data)
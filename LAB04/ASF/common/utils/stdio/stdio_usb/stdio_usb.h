@@ -79,6 +79,12 @@ extern int (*ptr_put)(void volatile*, char);
 extern void (*ptr_get)(void volatile*, char*);
 
 /*! \brief Sends a character with the USART.
+ *
+ * With STDIO_USB_TX_BUFFER_SIZE defined the character is only added to
+ * the output ring, which is written to the CDC interface on a newline,
+ * when STDIO_USB_TX_THRESHOLD characters are pending and on every SOF.
+ * This never waits: when the host does not read, a full ring drops the
+ * character, see \ref stdio_usb_get_dropped.
  *
  * \param usart   Base address of the USART instance.
  * \param data    Character to write.
@@ -89,6 +95,27 @@ extern void (*ptr_get)(void volatile*, char*);
  */
 int stdio_usb_putchar (volatile void * usart, char data);
 
+#ifdef STDIO_USB_TX_BUFFER_SIZE
+/*! \brief Writes pending output to the CDC interface, as much as it takes
+ *  without waiting.
+ *
+ * \return Nothing.
+ */
+void stdio_usb_flush(void);
+
+/*! \brief Start of frame callback, writes pending output.
+ *
+ * To be used as UDC_SOF_EVENT().
+ *
+ * \return Nothing.
+ */
+void stdio_usb_sof_action(void);
+
+/*! \brief Number of characters dropped because the output ring was full.
+ */
+uint32_t stdio_usb_get_dropped(void);
+#endif
+
 /*! \brief Waits until a character is received, and returns it.
  *
  * \param usart   Base address of the USART instance.
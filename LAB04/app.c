@@ -10,11 +10,62 @@
 #include "conf_app.h"
 
 
+/*****  VARIABLES  ****************************************************/
+
+// ADC sample buffers, filled by the PDCA
+static uint16_t app_adc_buffer[APP_ADC_BUFFERS][APP_ADC_BUFFER_SIZE];
+
+// Ring of ADC sample buffers
+static void *const app_adc_buffers[APP_ADC_BUFFERS] = {
+#define APP_ADC_BUFFER_ENTRY(n, unused)  app_adc_buffer[n],
+	MREPEAT(APP_ADC_BUFFERS, APP_ADC_BUFFER_ENTRY, ~)
+#undef APP_ADC_BUFFER_ENTRY
+};
+
+// ADC sample stream
+pdca_stream_t app_adc_stream = {
+	.channel       = APP_ADC_PDCA_CHANNEL,
+	.pid           = APP_ADC_PDCA_PID,
+	.transfer_size = PDCA_TRANSFER_SIZE_HALF_WORD,
+	.buffers       = app_adc_buffers,
+	.nb_buffers    = APP_ADC_BUFFERS,
+	.size          = APP_ADC_BUFFER_SIZE
+};
+
+// Scanned ADC channels, number of channels and frames per buffer
+static uint8_t app_adc_channels;
+static uint8_t app_adc_nb_channels;
+static uint16_t app_adc_frames;
+
+// Completed buffers, from the PDCA interrupt to the main loop.
+// timestamp is the number of the first frame, value the buffer.
+static spsc_event_t app_adc_event_buffer[APP_ADC_BUFFERS];
+spsc_ring_t app_adc_events;
+
+// Number of the first frame of the buffer being filled
+static uint32_t app_adc_frame_count;
+
+// Stream overruns handled so far, and the frames they lost
+static uint32_t app_adc_overruns;
+static uint32_t app_adc_lost_frames;
+
+// TC clocks from a trigger to the end of the scan it starts
+static uint16_t app_adc_scan_ticks;
+
+// Buffer complete callback given to app_init()
+static pdca_stream_callback_t app_adc_callback;
+
+// TC clock and trigger period (in TC clocks), the frame time base
+static uint32_t app_tc_hz;
+static uint32_t app_tc_period;
+
+
+
 /*****  PRIVATE PROTOTYPES  *******************************************/
 
 // Private functions
 void app_init_sdmmc_spi(void);
-void app_init_adc(void);
+void app_init_adc(pdca_stream_callback_t callback);
 void app_init_tc(void);
 
 
@@ -23,23 +74,207 @@ void app_init_tc(void);
 /*
  * Main initializing
  *
- *  This function initializes the required drivers
+ *  This function initializes the required drivers and starts
+ *  sampling, adc_callback is called for every buffer of samples
  */
-void app_init(void)
+void app_init(pdca_stream_callback_t adc_callback)
 {
 	// Init SD/MMC SPI driver
 	app_init_sdmmc_spi();
 	
-	// Init ADC driver
-	app_init_adc();
+	// Init ADC driver and sample stream
+	app_init_adc(adc_callback);
 
 	// Init Timer/Counter driver
 	app_init_tc();
+	
+	// Start scanning the default channels
+	app_adc_set_channels(APP_ADC_CHANNELS);
+}
+
+
+/*
+ * ADC set channels
+ *
+ *  Stops sampling, enables the channels in the mask and restarts.
+ *  Every trigger converts all enabled channels in ascending order,
+ *  so the ring holds frames of one value per channel. Buffers are
+ *  sized to a whole number of frames.
+ *  Returns false if the mask is empty or out of range.
+ */
+bool app_adc_set_channels(uint8_t channels)
+{
+	uint8_t ch;
+	
+	if (!channels || (channels >> APP_ADC_NB_CHANNELS)) return false;
+	
+	// Stop triggering and let the last scan finish
+	tc_stop(APP_TC, APP_TC_CHANNEL);
+	tc_stop(APP_TC, APP_TC_COUNT_CHANNEL);
+	pdca_stream_stop(&app_adc_stream);
+	delay_us(1000000 / APP_ADC_SAMPLE_FREQ + 1);
+	
+	// Enable the selected channels
+	app_adc_nb_channels = 0;
+	for (ch = 0; ch < APP_ADC_NB_CHANNELS; ch++)
+	{
+		if (channels & (1 << ch))
+		{
+			adc_enable(&AVR32_ADC, ch);
+			app_adc_nb_channels++;
+		}
+		else adc_disable(&AVR32_ADC, ch);
+	}
+	app_adc_channels = channels;
+	
+	// Whole frames per buffer
+	app_adc_frames = APP_ADC_BUFFER_SIZE / app_adc_nb_channels;
+	app_adc_stream.size = app_adc_frames * app_adc_nb_channels;
+	
+	// A scan takes about 3.5 us per channel, rounded up to 4 us
+	app_adc_scan_ticks = (app_tc_hz / 1000) * 4 * app_adc_nb_channels / 1000 + 1;
+	
+	// Nothing left to read, frame numbers restart
+	spsc_ring_init(&app_adc_events, app_adc_event_buffer, APP_ADC_BUFFERS);
+	app_adc_frame_count = 0;
+	app_adc_overruns = 0;
+	app_adc_lost_frames = 0;
+	
+	// Drop a stale result, then stream LCDR to the sample ring
+	(void)AVR32_ADC.lcdr;
+	pdca_stream_start(&app_adc_stream);
+	
+	// Start counting and triggering, frame 0 is at the first trigger
+	tc_start(APP_TC, APP_TC_COUNT_CHANNEL);
+	tc_start(APP_TC, APP_TC_CHANNEL);
+	
+	return true;
+}
+
+
+/*
+ * ADC get channels
+ *
+ *  Returns the scanned channels as a bit mask
+ */
+uint8_t app_adc_get_channels(void)
+{
+	return app_adc_channels;
+}
+
+
+/*
+ * ADC get number of channels
+ *
+ *  Returns the number of values in a frame
+ */
+uint8_t app_adc_get_nb_channels(void)
+{
+	return app_adc_nb_channels;
+}
+
+
+/*
+ * ADC read
+ *
+ *  Returns the oldest buffer completed by the PDCA or NULL.
+ *  frames is set to the number of frames in the buffer and
+ *  first_frame to the number of the first one (for timestamps).
+ */
+const uint16_t *app_adc_read(uint16_t *frames, uint32_t *first_frame)
+{
+	spsc_event_t event;
+	
+	if (!spsc_ring_pop(&app_adc_events, &event)) return NULL;
+	
+	*frames = app_adc_frames;
+	*first_frame = event.timestamp;
+	
+	return (const uint16_t *)event.value;
+}
+
+
+/*
+ * ADC release
+ *
+ *  Gives the buffer returned by app_adc_read() back to the ring.
+ *  If the PDCA stopped for lack of a buffer, this restarts it
+ *  between two scans and moves the frame number on by the
+ *  triggers counted meanwhile, so timestamps stay right.
+ */
+void app_adc_release(void)
+{
+	irqflags_t flags = cpu_irq_save();
+	
+	if (app_adc_stream.overruns != app_adc_overruns)
+	{
+		uint16_t ra = tc_read_ra(APP_TC, APP_TC_CHANNEL);
+		uint16_t cv, lost;
+		
+		// Stay clear of a trigger (at RA) and of the scan it starts
+		do cv = tc_read_tc(APP_TC, APP_TC_CHANNEL);
+		while (cv + 2 >= ra && cv <= ra + app_adc_scan_ticks);
+		
+		// The next result is the first value of frame <triggers>,
+		// the counter is 16 bits but a stall is much shorter
+		lost = (uint16_t)tc_read_tc(APP_TC, APP_TC_COUNT_CHANNEL) - (uint16_t)app_adc_frame_count;
+		app_adc_frame_count += lost;
+		app_adc_lost_frames += lost;
+		app_adc_overruns = app_adc_stream.overruns;
+		
+		// Drop the result of the last scan, the restart reloads the PDCA
+		(void)AVR32_ADC.lcdr;
+	}
+	pdca_stream_release(&app_adc_stream);
+	
+	cpu_irq_restore(flags);
+}
+
+
+/*
+ * ADC get lost frames
+ *
+ *  Returns the frames not sampled while the PDCA was stopped
+ *  (see app_adc_stream.overruns) since sampling was started
+ */
+uint32_t app_adc_get_lost_frames(void)
+{
+	return app_adc_lost_frames;
+}
+
+
+/*
+ * ADC get clock
+ *
+ *  Frames are taken exactly one trigger period apart, so the
+ *  time of a frame follows from its number (since sampling was
+ *  last started): frame * period / clock_hz seconds.
+ */
+void app_adc_get_clock(uint32_t *clock_hz, uint32_t *period)
+{
+	*clock_hz = app_tc_hz;
+	*period = app_tc_period;
 }
 
 
 /*****  PRIVATE FUNCTIONS  ********************************************/
 
+/*
+ * ADC buffer complete handler
+ *
+ *  Called from the PDCA interrupt, queues the buffer with its
+ *  first frame number for app_adc_read() and calls the callback
+ *  given to app_init()
+ */
+static void app_adc_buffer_irq(pdca_stream_t *stream, void *buffer)
+{
+	spsc_ring_push(&app_adc_events, app_adc_frame_count, (uint32_t)buffer);
+	app_adc_frame_count += app_adc_frames;
+	
+	if (app_adc_callback) app_adc_callback(stream, buffer);
+}
+
+
 /*
  * SD/MMC via SPI initializing
  *
@@ -90,14 +325,15 @@ void app_init_sdmmc_spi(void)
 /*
  * ADC initializing
  *
- *  This initializes the ADC driver with configuration from conf_app.h
+ *  This initializes the ADC driver with configuration from conf_app.h.
+ *  Conversions are started by the TC (TIOA rising edge) and the PDCA
+ *  moves each result from LCDR into the sample ring, so the CPU only
+ *  sees full buffers. Channels are enabled by app_adc_set_channels().
  */
-void app_init_adc(void)
+void app_init_adc(pdca_stream_callback_t callback)
 {
-	// ADC GPIO pin config
-	const gpio_map_t ADC_GPIO_MAP = {
-		{ APP_ADC_POT_PIN, APP_ADC_POT_FUNCTION }
-	};
+	// ADC GPIO pin config, all channels that can be scanned
+	const gpio_map_t ADC_GPIO_MAP = APP_ADC_GPIO_MAP;
 	
 	// Assign and enable GPIO pins to the ADC function
 	gpio_enable_module(ADC_GPIO_MAP, sizeof(ADC_GPIO_MAP) / sizeof(ADC_GPIO_MAP[0]));
@@ -106,17 +342,24 @@ void app_init_adc(void)
 	AVR32_ADC.mr |= 0x1 << AVR32_ADC_MR_PRESCAL_OFFSET;
 	adc_configure(&AVR32_ADC);
 	
-	// Enable the ADC channel
-	adc_enable(&AVR32_ADC, APP_ADC_POT_CHANNEL);
+	// Start conversions on the hardware trigger
+	AVR32_ADC.mr |= AVR32_ADC_MR_TRGEN_MASK |
+			(APP_ADC_TRIGGER << AVR32_ADC_MR_TRGSEL_OFFSET);
+	
+	// Set up the sample stream
+	app_adc_callback = callback;
+	app_adc_stream.callback = app_adc_buffer_irq;
+	pdca_stream_init(&app_adc_stream, APP_ADC_PDCA_PRIORITY);
 }
 
 
 /*
  * Timer/Counter initializer
  *
- *  Initializes the Timer/Counter driver for reading ADC data.
- *  It uses the TC waveform type with clock source 5 (128 divider).
- *  Configured with an update interval of 50 Hz to correspond with the ADC driver
+ *  Initializes the Timer/Counter driver as the ADC trigger.
+ *  It uses the TC waveform type with clock source 3 (8 divider),
+ *  TIOA is set on RA and cleared on RC, so it rises once per
+ *  period of APP_ADC_SAMPLE_FREQ.
  */
 void app_init_tc(void)
 {
@@ -129,10 +372,10 @@ void app_init_tc(void)
 		.bcpc     = TC_EVT_EFFECT_NOOP,		// RC compare effect on TIOB.
 		.bcpb     = TC_EVT_EFFECT_NOOP,		// RB compare effect on TIOB.
 
-		.aswtrg   = TC_EVT_EFFECT_NOOP,		// Software trigger effect on TIOA.
+		.aswtrg   = TC_EVT_EFFECT_CLEAR,	// Software trigger effect on TIOA.
 		.aeevt    = TC_EVT_EFFECT_NOOP,		// External event effect on TIOA.
-		.acpc     = TC_EVT_EFFECT_NOOP,		// RC compare effect on TIOA.
-		.acpa     = TC_EVT_EFFECT_NOOP,		// RA compare effect on TIOA. (none, set and clear)
+		.acpc     = TC_EVT_EFFECT_CLEAR,	// RC compare effect on TIOA.
+		.acpa     = TC_EVT_EFFECT_SET,		// RA compare effect on TIOA. (none, set and clear)
 
 		.wavsel   = TC_WAVEFORM_SEL_UP_MODE_RC_TRIGGER, // Waveform selection: Up mode with automatic trigger(reset) on RC compare.
 		.enetrg   = false,					// External event trigger enable.
@@ -142,32 +385,36 @@ void app_init_tc(void)
 		.cpcstop  = false,					// Counter clock stopped with RC compare.
 		.burst    = false,					// Burst signal selection.
 		.clki     = false,					// Clock inversion.
-		.tcclks   = TC_CLOCK_SOURCE_TC5		// Internal source clock 5, connected to fPBA / 128.
+		.tcclks   = APP_TC_CLOCK			// Internal source clock 3, connected to fPBA / 8.
 	};
 	// Initialize the timer/counter.
 	tc_init_waveform(APP_TC, &tc_waveform_config);
 	
-	
-	// Options for enabling TC interrupts
-	static const tc_interrupt_t tc_interrupt_config = {
-		.etrgs = 0,
-		.ldrbs = 0,
-		.ldras = 0,
-		.cpcs  = 1, // Enable interrupt on RC compare alone
-		.cpbs  = 0,
-		.cpas  = 0,
-		.lovrs = 0,
-		.covfs = 0
-	};
-
-	// We want 50 Hz: (1 / (fPBA / 128)) * RC = 0.02 s, hence RC = (fPBA / 128) / 50
-	tc_write_rc(APP_TC, APP_TC_CHANNEL, ((sysclk_get_pba_hz() / 128) / APP_READ_ADC_FREQ));
+	// RC = (fPBA / 8) / APP_ADC_SAMPLE_FREQ, must fit in 16 bits
+	app_tc_hz = sysclk_get_pba_hz() / APP_TC_CLOCK_DIV;
+	app_tc_period = app_tc_hz / APP_ADC_SAMPLE_FREQ;
+	tc_write_rc(APP_TC, APP_TC_CHANNEL, app_tc_period);
+	tc_write_ra(APP_TC, APP_TC_CHANNEL, app_tc_period / 2);
 
-	// configure the timer interrupt
-	tc_configure_interrupts(APP_TC, APP_TC_CHANNEL, &tc_interrupt_config);
+	// A second channel counts the rising edges of TIOA, the triggers
+	static const tc_capture_opt_t tc_count_config = {
+		.channel  = APP_TC_COUNT_CHANNEL,	// Channel selection.
+		.ldrb     = TC_SEL_NO_EDGE,			// RB loading selection.
+		.ldra     = TC_SEL_NO_EDGE,			// RA loading selection.
+		.cpctrg   = TC_NO_TRIGGER_COMPARE_RC,	// RC compare trigger enable.
+		.abetrg   = TC_EXT_TRIG_SEL_TIOA,	// TIOA or TIOB external trigger selection.
+		.etrgedg  = TC_SEL_NO_EDGE,			// External trigger edge selection.
+		.ldbdis   = false,					// Counter clock disable with RB loading.
+		.ldbstop  = false,					// Counter clock stopped with RB loading.
+		.burst    = TC_BURST_NOT_GATED,		// Burst signal selection.
+		.clki     = TC_CLOCK_RISING_EDGE,	// Clock inversion.
+		.tcclks   = TC_CLOCK_SOURCE_XC1		// External clock XC1, connected to TIOA0.
+	};
+	tc_select_external_clock(APP_TC, APP_TC_COUNT_CHANNEL, APP_TC_COUNT_CLOCK);
+	tc_init_capture(APP_TC, &tc_count_config);
 
-	// Start the timer/counter.
-	tc_start(APP_TC, APP_TC_CHANNEL);
+	// No interrupt: the ADC and PDCA do the work, the timer/counter
+	// is started by app_adc_set_channels()
 }
 
 
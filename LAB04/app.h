@@ -12,8 +12,35 @@
 							"--------------- J.R.Hoem (ET014G)\r\n\r\n"
 
 
-// Initializes required ASF drivers
-void app_init(void);
+// ADC sample stream, one buffer of frames per callback
+extern pdca_stream_t app_adc_stream;
+
+// Completed ADC buffers waiting for app_adc_read()
+extern spsc_ring_t app_adc_events;
+
+// Initializes required ASF drivers and starts ADC sampling
+void app_init(pdca_stream_callback_t adc_callback);
+
+// Selects the scanned ADC channels (bit mask) and restarts sampling
+bool app_adc_set_channels(uint8_t channels);
+
+// Returns the scanned ADC channels (bit mask)
+uint8_t app_adc_get_channels(void);
+
+// Returns the number of scanned ADC channels (values per frame)
+uint8_t app_adc_get_nb_channels(void);
+
+// Returns the next buffer of frames (NULL if none) and its size
+const uint16_t *app_adc_read(uint16_t *frames, uint32_t *first_frame);
+
+// Gives the buffer returned by app_adc_read() back to the PDCA
+void app_adc_release(void);
+
+// Returns the frames lost while the PDCA was stalled
+uint32_t app_adc_get_lost_frames(void);
+
+// Returns the trigger clock (Hz) and its periods between frames
+void app_adc_get_clock(uint32_t *clock_hz, uint32_t *period);
 
 
 #endif /* APP_H_ */
\ No newline at end of file
@@ -85,10 +85,15 @@
 
 // From module: Interrupt management - UC3 implementation
 #include <interrupt.h>
+#include <spsc_ring.h>
 
 // From module: Memory Control Access Interface
 #include <ctrl_access.h>
 
+// From module: PDCA - Peripheral DMA Controller
+#include <pdca.h>
+#include <pdca_stream.h>
+
 // From module: PM Power Manager- UC3 A0/A1/A3/A4/B0/B1 implementation
 #include <power_clocks_lib.h>
 #include <sleep.h>
@@ -116,9 +121,17 @@
 // From module: USB CDC Protocol
 #include <usb_protocol_cdc.h>
 
-// From module: USB Device CDC (Single Interface Device)
+// From module: USB Device CDC (Composite Device)
 #include <udi_cdc.h>
 
+// From module: USB Device MSC (Composite Device)
+#include <udi_msc.h>
+
+// From module: USB MSC Protocol
+#include <sbc_protocol.h>
+#include <spc_protocol.h>
+#include <usb_protocol_msc.h>
+
 // From module: USB Device CDC Standard I/O (stdio) - AVR implementation
 #include <stdio_usb.h>
 
@@ -126,4 +139,7 @@
 #include <udc.h>
 #include <udd.h>
 
+// From module: USBB - Universal Serial Bus (USB) driver
+#include <usbb_device.h>
+
 #endif // ASF_H
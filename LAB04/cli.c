@@ -30,6 +30,11 @@ volatile uint8_t cmd_index = 0;
 volatile char cmd_argument[CLI_BUFFER_SIZE];
 volatile bool cmd_arg_active = false;
 
+// Bytes read from USB CDC and the next one to handle
+char rx_buffer[CLI_BUFFER_SIZE];
+iram_size_t rx_len = 0;
+iram_size_t rx_index = 0;
+
 
 
 /*****  PRIVATE PROTOTYPES  *******************************************/
@@ -46,16 +51,31 @@ void cli_clear_cmd(void);
 /*
  * CLI task 
  *
- *  This function checks the stdin buffer for 
- *  data and sends it to the build cmd function. 
+ *  This function checks the USB CDC receive buffer for
+ *  data and sends it to the build cmd function. It never
+ *  waits for input, so the main loop keeps running while
+ *  the terminal is idle. It stops at a complete command,
+ *  the rest of the bytes read waits for the next call.
  */
 void cli_task(void)
 {
 	char ch;
-	scanf("%c",&ch);
-
-	if (ch) {
-		cli_build_cmd(ch);
+	
+	if (rx_index == rx_len)
+	{
+		// Nothing received
+		if (!udi_cdc_is_rx_ready()) return;
+		
+		// Read what is there, up to one buffer at a time
+		rx_len = min(udi_cdc_get_nb_received_data(), sizeof(rx_buffer));
+		rx_len -= udi_cdc_read_buf(rx_buffer, rx_len);
+		rx_index = 0;
+	}
+	
+	while (rx_index < rx_len && cli_command == CLI_CMD_NONE)
+	{
+		ch = rx_buffer[rx_index++];
+		if (ch) cli_build_cmd(ch);
 	}
 }
 
@@ -112,7 +132,9 @@ void cli_parse_cmd(char *cmd)
 		else if (!strcmp((char*)cmd, "stop")) cli_command = CLI_CMD_STOP;
 		else if (!strcmp((char*)cmd, "status")) cli_command = CLI_CMD_STATUS;
 		else if (!strcmp((char*)cmd, "format")) cli_command = CLI_CMD_FORMAT;
+		else if (!strcmp((char*)cmd, "check")) cli_command = CLI_CMD_CHECK;
 		else if (!strcmp((char*)cmd, "file")) cli_arg_cmd = CLI_CMD_FILE;
+		else if (!strcmp((char*)cmd, "channels")) cli_arg_cmd = CLI_CMD_CHANNELS;
 		else if (!strcmp((char*)cmd, "help")) cli_command = CLI_CMD_HELP;
 		else cli_command = CLI_CMD_UNKNOWN;
 	}
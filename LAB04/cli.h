@@ -13,7 +13,9 @@
                       "  stop             stops logging\r\n" \
                       "  status           shows current status\r\n" \
                       "  format           formats active drive\r\n" \
+                      "  check            verifies the free space count\r\n" \
                       "  file <filename>  select/create logfile\r\n" \
+                      "  channels <mask>  ADC channels (1 temp, 2 pot, 4 light)\r\n" \
                       "  help             displays this message\r\n\r\n"
 
 // CLI commands
@@ -23,7 +25,9 @@ typedef enum {
 	CLI_CMD_STOP,
 	CLI_CMD_STATUS,
 	CLI_CMD_FORMAT,
+	CLI_CMD_CHECK,
 	CLI_CMD_FILE,
+	CLI_CMD_CHANNELS,
 	CLI_CMD_HELP,
 	CLI_CMD_ARGUMENT,
 	CLI_CMD_UNKNOWN
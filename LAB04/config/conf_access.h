@@ -194,6 +194,8 @@
 #define Lun_4_usb_write_10                      sd_mmc_spi_usb_write_10
 #define Lun_4_mem_2_ram                         sd_mmc_spi_mem_2_ram
 #define Lun_4_ram_2_mem                         sd_mmc_spi_ram_2_mem
+#define Lun_4_mem_2_ram_multi                   sd_mmc_spi_mem_2_ram_multi
+#define Lun_4_ram_2_mem_multi                   sd_mmc_spi_ram_2_mem_multi
 #define LUN_4_NAME                              "\"SD/MMC Card over SPI\""
 //! @}
 
@@ -249,11 +251,7 @@
 /*! \name Activation of Interface Features
  */
 //! @{
-#ifdef ACCESS_USB_ENABLED
-#define ACCESS_USB           true  //!< MEM <-> USB interface.
-#else
-#define ACCESS_USB           false //!< MEM <-> USB interface.
-#endif
+#define ACCESS_USB           true  //!< MEM <-> USB interface, used by the MSC interface.
 
 #ifdef ACCESS_MEM_TO_RAM_ENABLED
 #define ACCESS_MEM_TO_RAM    true  //!< MEM <-> RAM interface.
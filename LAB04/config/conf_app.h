@@ -8,25 +8,53 @@
 #define CONF_APP_H_
 
 // Default logfile
-#define APP_LOG_FILENAME      "logfile.csv"
+#define APP_LOG_FILENAME      "logfile.bin"
+
+// Logfile space reserved (contiguous) when logging starts
+#define APP_LOG_PREALLOCATE   (8UL << 20)
 
 // Default memory slot
 #define APP_SD_MMC_SLOT       0
 
-// ADC reading interval in Hz
-#define APP_READ_ADC_FREQ     50
+// ADC sampling rate in Hz, each conversion is triggered by the TC
+#define APP_ADC_SAMPLE_FREQ   2000
+
+// ADC sample ring, number of buffers (a power of two) and samples per buffer
+#define APP_ADC_BUFFERS       8
+#define APP_ADC_BUFFER_SIZE   64
+
+// ADC configuration, channels 0 to APP_ADC_NB_CHANNELS-1 can be scanned.
+// All enabled channels are converted on each trigger, this must take less
+// than one sample period (about 3.5 us per channel)
+#define APP_ADC_NB_CHANNELS   3
+#define APP_ADC_GPIO_MAP      { { ADC_TEMPERATURE_PIN,   ADC_TEMPERATURE_FUNCTION   }, \
+                                { ADC_POTENTIOMETER_PIN, ADC_POTENTIOMETER_FUNCTION }, \
+                                { ADC_LIGHT_PIN,         ADC_LIGHT_FUNCTION         } }
+#define APP_ADC_CHANNELS      (1 << ADC_POTENTIOMETER_CHANNEL)  // Default scan mask
+#define APP_ADC_TRIGGER       APP_TC_CHANNEL  // TRGSEL: TIOA of the TC channel
 
-// ADC configuration
-#define APP_ADC_POT_CHANNEL   1
-#define APP_ADC_POT_PIN       AVR32_ADC_AD_1_PIN
-#define APP_ADC_POT_FUNCTION  AVR32_ADC_AD_1_FUNCTION
+// PDCA configuration (ADC to sample ring)
+#define APP_ADC_PDCA_CHANNEL  2
+#define APP_ADC_PDCA_PID      AVR32_PDCA_PID_ADC_RX
+#define APP_ADC_PDCA_PRIORITY AVR32_INTC_INT0
 
 // Timer/Counter configuration
 #define APP_TC                (&AVR32_TC)
 #define APP_TC_CHANNEL        0
-#define APP_TC_IRQ            AVR32_TC_IRQ0
-#define APP_TC_IRQ_GROUP      AVR32_TC_IRQ_GROUP
-#define APP_TC_IRQ_PRIORITY   AVR32_INTC_INT0
+#define APP_TC_CLOCK          TC_CLOCK_SOURCE_TC3  // fPBA / 8
+#define APP_TC_CLOCK_DIV      8
+
+// Timer/Counter channel counting the ADC triggers (clocked by TIOA0), so
+// that frames lost while the PDCA was stalled still advance the frame number
+#define APP_TC_COUNT_CHANNEL  1
+#define APP_TC_COUNT_CLOCK    TC_CH1_EXT_CLK1_SRC_TIOA0
+
+// Live sample stream on a second CDC port (see stream.h). The part has
+// endpoints for two CDC ports or for one CDC port and the MSC interface,
+// so the card is not exposed to the USB host while this is enabled.
+#define APP_STREAM_CDC         0
+#define APP_STREAM_PORT        1
+#define APP_STREAM_BUFFER_SIZE 1024  // Packet queue, a power of two
 
 
 
@@ -92,6 +92,27 @@
 //! In player mode, 1 is OK (shall be > 0).
 #define FS_NB_CACHE_CLUSLIST  1
 
+//! Number of sectors in the sector cache, the least recently used is replaced (shall be > 0).
+//! FAT, directory and data sectors then stay cached side by side.
+#define FS_NB_CACHE_SECTOR    4
+
+//! Size in bytes of the free cluster bitmap (one bit per cluster, 0 to disable).
+//! 8 KB covers any FAT16 partition, larger partitions fall back to a FAT scan.
+//! Define FS_FREE_MAP_ADDR to place the bitmap at a fixed address, e.g. in the
+//! EVK1100 SDRAM once the application has initialized it.
+#define FS_FREE_MAP_SIZE      8192
+
+//! Number of files with an extent map (runs of contiguous clusters), 0 to disable.
+//! A seek, an append or a switch between open files then doesn't read the FAT chain again.
+#define FS_NB_EXTENT_MAP      2
+
+//! Number of extents stored in each map, the part of a file after the last extent is read in FAT.
+#define FS_NB_EXTENT          16
+
+//! Number of cluster allocations or releases between two copies of FAT1 in FAT2 (0 to copy at each one).
+//! FAT2 is also updated at each FAT cache flush (file close, nav_exit()); until then FAT1 is the reference.
+#define FS_FAT2_MIRROR_INTERVAL  32
+
 //! Maximal number of simultaneous navigators.
 #define FS_NB_NAVIGATOR       2
 
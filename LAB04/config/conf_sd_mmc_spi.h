@@ -61,12 +61,36 @@
 
 //_____ D E F I N I T I O N S ______________________________________________
 
-//! SPI master speed in Hz.
-#define SD_MMC_SPI_MASTER_SPEED     12000000
+//! Upper limit of the SPI master speed in Hz, the driver also limits the
+//! clock to the card TRAN_SPEED and to what PBA can be divided to.
+#define SD_MMC_SPI_MASTER_SPEED     50000000
+
+//! Switch SD cards to high speed mode (CMD6) when PBA allows more than 25 MHz.
+#define SD_MMC_SPI_HIGH_SPEED       true
 
 //! Number of bits in each SPI transfer.
 #define SD_MMC_SPI_BITS             8
 
+//! Frame size of the 512 B data phase (8 or 16). 16-bit frames halve the
+//! number of SPI transfers; buffers on odd addresses still use 8-bit frames.
+#define SD_MMC_SPI_DATA_BITS        16
+
+//! Send ACMD23 (SET_WR_BLK_ERASE_COUNT) before multiple block writes to SD cards.
+#define SD_MMC_SPI_PRE_ERASE        true
+
+//! Time a card may stay busy programming a written block before the write
+//! fails, in ms (SD: 250, SDXC: 500).
+#define SD_MMC_SPI_WRITE_TIMEOUT_MS 500
+
+//! Use the PDCA for the data phase of sector reads and writes.
+#define SD_MMC_SPI_USE_PDCA         true
+
+//! PDCA channels and peripheral IDs used when SD_MMC_SPI_USE_PDCA is true.
+#define SD_MMC_SPI_PDCA_RX_CHANNEL  0
+#define SD_MMC_SPI_PDCA_TX_CHANNEL  1
+#define SD_MMC_SPI_PDCA_RX_PID      AVR32_PDCA_PID_SPI1_RX
+#define SD_MMC_SPI_PDCA_TX_PID      AVR32_PDCA_PID_SPI1_TX
+
 
 #if !defined(SD_MMC_SPI)
 //! Set SD_MMC_SPI, default SPI register address if this is a user board
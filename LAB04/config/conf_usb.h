@@ -1,7 +1,7 @@
 /**
  * \file
  *
- * \brief USB configuration file for CDC application
+ * \brief USB configuration file for CDC and MSC composite application
  *
  * Copyright (c) 2009-2015 Atmel Corporation. All rights reserved.
  *
@@ -48,6 +48,7 @@
 #define _CONF_USB_H_
 
 #include "compiler.h"
+#include "conf_app.h"
 
 //#warning You must refill the following definitions with a correct values
 
@@ -58,7 +59,11 @@
 
 //! Device definition (mandatory)
 #define  USB_DEVICE_VENDOR_ID             USB_VID_ATMEL
-#define  USB_DEVICE_PRODUCT_ID            USB_PID_ATMEL_ASF_CDC
+#if APP_STREAM_CDC
+#define  USB_DEVICE_PRODUCT_ID            USB_PID_ATMEL_ASF_TWO_CDC
+#else
+#define  USB_DEVICE_PRODUCT_ID            USB_PID_ATMEL_ASF_MSC_CDC
+#endif
 #define  USB_DEVICE_MAJOR_VERSION         1
 #define  USB_DEVICE_MINOR_VERSION         0
 #define  USB_DEVICE_POWER                 100 // Consumption on Vbus line (mA)
@@ -92,8 +97,7 @@
  */
 // #define  UDC_VBUS_EVENT(b_vbus_high)      user_callback_vbus_action(b_vbus_high)
 // extern void user_callback_vbus_action(bool b_vbus_high);
-// #define  UDC_SOF_EVENT()                  user_callback_sof_action()
-// extern void user_callback_sof_action(void);
+#define  UDC_SOF_EVENT()                  stdio_usb_sof_action()
 // #define  UDC_SUSPEND_EVENT()              user_callback_suspend_action()
 // extern void user_callback_suspend_action(void);
 // #define  UDC_RESUME_EVENT()               user_callback_resume_action()
@@ -120,17 +124,43 @@
  * @{
  */
 
+//! Interface and endpoints of the CDC port, see the composite below
+#define  UDI_CDC_DATA_EP_IN_0             (1 | USB_EP_DIR_IN)  // TX
+#define  UDI_CDC_DATA_EP_OUT_0            (2 | USB_EP_DIR_OUT) // RX
+#define  UDI_CDC_COMM_EP_0                (3 | USB_EP_DIR_IN)  // Notify endpoint
+#define  UDI_CDC_COMM_IFACE_NUMBER_0      0
+#define  UDI_CDC_DATA_IFACE_NUMBER_0      1
+
+#if APP_STREAM_CDC
+//! Interface and endpoints of the sample stream port, in place of the MSC
+#define  UDI_CDC_DATA_EP_IN_1             (4 | USB_EP_DIR_IN)  // TX
+#define  UDI_CDC_DATA_EP_OUT_1            (5 | USB_EP_DIR_OUT) // RX
+#define  UDI_CDC_COMM_EP_1                (6 | USB_EP_DIR_IN)  // Notify endpoint
+#define  UDI_CDC_COMM_IFACE_NUMBER_1      2
+#define  UDI_CDC_DATA_IFACE_NUMBER_1      3
+
+//! Number of communication port used (1 to 3)
+#define  UDI_CDC_PORT_NB 2
+#else
 //! Number of communication port used (1 to 3)
 #define  UDI_CDC_PORT_NB 1
+#endif
 
 //! Interface callback definition
 #define  UDI_CDC_ENABLE_EXT(port)          true
-#define  UDI_CDC_DISABLE_EXT(port)
 #define  UDI_CDC_RX_NOTIFY(port)
 #define  UDI_CDC_TX_EMPTY_NOTIFY(port)
 #define  UDI_CDC_SET_CODING_EXT(port,cfg)
-#define  UDI_CDC_SET_DTR_EXT(port,set)
 #define  UDI_CDC_SET_RTS_EXT(port,set)
+#if APP_STREAM_CDC
+//! The sample stream runs while the host holds DTR of its port
+#define  UDI_CDC_DISABLE_EXT(port)         stream_set_dtr(port,false)
+#define  UDI_CDC_SET_DTR_EXT(port,set)     stream_set_dtr(port,set)
+extern void stream_set_dtr(uint8_t port, bool b_enable);
+#else
+#define  UDI_CDC_DISABLE_EXT(port)
+#define  UDI_CDC_SET_DTR_EXT(port,set)
+#endif
 
 // #define UDI_CDC_ENABLE_EXT(port) my_callback_cdc_enable()
 // extern bool my_callback_cdc_enable(void);
@@ -156,10 +186,122 @@
 #define  UDI_CDC_DEFAULT_STOPBITS         CDC_STOP_BITS_1
 #define  UDI_CDC_DEFAULT_PARITY           CDC_PAR_NONE
 #define  UDI_CDC_DEFAULT_DATABITS         8
+
+//! Buffer stdout in a RAM ring of this size (power of two), written to
+//! the CDC interface in chunks. Remove to send one character at a time.
+#define  STDIO_USB_TX_BUFFER_SIZE         512
+//! Pending output that triggers a write before the next newline or SOF
+#define  STDIO_USB_TX_THRESHOLD           64
+//@}
+
+/**
+ * Configuration of MSC interface
+ * @{
+ */
+//! Vendor name and Product version of MSC interface
+#define  UDI_MSC_GLOBAL_VENDOR_ID         "ATMEL   "
+#define  UDI_MSC_GLOBAL_PRODUCT_VERSION   "1.00"
+
+//! Interface callback definition
+#define  UDI_MSC_ENABLE_EXT()             true
+#define  UDI_MSC_DISABLE_EXT()
+
+//! Interface and endpoints of the MSC interface
+//! (still defined with the sample stream, but not part of the device)
+#define  UDI_MSC_EP_IN                    (4 | USB_EP_DIR_IN)
+#define  UDI_MSC_EP_OUT                   (5 | USB_EP_DIR_OUT)
+#define  UDI_MSC_IFACE_NUMBER             2
 //@}
 //@}
 
 
+/**
+ * Description of Composite Device
+ * @{
+ */
+#if APP_STREAM_CDC
+//! USB Interfaces descriptor structure
+#define UDI_COMPOSITE_DESC_T \
+	usb_iad_desc_t       udi_cdc_iad; \
+	udi_cdc_comm_desc_t  udi_cdc_comm; \
+	udi_cdc_data_desc_t  udi_cdc_data; \
+	usb_iad_desc_t       udi_cdc_iad_stream; \
+	udi_cdc_comm_desc_t  udi_cdc_comm_stream; \
+	udi_cdc_data_desc_t  udi_cdc_data_stream
+
+//! USB Interfaces descriptor value for Full Speed
+#define UDI_COMPOSITE_DESC_FS \
+	.udi_cdc_iad         = UDI_CDC_IAD_DESC_0, \
+	.udi_cdc_comm        = UDI_CDC_COMM_DESC_0, \
+	.udi_cdc_data        = UDI_CDC_DATA_DESC_0_FS, \
+	.udi_cdc_iad_stream  = UDI_CDC_IAD_DESC_1, \
+	.udi_cdc_comm_stream = UDI_CDC_COMM_DESC_1, \
+	.udi_cdc_data_stream = UDI_CDC_DATA_DESC_1_FS
+
+//! USB Interfaces descriptor value for High Speed
+#define UDI_COMPOSITE_DESC_HS \
+	.udi_cdc_iad         = UDI_CDC_IAD_DESC_0, \
+	.udi_cdc_comm        = UDI_CDC_COMM_DESC_0, \
+	.udi_cdc_data        = UDI_CDC_DATA_DESC_0_HS, \
+	.udi_cdc_iad_stream  = UDI_CDC_IAD_DESC_1, \
+	.udi_cdc_comm_stream = UDI_CDC_COMM_DESC_1, \
+	.udi_cdc_data_stream = UDI_CDC_DATA_DESC_1_HS
+
+//! USB Interface APIs
+#define UDI_COMPOSITE_API \
+	&udi_api_cdc_comm, \
+	&udi_api_cdc_data, \
+	&udi_api_cdc_comm, \
+	&udi_api_cdc_data
+
+//! Control endpoint size
+#define  USB_DEVICE_EP_CTRL_SIZE          64
+
+//! Total number of interfaces: 2 per CDC port
+#define  USB_DEVICE_NB_INTERFACE          4
+
+//! Total number of endpoints: 3 per CDC port
+#define  USB_DEVICE_MAX_EP                6
+#else
+//! USB Interfaces descriptor structure
+#define UDI_COMPOSITE_DESC_T \
+	usb_iad_desc_t       udi_cdc_iad; \
+	udi_cdc_comm_desc_t  udi_cdc_comm; \
+	udi_cdc_data_desc_t  udi_cdc_data; \
+	udi_msc_desc_t       udi_msc
+
+//! USB Interfaces descriptor value for Full Speed
+#define UDI_COMPOSITE_DESC_FS \
+	.udi_cdc_iad         = UDI_CDC_IAD_DESC_0, \
+	.udi_cdc_comm        = UDI_CDC_COMM_DESC_0, \
+	.udi_cdc_data        = UDI_CDC_DATA_DESC_0_FS, \
+	.udi_msc             = UDI_MSC_DESC_FS
+
+//! USB Interfaces descriptor value for High Speed
+#define UDI_COMPOSITE_DESC_HS \
+	.udi_cdc_iad         = UDI_CDC_IAD_DESC_0, \
+	.udi_cdc_comm        = UDI_CDC_COMM_DESC_0, \
+	.udi_cdc_data        = UDI_CDC_DATA_DESC_0_HS, \
+	.udi_msc             = UDI_MSC_DESC_HS
+
+//! USB Interface APIs
+#define UDI_COMPOSITE_API \
+	&udi_api_cdc_comm, \
+	&udi_api_cdc_data, \
+	&udi_api_msc
+
+//! Control endpoint size
+#define  USB_DEVICE_EP_CTRL_SIZE          64
+
+//! Total number of interfaces: 2 for CDC, 1 for MSC
+#define  USB_DEVICE_NB_INTERFACE          3
+
+//! Total number of endpoints: 3 for CDC, 2 for MSC
+#define  USB_DEVICE_MAX_EP                5
+#endif
+//@}
+
+
 /**
  * USB Device Driver Configuration
  * @{
@@ -167,7 +309,8 @@
 //@}
 
 //! The includes of classes and other headers must be done at the end of this file to avoid compile error
-#include <udi_cdc_conf.h>
+#include <udi_cdc.h>
+#include <udi_msc.h>
 #include <stdio_usb.h>
 
 
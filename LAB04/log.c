@@ -5,11 +5,28 @@
  * Description  : Log functions, uses FAT service and SD/MMC driver
  */
 #include <asf.h>
+#include <inttypes.h>
 #include <string.h>
+#include <stddef.h>
 #include "log.h"
 
 
 
+/*****  DECLARATIONS  *************************************************/
+
+// Number of staged blocks
+#ifndef LOG_STAGE_BLOCKS
+#define LOG_STAGE_BLOCKS 2
+#endif
+
+// A staged block, the header block is staged as well
+typedef union {
+	log_header_t header;
+	log_block_t  data;
+} log_stage_t;
+
+
+
 /*****  VARIABLES  ****************************************************/
 
 // Sets the active memory slot
@@ -21,6 +38,43 @@ volatile char logfile[MAX_FILE_PATH_LENGTH];
 // Tells whether the logfile is open or not
 volatile bool logfile_open = false;
 
+// Staged blocks, sector sized and word aligned so that full blocks
+// are written directly to the card (not through the FAT cache)
+static log_stage_t log_stage[LOG_STAGE_BLOCKS] COMPILER_WORD_ALIGNED;
+
+// Block being filled, oldest full block and number of full blocks
+static uint8_t log_fill;
+static uint8_t log_flush;
+static uint8_t log_full;
+
+// Times a block was full with no free block left
+static uint32_t log_stalls;
+
+// Failed block writes (retried) and blocks given up, which
+// show in the logfile as a gap in the block sequence numbers
+static uint32_t log_write_errors;
+static uint32_t log_lost_blocks;
+
+// Preallocated run: file size before it, first sector, sectors
+// reserved and sectors written
+static bool log_reserved;
+static uint32_t log_base_size;
+static uint32_t log_lba;
+static uint32_t log_lba_size;
+static uint32_t log_lba_used;
+
+// Values per frame and frames per data block
+static uint8_t log_nb_values;
+static uint16_t log_records_per_block;
+
+// Next data block number and expected frame number
+static uint32_t log_sequence;
+static uint32_t log_next_frame;
+
+// ctrl_access lock count when this module last gave the card back,
+// if it moved since, the USB host has used the card
+static uint32_t log_nb_locks;
+
 
 
 /*****  PRIVATE PROTOTYPES  *******************************************/
@@ -28,6 +82,16 @@ volatile bool logfile_open = false;
 // Reset navigator priv prototype
 void reset_navigator(void);
 
+// Card sharing with the USB host
+static bool log_lock(void);
+static void log_unlock(void);
+
+// Block helpers
+static void log_seal_block(void);
+static void log_flush_block(void);
+static void log_drop_block(void);
+static void log_sync_size(void);
+
 
 
 /*****  FUNCTIONS  ****************************************************/
@@ -52,7 +116,12 @@ bool log_init(uint8_t slot)
 	
 	// Try to mount drive if possible
 	printf("\r\nTrying to mount drive %d\r\n", active_drive);
-	if (mount_drive()) {
+	switch (mount_drive()) {
+		case 0:
+		break;
+		case LOG_ERR_CARD_BUSY:
+		return false;
+		default:
 		printf("Try to format the drive using 'format'\r\n");
 		return false;
 	}
@@ -65,9 +134,11 @@ bool log_init(uint8_t slot)
 /*
  * Log set file 
  *
- *  Selects (creates if necessary) logfile
+ *  Selects (creates if necessary) logfile. While the USB host
+ *  uses the card the file is only created by log_start(), this
+ *  returns false then.
  */
-void log_set_file(char *filename)
+bool log_set_file(char *filename)
 {
 	uint8_t i;
 	uint8_t len = strlen(filename);
@@ -82,34 +153,88 @@ void log_set_file(char *filename)
 	}
 	logfile[i] = '\0';
 
-	// Create new logfile
-	reset_navigator();
+	// Create new logfile, the card is shared with the USB host
+	if (!log_lock())
+	{
+		printf("Error: Card in use by the USB host\r\n");
+		return false;
+	}
 	nav_file_create((FS_STRING)logfile);
+	log_unlock();
+	return true;
 }
 
 
 /*
  * Log Start 
  *
- *  Tries to open logfile in append mode for writing
+ *  Tries to open logfile in append mode for writing, then
+ *  stages the header block with the sampling parameters.
+ *  The card is locked until log_stop(), the USB host sees
+ *  it as removed meanwhile.
  */
-bool log_start(void)
+bool log_start(uint8_t channels, uint32_t clock_hz, uint32_t clock_period)
 {
 	logfile_open = false;
 	
-	// Reset navigator just in case
-	reset_navigator();
+	// Take the card from the USB host
+	if (!log_lock())
+	{
+		printf("Error: Card in use by the USB host\r\n");
+		return false;
+	}
 	
 	// Try to navigate to logfile
 	if (!nav_setcwd((FS_STRING)logfile, true, true))
 	{
 		printf("Error: Could not open logfile (err: %d)\r\n", fs_g_status);
+		log_unlock();
 	}
 	else
 	{
 		// Open logfile
 		file_open(FOPEN_MODE_APPEND);
 		logfile_open = true;
+		
+		// Empty staging
+		memset(log_stage, 0, sizeof(log_stage));
+		log_fill = 0;
+		log_flush = 0;
+		log_full = 0;
+		log_stalls = 0;
+		log_write_errors = 0;
+		log_lost_blocks = 0;
+		log_reserved = false;
+		log_lba_size = 0;
+		log_lba_used = 0;
+		
+		// Pad to a block boundary so that all blocks stay aligned
+		uint16_t partial = nav_file_lgt() % LOG_BLOCK_SIZE;
+		if (partial)
+		{
+			file_write_buf((uint8_t*)log_stage, LOG_BLOCK_SIZE - partial);
+		}
+		
+		// Values per frame
+		log_nb_values = 0;
+		for (uint8_t ch = channels; ch; ch >>= 1) log_nb_values += ch & 1;
+		log_records_per_block = LOG_BLOCK_VALUES / log_nb_values;
+		
+		// Header block
+		log_header_t *header = &log_stage[log_fill].header;
+		memcpy(header->magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+		header->version = LOG_VERSION;
+		header->block_size = LOG_BLOCK_SIZE;
+		header->sample_freq = (clock_hz + clock_period / 2) / clock_period;
+		header->clock_hz = clock_hz;
+		header->clock_period = clock_period;
+		header->channels = channels;
+		header->nb_channels = log_nb_values;
+		header->adc_bits = (ADC_MAX_VALUE == 0xFF) ? 8 : 10;
+		log_seal_block();
+		
+		// First data block
+		log_sequence = 0;
 	}
 	
 	return logfile_open;
@@ -118,38 +243,200 @@ bool log_start(void)
 
 
 /*
- * Log write ADC
+ * Log preallocate
+ *
+ *  Reserves a contiguous run of sectors (up to size bytes) after
+ *  the end of the open logfile. Blocks are then written straight
+ *  to these sectors, without any FAT lookup or update, until the
+ *  run is used up. The run may be shorter than asked if the free
+ *  space is fragmented. Call right after log_start().
+ *  Returns false if nothing could be reserved.
+ */
+bool log_preallocate(uint32_t size)
+{
+	uint32_t pos = fs_g_nav_entry.u32_pos_in_file;
+	uint32_t nb_sector = (size + FS_512B - 1) / FS_512B;
+	
+	if (!logfile_open || log_reserved || (pos % FS_512B)) return false;
+	
+	log_lba_size = 0;
+	log_lba_used = 0;
+	
+	while (log_lba_size < nb_sector)
+	{
+		// Get, and alloc if needed, the clusters following the run
+		fs_g_nav_entry.u32_pos_in_file = pos + log_lba_size * FS_512B;
+		if (!fat_write_file(FS_CLUST_ACT_SEG, nb_sector - log_lba_size)) break;
+		
+		// Stop where the run is no longer contiguous
+		if (!log_lba_size) log_lba = fs_g_seg.u32_addr;
+		else if (fs_g_seg.u32_addr != log_lba + log_lba_size) break;
+		
+		log_lba_size += min(fs_g_seg.u32_size_or_pos, nb_sector - log_lba_size);
+	}
+	
+	// Blocks bypass the FAT sector cache, drop any cached copy of the run
+	fs_g_seg.u32_addr = log_lba;
+	fs_g_seg.u32_size_or_pos = log_lba_size;
+	fat_cache_flush_segment(true);
+	
+	// Back to the end of file, store the new cluster list
+	fs_g_nav_entry.u32_pos_in_file = pos;
+	fat_cache_flush();
+	
+	log_base_size = pos;
+	log_reserved = true;
+	
+	return log_lba_size != 0;
+}
+
+
+/*
+ * Log write frame
  *
- *  This function writes the system cycle count and
- *  ADC value (uint16 argument) to the logfile as comma separated 
- *  values if the file is open.
+ *  This function adds a frame of ADC values (one per channel
+ *  given to log_start) to the current data block, and stages
+ *  the block for log_task() when it is full. Frames in a block
+ *  are consecutive, a gap in the frame numbers starts a new one.
  */
-void log_write_adc(uint32_t cy_count, uint16_t value)
+void log_write_frame(uint32_t frame, const uint16_t *values)
 {
 	if (logfile_open)
 	{
-		// Convert data to string
-		char buffer[24];
-		sprintf(buffer, "%lu, %u", cy_count, value);
+		log_block_t *block = &log_stage[log_fill].data;
 		
-		// Write data to file
-		file_write_buf((uint8_t*)buffer, strlen(buffer));
-		file_putc('\r');
-		file_putc('\n');
+		// Keep the records of a block consecutive, the flush
+		// moves on to the next staged block
+		if (block->nb_records && frame != log_next_frame)
+		{
+			log_flush_block();
+			block = &log_stage[log_fill].data;
+		}
+		if (!block->nb_records) block->first_frame = frame;
+		
+		// Add the record
+		memcpy(&block->values[block->nb_records * log_nb_values], values,
+				log_nb_values * sizeof(uint16_t));
+		log_next_frame = frame + 1;
+		
+		// Stage full block
+		if (++block->nb_records == log_records_per_block) log_flush_block();
 	}
 	else printf("Error: Logfile not open\r\n");
 }
 
 
+/*
+ * Log task
+ *
+ *  Writes the staged blocks to the logfile. Blocks that are
+ *  adjacent in the staging ring go in one multi-sector write,
+ *  straight to their sectors inside the preallocated run,
+ *  otherwise through the direct path of file_write_buf().
+ *  Blocks that could not be written stay staged and are tried
+ *  again on the next call. Returns false if a write failed.
+ *  Called from the main loop, away from the sample handling.
+ */
+bool log_task(void)
+{
+	uint16_t count;
+	uint16_t written;
+	uint8_t *buffer;
+	
+	if (!log_full) return true;
+	
+	// Full blocks up to the end of the ring
+	count = min(log_full, LOG_STAGE_BLOCKS - log_flush);
+	buffer = (uint8_t*)&log_stage[log_flush];
+	
+	if (log_lba_used + count <= log_lba_size)
+	{
+		// One multi-sector write into the run, the FAT is not touched
+		if (ram_2_memory_multi(fs_g_nav.u8_lun, log_lba + log_lba_used, count, buffer) == CTRL_GOOD)
+		{
+			written = count;
+		}
+		else
+		{
+			if (!log_write_errors++) printf("Error: Log write failed (sector %" PRIu32 ")\r\n", log_lba + log_lba_used);
+			written = 0;
+		}
+		log_lba_used += written;
+	}
+	else
+	{
+		// Past the preallocated run, append through the FAT
+		if (log_lba_size) log_sync_size();
+		written = file_write_buf(buffer, count * LOG_BLOCK_SIZE);
+		if (written != count * LOG_BLOCK_SIZE)
+		{
+			if (!log_write_errors++) printf("Error: Log write failed (err: %d)\r\n", fs_g_status);
+			
+			// Go back to the start of a partly written block
+			file_seek(written % LOG_BLOCK_SIZE, FS_SEEK_CUR_RE);
+		}
+		written /= LOG_BLOCK_SIZE;
+	}
+	
+	log_flush = (log_flush + written) % LOG_STAGE_BLOCKS;
+	log_full -= written;
+	
+	return written == count;
+}
+
+
+/*
+ * Log get stalls
+ *
+ *  Returns the number of times a block had to be written
+ *  while filling because all staged blocks were full
+ */
+uint32_t log_get_stalls(void)
+{
+	return log_stalls;
+}
+
+
+/*
+ * Log get lost blocks
+ *
+ *  Returns the number of blocks given up after failed writes
+ */
+uint32_t log_get_lost_blocks(void)
+{
+	return log_lost_blocks;
+}
+
+
 /*
  * Log Stop 
  *
- *  Closes the logfile
+ *  Writes the last (partial) block, closes the logfile
+ *  and gives the card back to the USB host
  */
 void log_stop(void)
 {
+	if (logfile_open)
+	{
+		// Stage pending records and write all staged blocks,
+		// a few tries before giving up on a failing card
+		uint8_t retry = 3;
+		if (log_stage[log_fill].data.nb_records) log_flush_block();
+		while (log_full && (log_task() || --retry)) { }
+		while (log_full) log_drop_block();
+		
+		// Fix up the file size and give back the unused part of the run
+		if (log_reserved)
+		{
+			if (log_lba_size) log_sync_size();
+			file_set_eof();
+			log_reserved = false;
+		}
+	}
+	
 	// Close logfile
 	file_close();
+	if (logfile_open) log_unlock();
 	logfile_open = false;
 }
 
@@ -162,16 +449,23 @@ void log_stop(void)
  */
 bool format_drive(void)
 {
-	// Reset navigator
-	reset_navigator();
+	bool formatted;
 	
-	// Format drive to FAT16
-	if (!nav_drive_format(FS_FORMAT_FAT))
+	// The card is shared with the USB host
+	if (!log_lock())
 	{
+		printf("Error: Card in use by the USB host\r\n");
 		return false;
 	}
-
-	return true;
+	
+	// Reset navigator
+	reset_navigator();
+	
+	// Format drive to FAT16
+	formatted = nav_drive_format(FS_FORMAT_FAT);
+	
+	log_unlock();
+	return formatted;
 }
 
 
@@ -179,15 +473,27 @@ bool format_drive(void)
  * Mount drive
  *
  *  Drive/disk mount with user friendly error messages.
- *  Returns a FAT error or 0 if mounting is successful.
+ *  Returns a FAT error, LOG_ERR_CARD_BUSY while the USB host
+ *  uses the card or 0 if mounting is successful.
  */
 uint8_t mount_drive(void)
 {
+	bool mounted;
+	
+	// The card is shared with the USB host
+	if (!log_lock())
+	{
+		printf("Error: Card in use by the USB host\r\n");
+		return LOG_ERR_CARD_BUSY;
+	}
+	
 	// Reset navigator
 	reset_navigator();
+	mounted = nav_partition_mount();
+	log_unlock();
 
-	// Try to mount, print error message if not
-	if (!nav_partition_mount())
+	// Print error message if not mounted
+	if (!mounted)
 	{
 		printf("Error: ");
 		
@@ -221,6 +527,179 @@ uint8_t mount_drive(void)
 }
 
 
+/*
+ * Get free space
+ *
+ *  Returns the number of free sectors on the drive, 0 on error.
+ *  The count kept by the FAT module is returned at once, the FAT
+ *  is only scanned again when the partition had to be mounted
+ *  (the first time and after the USB host used the card).
+ */
+uint32_t get_free_space(void)
+{
+	uint32_t free_space;
+	
+	if (logfile_open) return nav_partition_freespace();
+	
+	// The card is shared with the USB host
+	if (!log_lock()) return 0;
+	
+	free_space = (nav_partition_type() != FS_TYPE_FAT_UNM) ? nav_partition_freespace() : 0;
+	log_unlock();
+	return free_space;
+}
+
+
+/*
+ * Check free space
+ *
+ *  Counts the free clusters with a scan of the whole FAT and
+ *  compares with the count kept by the FAT module, a wrong count
+ *  is corrected. Returns false if it was wrong or on error.
+ */
+bool check_free_space(void)
+{
+	bool ok;
+	
+	// The card is shared with the USB host
+	if (!log_lock()) return false;
+	
+	ok = (nav_partition_type() != FS_TYPE_FAT_UNM) && nav_partition_freespace_verify();
+	log_unlock();
+	return ok;
+}
+
+
+/*
+ * CRC-16/CCITT
+ *
+ *  Computes the block CRC (poly 0x1021, init 0xFFFF), the
+ *  live sample stream uses it as well
+ */
+uint16_t log_crc16(const void *data, uint16_t len)
+{
+	const uint8_t *byte = data;
+	uint16_t crc = 0xFFFF;
+	
+	while (len--)
+	{
+		crc ^= (uint16_t)*byte++ << 8;
+		for (uint8_t i = 0; i < 8; i++)
+		{
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	
+	return crc;
+}
+
+
+/*
+ * Log seal block
+ *
+ *  Adds the CRC to the block being filled, marks it full and
+ *  moves on to the next block. If that one is still full it
+ *  is written right away, this counts as a stall. If it can
+ *  not be written, it is dropped to make room.
+ */
+static void log_seal_block(void)
+{
+	log_stage_t *stage = &log_stage[log_fill];
+	
+	stage->data.crc = log_crc16(stage, offsetof(log_block_t, crc));
+	log_full++;
+	log_fill = (log_fill + 1) % LOG_STAGE_BLOCKS;
+	
+	if (log_full == LOG_STAGE_BLOCKS)
+	{
+		log_stalls++;
+		if (!log_task() && log_full == LOG_STAGE_BLOCKS) log_drop_block();
+	}
+	
+	log_stage[log_fill].data.nb_records = 0;
+}
+
+
+/*
+ * Log flush block
+ *
+ *  Stages the current data block and starts the next one
+ */
+static void log_flush_block(void)
+{
+	log_block_t *block = &log_stage[log_fill].data;
+	uint16_t used = block->nb_records * log_nb_values;
+	
+	// Clear unused values
+	memset(&block->values[used], 0, (LOG_BLOCK_VALUES - used) * sizeof(uint16_t));
+	
+	block->magic = LOG_BLOCK_MAGIC;
+	block->sequence = log_sequence++;
+	log_seal_block();
+}
+
+
+/*
+ * Log drop block
+ *
+ *  Gives up the oldest staged block. The next block is written
+ *  in its place, the gap in the sequence numbers shows the loss.
+ */
+static void log_drop_block(void)
+{
+	log_flush = (log_flush + 1) % LOG_STAGE_BLOCKS;
+	log_full--;
+	log_lost_blocks++;
+}
+
+
+/*
+ * Log sync size
+ *
+ *  Makes the file size (written to the directory entry on
+ *  close) cover the sectors written in the preallocated run,
+ *  and ends the run.
+ */
+static void log_sync_size(void)
+{
+	fs_g_nav_entry.u32_size = log_base_size + log_lba_used * FS_512B;
+	fs_g_nav_entry.u32_pos_in_file = fs_g_nav_entry.u32_size;
+	log_lba_size = 0;
+	log_lba_used = 0;
+}
+
+
+/*
+ * Lock card
+ *
+ *  Takes the card from the USB host. The FAT navigator is reset
+ *  (the partition mounted again) only if the host used the card
+ *  since this module gave it back, so the FAT module keeps its
+ *  free space count and cluster caches otherwise.
+ */
+static bool log_lock(void)
+{
+	uint32_t nb_locks = ctrl_access_get_nb_locks();
+	
+	if (!ctrl_access_lock()) return false;
+	if (nb_locks != log_nb_locks) reset_navigator();
+	
+	return true;
+}
+
+
+/*
+ * Unlock card
+ *
+ *  Gives the card back to the USB host
+ */
+static void log_unlock(void)
+{
+	log_nb_locks = ctrl_access_get_nb_locks();
+	ctrl_access_unlock();
+}
+
+
 /*
  * Reset FAT navigator 
  *
@@ -9,33 +9,109 @@
 
 
 
+/***** Log file format *****
+ *
+ *  The logfile is a sequence of 512 byte blocks, all fields
+ *  are big-endian (AVR32 native). Each logging session starts
+ *  with a header block, followed by data blocks. Both end with
+ *  a CRC-16/CCITT (poly 0x1021, init 0xFFFF) of bytes 0-509.
+ *
+ *  A data block holds nb_records frames, one value per scanned
+ *  channel, taken one clock_period apart starting at first_frame.
+ *  Frame n was sampled at n * clock_period / clock_hz seconds.
+ *  Blocks with an unknown magic (e.g. padding) are skipped.
+ */
+
+// Block size, equal to the sector size
+#define LOG_BLOCK_SIZE    512
+
+// Header block magic and format version
+#define LOG_MAGIC         "ADCLOG"
+#define LOG_VERSION       1
+
+// Data block magic
+#define LOG_BLOCK_MAGIC   0xADDA
+
+// Values in a data block
+#define LOG_BLOCK_VALUES  ((LOG_BLOCK_SIZE - 14) / 2)
+
+// Header block
+typedef struct {
+	char     magic[8];         // LOG_MAGIC
+	uint16_t version;          // LOG_VERSION
+	uint16_t block_size;       // LOG_BLOCK_SIZE
+	uint32_t sample_freq;      // Frames per second (rounded)
+	uint32_t clock_hz;         // Timestamp clock
+	uint32_t clock_period;     // Clock periods between frames
+	uint8_t  channels;         // Scanned ADC channels (bit mask)
+	uint8_t  nb_channels;      // Values per frame, ascending channel order
+	uint8_t  adc_bits;         // ADC resolution
+	uint8_t  reserved[LOG_BLOCK_SIZE - 29];
+	uint16_t crc;
+} log_header_t;
+
+// Data block
+typedef struct {
+	uint16_t magic;            // LOG_BLOCK_MAGIC
+	uint16_t nb_records;       // Frames in this block
+	uint32_t sequence;         // Block number since the header
+	uint32_t first_frame;      // Frame number of the first record
+	uint16_t values[LOG_BLOCK_VALUES];
+	uint16_t crc;
+} log_block_t;
+
+
 /***** Log commands *****/
 
 // Initiates log functionality 
 bool log_init(uint8_t slot);
 
-// Selects/create logfile
-void log_set_file(char *filename);
+// Selects/create logfile, false while the USB host uses the card
+bool log_set_file(char *filename);
+
+// Opens logfile and writes the header block
+bool log_start(uint8_t channels, uint32_t clock_hz, uint32_t clock_period);
+
+// Reserves contiguous sectors for the logfile, call after log_start
+bool log_preallocate(uint32_t size);
 
-// Opens logfile
-bool log_start(void);
+// Writes a frame of ADC values (one per channel) to logfile
+void log_write_frame(uint32_t frame, const uint16_t *values);
 
-// Writes int value to logfile
-void log_write_adc(uint32_t cy_count, uint16_t value);
+// Writes staged blocks to logfile, call from the main loop
+bool log_task(void);
 
-// Closes logfile
+// Returns the number of times all staged blocks were full
+uint32_t log_get_stalls(void);
+
+// Returns the number of blocks lost after failed writes
+uint32_t log_get_lost_blocks(void);
+
+// Writes the last block and closes logfile
 void log_stop(void);
 
 
 
 /***** FAT/drive utils *****/
 
+// mount_drive() status while the USB host uses the card, not a FAT error
+#define LOG_ERR_CARD_BUSY  (FAIL+64)
+
 // Formats drive
 bool format_drive(void);
 
 // Mounts drive with error messages
 uint8_t mount_drive(void);
 
+// Returns the free space of drive in sectors
+uint32_t get_free_space(void);
+
+// Verifies the free space count with a scan of the FAT
+bool check_free_space(void);
+
+// Returns the CRC-16/CCITT of data, as used in the logfile
+uint16_t log_crc16(const void *data, uint16_t len);
+
 
 
 #endif /* LOG_H_ */
\ No newline at end of file
@@ -7,18 +7,22 @@
  *   This application demonstrates how to write ADC values to
  *   a logfile on a SD/MMC card periodically using interrupts.
  *   It provides a simplistic CLI over USB to set the logfile, 
- *   format the disk and start/stop logging.
+ *   format the disk and start/stop logging. The card is also
+ *   exposed as a USB mass storage device to read the logs, or
+ *   (APP_STREAM_CDC) a second CDC port streams the samples live.
  *
- *   SD/MMC (SPI), ADC, TC, FAT, USB (STDIO), Delay routines
+ *   SD/MMC (SPI), ADC, TC, FAT, USB (STDIO, MSC), Delay routines
  *
  *   Atmel Studio 7.0 / ASF 3.30.1
  *
  */
 #include <asf.h>
 #include <inttypes.h>
+#include <stdlib.h>
 #include "app.h"
 #include "log.h"
 #include "cli.h"
+#include "stream.h"
 #include "conf_app.h"
 
 
@@ -40,90 +44,93 @@ volatile uint64_t app_log_count = 0;
 // Filename pointer
 volatile char *app_logfile;
 
-// Read and save ADC flag
-volatile bool update_adc_to_log = false;
-
 
 
 /*****  FUNCTIONS  ****************************************************/
 
 /*
- * Update ADC value to logfile
+ * Update ADC values to logfile
  *
- *  This function update the logfile with a new ADC value if
- *  the update flag is set to true.
+ *  This function writes the frames of every buffer completed
+ *  by the PDCA to the logfile (when logging) and the sample
+ *  stream, and gives the buffer back to the sample ring.
  */
 static void app_update_adc_task(void)
 {
-	// Check if update flag is true
-	if (update_adc_to_log)
+	const uint16_t *frame;
+	uint16_t frames;
+	uint32_t first;
+	uint8_t nb_channels = app_adc_get_nb_channels();
+
+	// Buffers are read in the order they were completed
+	while ((frame = app_adc_read(&frames, &first)) != NULL)
 	{
-		// Begin ADC reading
-		adc_start(&AVR32_ADC);
+#if APP_STREAM_CDC
+		// One stream packet per buffer, whether logging or not
+		stream_write_frames(first, frame, frames, app_adc_get_channels(), nb_channels);
+#endif
+		
+		if (app_mode == APP_MODE_LOGGING)
+		{
+			for (uint16_t i = 0; i < frames; i++, frame += nb_channels)
+			{
+				// Log ADC values, the frame number gives the timestamp
+				log_write_frame(first + i, frame);
 
-		// Read new value
-		uint16_t adc_value = adc_get_value(&AVR32_ADC, APP_ADC_POT_CHANNEL);
-	
-		// Get the cycle count for reading
-		uint32_t cycle_count = (uint32_t)Get_sys_count();
+				// Count entries
+				app_log_count++;
 
-		// Log ADC value
-		log_write_adc(cycle_count, adc_value);
-	
-		// Count entries
-		app_log_count++;
+				// Toggle LED6 to indicate logging (once per second)
+				if (!(app_log_count % APP_ADC_SAMPLE_FREQ)) LED_Toggle(LED6);
+			}
+		}
 
-		// Toggle LED6 to indicate logging
-		if (!(app_log_count % 50)) LED_Toggle(LED6);
-		
-		// Reset ADC update flag
-		update_adc_to_log = false;
+		// Give the buffer back to the PDCA
+		app_adc_release();
 	}
 }
 
 
 /*
- * ADC/Pot reading interrupt handler
- *
- *  This interrupt handler is triggered by the timer/counter.
- *
- *  There are usually two common ways to execute routines
- *  from an interrupt. 
- *    1) run the routines directly from the interrupt
- *    2) run the routines indirectly in the main while loop
+ * ADC buffer complete handler
  *
- *  The latter one is used here since one usually wants to
- *  keep the interrupt cycles to a minimum. And ADC reading 
- *  and log writing can in theory cause unexpected delays. 
- *  But both options have been tested without any
- *  noticeable performance differences.
+ *  Called from the PDCA interrupt every APP_ADC_BUFFER_SIZE
+ *  samples, the buffer itself is read by app_update_adc_task()
+ *  from the main while loop to keep the interrupt short.
  */
-__attribute__((__interrupt__))
-static void tc_read_pot_irq(void)
+static void app_adc_buffer_done(pdca_stream_t *stream, void *buffer)
 {
-	// Clear the interrupt flag.
-	tc_read_sr(APP_TC, APP_TC_CHANNEL);
+	// Let the SD card finish programming the last block
+	// without the main loop having to wait for it
+	sd_mmc_spi_async_task();
 	
-	// Check if logging is on
-	if (app_mode == APP_MODE_LOGGING)
-	{
-		// 2) Run ADC update from main while loop
-		update_adc_to_log = true;
-		
-		// 1) Run the ADC update directly from interrupt
-		//app_update_adc_task();	
-	}
-	
-	// Toggle LED0 as a timer interval indicator
+	// Toggle LED0 as a sampling indicator
 	LED_Toggle(LED0);
 }
 
 
+/*
+ * Print USB endpoint statistics
+ *
+ *  Prints the throughput of a bulk endpoint over the last
+ *  second and the gaps between its transfers, that show
+ *  when the class did not keep the endpoint busy.
+ */
+static void app_print_ep_stat(const char *name, udd_ep_id_t ep)
+{
+	udd_ep_stat_t stat;
+
+	if (!udd_ep_get_stat(ep, &stat)) return;
+	printf("%s %" PRIu32 " B/s (gaps: %" PRIu32 ", avg %" PRIu32 " us, max %" PRIu32 " us)\r\n", name,
+			stat.bytes_per_s, stat.nb_gaps, stat.nb_gaps ? stat.gap_us / stat.nb_gaps : 0, stat.max_gap_us);
+}
+
+
 /*
  * Interrupt configuration
  *
  *  This function initializes the interrupts handlers and
- *  vectors for USB and Timer/Counter driver
+ *  vectors for USB, the ADC stream registers its own handler
  */
 static void app_interrupt_init(void)
 {
@@ -135,9 +142,6 @@ static void app_interrupt_init(void)
 
 	// Initialize interrupt vectors.
 	INTC_init_interrupts();
-	
-	// Register the Timer/Counter (pot reading) int handler
-	INTC_register_interrupt(&tc_read_pot_irq, APP_TC_IRQ, APP_TC_IRQ_PRIORITY);
 
 	// Enable the interrupts
 	cpu_irq_enable();
@@ -171,7 +175,7 @@ int main (void)
 	stdio_usb_enable();
 
 	// Initiate SD/MMC SPI, ADC and Timer/Counter drivers
-	app_init();
+	app_init(&app_adc_buffer_done);
 	
 	// In some rare cases the terminal wont display the
 	// first lines of text, this delay helps to prevent that
@@ -191,7 +195,7 @@ int main (void)
 		while (!sd_mmc_spi_mem_check()) { /* wait for card */ }
 	}
 	sd_mmc_spi_get_capacity(); // Read Card capacity
-	printf("Card detected (%u MB)", (uint16_t)(capacity >> 20));
+	printf("Card detected (%u MB, SPI %" PRIu32 " kHz)", (uint16_t)(capacity >> 20), sd_mmc_spi_get_clock() / 1000);
 	
 	
 	// Initiate logging
@@ -210,13 +214,28 @@ int main (void)
 	printf("\r\n" CLI_HELP_TEXT ">");
 		
 	
+	// ADC frame time base, written to the log header
+	uint32_t clock_hz, clock_period;
+	app_adc_get_clock(&clock_hz, &clock_period);
+	
+	
 	// Main loop waiting for commands
 	while(true)
 	{
-		// Writes value to log if flag is set to true
-		// See interrupt comment for more
+		// Writes completed ADC buffers to the log
 		app_update_adc_task();
 		
+		// Writes full log blocks to the card
+		log_task();
+		
+#if APP_STREAM_CDC
+		// Sends the sample stream to the host
+		stream_task();
+#else
+		// USB mass storage task, serves the host while not logging
+		udi_msc_process_trans();
+#endif
+		
 		// CLI task, reads user input
 		cli_task();
 		
@@ -225,8 +244,11 @@ int main (void)
 			// Command: start
 			case CLI_CMD_START:
 			if (app_mode == APP_MODE_LOGGING) printf("Logging is already running");
-			else if (log_start())
+			else if (log_start(app_adc_get_channels(), clock_hz, clock_period))
 			{
+				// Reserve contiguous space, writes past it go through the FAT
+				if (!log_preallocate(APP_LOG_PREALLOCATE)) printf("Warning: No space preallocated (err: %d)\r\n", fs_g_status);
+				
 				app_mode = APP_MODE_LOGGING;
 				printf("Logging started (file: %s)\r\n", app_logfile);
 			}
@@ -252,6 +274,26 @@ int main (void)
 			printf("Logging:    %s\r\n", (app_mode == APP_MODE_LOGGING ? "ON" : "OFF"));
 			printf("Filename:   %s\r\n", app_logfile);
 			printf("Log count:  %" PRIu64 "\r\n", app_log_count);
+			printf("Log stalls: %" PRIu32 " (blocks lost: %" PRIu32 ")\r\n", log_get_stalls(), log_get_lost_blocks());
+			printf("Free space: %" PRIu32 " KB\r\n", get_free_space() / 2);
+			printf("Channels:   0x%02x\r\n", app_adc_get_channels());
+			printf("Sampling:   %u Hz (overruns: %" PRIu32 ", frames lost: %" PRIu32 ")\r\n", APP_ADC_SAMPLE_FREQ,
+					app_adc_stream.overruns, app_adc_get_lost_frames());
+			printf("ADC queue:  %u/%u max (overflows: %" PRIu32 ")\r\n", app_adc_events.high_water, app_adc_events.size, app_adc_events.overflows);
+			printf("USB output: %" PRIu32 " chars dropped\r\n", stdio_usb_get_dropped());
+			printf("FAT cache:  %" PRIu32 " hits, %" PRIu32 " misses, %" PRIu32 " evictions, %" PRIu32 " writes\r\n",
+					fs_g_sectorcache_stat.u32_hit, fs_g_sectorcache_stat.u32_miss,
+					fs_g_sectorcache_stat.u32_eviction, fs_g_sectorcache_stat.u32_writeback);
+			app_print_ep_stat("USB CDC IN:", UDI_CDC_DATA_EP_IN_0);
+#if APP_STREAM_CDC
+			stream_stat_t stream;
+			stream_get_stat(&stream);
+			printf("Stream:     %s, %" PRIu32 " packets (drops: %" PRIu32 ", %" PRIu32 " bytes)\r\n",
+					stream.open ? "open" : "closed", stream.packets, stream.drops, stream.bytes);
+			app_print_ep_stat("USB stream IN:", UDI_CDC_DATA_EP_IN_1);
+#else
+			app_print_ep_stat("USB MSC IN:", UDI_MSC_EP_IN);
+#endif
 			printf("\r\n>");
 			break;
 			
@@ -269,16 +311,45 @@ int main (void)
 			printf("\r\n>");
 			break;
 			
+			// Command: check
+			case CLI_CMD_CHECK:
+			if (app_mode != APP_MODE_WAITING) printf("Stop logging first\r\n");
+			else if (check_free_space()) printf("Free space count OK\r\n");
+			else if (fs_g_status == FS_ERR_FS) printf("Free space count was wrong, corrected\r\n");
+			else printf("Error: Could not check free space (err: %d)\r\n", fs_g_status);
+			printf("\r\n>");
+			break;
+			
 			// Command: file <filename>
 			case CLI_CMD_FILE:
 			if (app_mode != APP_MODE_WAITING) break;
 			app_logfile = cli_get_argument();
-			log_set_file((char*)app_logfile);
+			if (log_set_file((char*)app_logfile)) printf("Logfile set to: \"%s\"\r\n", app_logfile);
+			else printf("Logfile set to: \"%s\" (created when logging starts)\r\n", app_logfile);
 			app_log_count = 0;
-			printf("Logfile set to: \"%s\"\r\n", app_logfile);
 			printf("\r\n>");
 			break;
 			
+			// Command: channels <mask>
+			case CLI_CMD_CHANNELS:
+			{
+				char *end;
+				unsigned long mask = strtoul(cli_get_argument(), &end, 0);
+				
+				if (app_mode != APP_MODE_WAITING) printf("Stop logging first\r\n");
+				else if (end == cli_get_argument() || *end != '\0' || mask > 0xFF)
+				{
+					printf("Invalid channel mask \"%s\" (0x00 to 0xff)\r\n", cli_get_argument());
+				}
+				else if (app_adc_set_channels((uint8_t)mask))
+				{
+					printf("Channels set to: 0x%02x\r\n", app_adc_get_channels());
+				}
+				else printf("Invalid channel mask\r\n");
+				printf("\r\n>");
+			}
+			break;
+			
 			// Command: help
 			case CLI_CMD_HELP:
 			printf(CLI_HELP_TEXT ">");
@@ -0,0 +1,196 @@
+/**
+ * Name         : stream.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Live ADC sample stream on the second USB CDC port
+ */
+#include <asf.h>
+#include <string.h>
+#include "stream.h"
+#include "log.h"
+#include "conf_app.h"
+
+#if APP_STREAM_CDC
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Largest packet, a full ADC buffer
+#define STREAM_PACKET_SIZE   (sizeof(stream_header_t) + APP_ADC_BUFFER_SIZE * 2 + 2)
+
+// Largest encoded packet, one code byte per 254 bytes and the delimiter
+#define STREAM_ENCODED_SIZE  (STREAM_PACKET_SIZE + STREAM_PACKET_SIZE / 254 + 2)
+
+
+
+/*****  VARIABLES  ****************************************************/
+
+// The host holds DTR of the stream port (set from the USB interrupt)
+static volatile bool stream_open;
+
+// Packet being built and its encoded form
+static uint8_t stream_packet[STREAM_PACKET_SIZE] COMPILER_WORD_ALIGNED;
+static uint8_t stream_encoded[STREAM_ENCODED_SIZE];
+
+// Encoded packets waiting for the CDC port, the indexes run
+// freely and are masked on access
+static uint8_t stream_buffer[APP_STREAM_BUFFER_SIZE];
+static uint16_t stream_head;
+static uint16_t stream_tail;
+
+// Next packet number and statistics
+static uint32_t stream_sequence;
+static stream_stat_t stream_stat;
+
+
+
+/*****  PRIVATE PROTOTYPES  *******************************************/
+
+static uint16_t stream_cobs_encode(const uint8_t *src, uint16_t len, uint8_t *dst);
+
+
+
+/*****  FUNCTIONS  ****************************************************/
+
+/*
+ * Stream set DTR
+ *
+ *  Called from the USB interrupt when the host opens or closes
+ *  a CDC port, packets are only queued while the stream port
+ *  is open.
+ */
+void stream_set_dtr(uint8_t port, bool b_enable)
+{
+	if (port == APP_STREAM_PORT) stream_open = b_enable;
+}
+
+
+/*
+ * Stream write frames
+ *
+ *  Builds the packet of one ADC buffer and queues it encoded.
+ *  The packet is dropped (and counted) if it does not fit the
+ *  queue, the sequence number shows the gap to the host.
+ */
+void stream_write_frames(uint32_t first_frame, const uint16_t *values, uint16_t frames, uint8_t channels, uint8_t nb_channels)
+{
+	stream_header_t *header = (stream_header_t *)stream_packet;
+	uint16_t size = frames * nb_channels * 2;
+	uint16_t len, pos, chunk;
+	uint16_t crc;
+	
+	if (!stream_open)
+	{
+		// Nothing stale is sent when the port is opened again
+		stream_tail = stream_head;
+		return;
+	}
+	
+	header->type = STREAM_TYPE_SAMPLES;
+	header->channels = channels;
+	header->nb_frames = frames;
+	header->sequence = stream_sequence++;
+	header->first_frame = first_frame;
+	memcpy(header + 1, values, size);
+	size += sizeof(stream_header_t);
+	crc = log_crc16(stream_packet, size);
+	stream_packet[size++] = crc >> 8;
+	stream_packet[size++] = crc;
+	
+	len = stream_cobs_encode(stream_packet, size, stream_encoded);
+	if (APP_STREAM_BUFFER_SIZE - (uint16_t)(stream_head - stream_tail) < len)
+	{
+		stream_stat.drops++;
+		return;
+	}
+	
+	// Copy around the end of the queue
+	pos = stream_head & (APP_STREAM_BUFFER_SIZE - 1);
+	chunk = min(len, APP_STREAM_BUFFER_SIZE - pos);
+	memcpy(&stream_buffer[pos], stream_encoded, chunk);
+	memcpy(stream_buffer, &stream_encoded[chunk], len - chunk);
+	stream_head += len;
+	stream_stat.packets++;
+}
+
+
+/*
+ * Stream task
+ *
+ *  Hands as much of the queue to the CDC port as its buffer
+ *  takes now, without waiting for the host.
+ */
+void stream_task(void)
+{
+	iram_size_t free, chunk;
+	uint16_t count, pos;
+	
+	count = stream_head - stream_tail;
+	free = udi_cdc_multi_get_free_tx_buffer(APP_STREAM_PORT);
+	while (count && free)
+	{
+		pos = stream_tail & (APP_STREAM_BUFFER_SIZE - 1);
+		chunk = min(count, APP_STREAM_BUFFER_SIZE - pos);
+		chunk = min(chunk, free);
+		
+		udi_cdc_multi_write_buf(APP_STREAM_PORT, &stream_buffer[pos], chunk);
+		stream_tail += chunk;
+		stream_stat.bytes += chunk;
+		count -= chunk;
+		free = udi_cdc_multi_get_free_tx_buffer(APP_STREAM_PORT);
+	}
+}
+
+
+/*
+ * Stream get statistics
+ *
+ *  Throughput on the bus is given by the endpoint statistics
+ *  of UDI_CDC_DATA_EP_IN_1.
+ */
+void stream_get_stat(stream_stat_t *stat)
+{
+	*stat = stream_stat;
+	stat->open = stream_open;
+}
+
+
+/*****  PRIVATE FUNCTIONS  ********************************************/
+
+/*
+ * COBS encode
+ *
+ *  Consistent overhead byte stuffing, removes every 0x00 from
+ *  the packet so that a 0x00 delimits it. Returns the encoded
+ *  length, delimiter included.
+ */
+static uint16_t stream_cobs_encode(const uint8_t *src, uint16_t len, uint8_t *dst)
+{
+	uint8_t *start = dst;
+	uint8_t *code = dst++;
+	uint8_t n = 1;
+	
+	while (len--)
+	{
+		if (*src)
+		{
+			*dst++ = *src;
+			n++;
+		}
+		if (!*src++ || n == 0xFF)
+		{
+			// Close the block, a new one starts after it
+			*code = n;
+			code = dst++;
+			n = 1;
+		}
+	}
+	*code = n;
+	*dst++ = 0x00;
+	
+	return dst - start;
+}
+
+
+#endif /* APP_STREAM_CDC */
@@ -0,0 +1,63 @@
+/**
+ * Name         : stream.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Live ADC sample stream on the second USB CDC port
+ */
+#ifndef STREAM_H_
+#define STREAM_H_
+
+
+
+/***** Stream format *****
+ *
+ *  While the host holds DTR of the stream port, every ADC buffer
+ *  is sent as one COBS encoded packet ending with a 0x00 byte.
+ *  A decoded packet is a stream_header_t, nb_frames frames of
+ *  one value per scanned channel and a CRC-16/CCITT of the bytes
+ *  before it (as in the logfile). All fields are big-endian.
+ *
+ *  sequence counts every packet, including the ones dropped
+ *  because the host did not read fast enough, so a gap in it
+ *  tells how many packets were lost. first_frame gives the time
+ *  base, as in the log data blocks.
+ */
+
+// Packet type of a sample packet
+#define STREAM_TYPE_SAMPLES  1
+
+// Packet header
+typedef struct {
+	uint8_t  type;             // STREAM_TYPE_SAMPLES
+	uint8_t  channels;         // Scanned ADC channels (bit mask)
+	uint16_t nb_frames;        // Frames in this packet
+	uint32_t sequence;         // Packet number
+	uint32_t first_frame;      // Frame number of the first frame
+} stream_header_t;
+
+// Stream statistics
+typedef struct {
+	bool     open;             // The host holds DTR
+	uint32_t packets;          // Packets queued
+	uint32_t drops;            // Packets dropped, the queue was full
+	uint32_t bytes;            // Encoded bytes handed to the CDC port
+} stream_stat_t;
+
+
+/***** Stream commands *****/
+
+// Opens/closes the stream, DTR callback of the CDC ports
+void stream_set_dtr(uint8_t port, bool b_enable);
+
+// Queues a buffer of frames (one value per channel) as one packet
+void stream_write_frames(uint32_t first_frame, const uint16_t *values, uint16_t frames, uint8_t channels, uint8_t nb_channels);
+
+// Hands queued packets to the CDC port, call from the main loop
+void stream_task(void);
+
+// Returns the stream statistics
+void stream_get_stat(stream_stat_t *stat);
+
+
+
+#endif /* STREAM_H_ */
@@ -0,0 +1,66 @@
+/**
+ * Name         : fat_image.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Reads the FAT of the mounted partition straight from the
+ *                disk image, to check the FAT module against it
+ */
+#include <string.h>
+#include "image_mem.h"
+#include "fat_image.h"
+
+
+
+/*****  FUNCTIONS  ****************************************************/
+
+void fat_image_mount(uint32_t nb_sector)
+{
+	image_mem_create(nb_sector);
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_drive_format(FS_FORMAT_FAT));
+	assert(nav_partition_mount());
+}
+
+uint32_t fat_image_entry(uint8_t fat, uint32_t cluster)
+{
+	const uint8_t *table = image_mem
+			+ (fs_g_nav.u32_ptr_fat + fat * fs_g_nav.u32_fat_size) * FS_512B;
+	uint32_t offset;
+	uint16_t value;
+
+	assert(cluster < fs_g_nav.u32_CountofCluster);
+
+	switch (fs_g_nav_fast.u8_type_fat)
+	{
+		case FS_TYPE_FAT_12:
+		offset = cluster + cluster / 2;
+		value = table[offset] | (table[offset + 1] << 8);
+		return (cluster & 1) ? value >> 4 : value & 0x0FFF;
+		case FS_TYPE_FAT_16:
+		return table[cluster * 2] | (table[cluster * 2 + 1] << 8);
+		default:
+		offset = cluster * 4;
+		return (table[offset] | (table[offset + 1] << 8) | (table[offset + 2] << 16)
+				| ((uint32_t)table[offset + 3] << 24)) & 0x0FFFFFFF;
+	}
+}
+
+uint32_t fat_image_free_clusters(void)
+{
+	uint32_t nb_free = 0;
+	uint32_t cluster;
+
+	for (cluster = 2; cluster < fs_g_nav.u32_CountofCluster; cluster++)
+	{
+		if (!fat_image_entry(0, cluster)) nb_free++;
+	}
+	return nb_free;
+}
+
+bool fat_image_fats_equal(void)
+{
+	const uint8_t *fat1 = image_mem + fs_g_nav.u32_ptr_fat * FS_512B;
+
+	return !memcmp(fat1, fat1 + fs_g_nav.u32_fat_size * FS_512B, fs_g_nav.u32_fat_size * FS_512B);
+}
@@ -0,0 +1,27 @@
+/**
+ * Name         : fat_image.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Reads the FAT of the mounted partition straight from the
+ *                disk image, to check the FAT module against it
+ */
+#ifndef FAT_IMAGE_H_
+#define FAT_IMAGE_H_
+
+#include <asf.h>
+
+
+// Formats a disk image of nb_sector sectors and mounts it
+void fat_image_mount(uint32_t nb_sector);
+
+// Returns the value of a cluster in FAT1 (fat 0) or FAT2 (fat 1)
+uint32_t fat_image_entry(uint8_t fat, uint32_t cluster);
+
+// Counts the free clusters of FAT1
+uint32_t fat_image_free_clusters(void);
+
+// Compares FAT1 and FAT2, true if equal
+bool fat_image_fats_equal(void);
+
+
+#endif /* FAT_IMAGE_H_ */
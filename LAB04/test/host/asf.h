@@ -0,0 +1,24 @@
+/**
+ * Name         : asf.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host stand-in for the ASF API include file, only the
+ *                services the tested modules use
+ */
+#ifndef HOST_ASF_H_
+#define HOST_ASF_H_
+
+#include <stdio.h>
+#include <compiler.h>
+#include <ctrl_access.h>
+#include <fat.h>
+#include <file.h>
+#include <fs_com.h>
+#include <navigation.h>
+#include <udi_cdc.h>
+
+// ADC resolution of the UC3A0 (10 bits)
+#define ADC_MAX_VALUE	0x3FF
+
+
+#endif /* HOST_ASF_H_ */
@@ -0,0 +1,147 @@
+/**
+ * Name         : io.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host stand-in for the AVR32 part header, the SPI module
+ *                only. The registers live in the trapped page of the SPI
+ *                model (spi_model.h), so each access reaches the model.
+ *                Bit-fields are declared LSB first for the host.
+ */
+#ifndef HOST_AVR32_IO_H_
+#define HOST_AVR32_IO_H_
+
+#include <stdint.h>
+
+
+/*****  SPI  **********************************************************/
+
+#define AVR32_SPI_CR_SPIEN_MASK			0x00000001
+#define AVR32_SPI_CR_SPIDIS_MASK		0x00000002
+#define AVR32_SPI_CR_SWRST_MASK			0x00000080
+#define AVR32_SPI_CR_LASTXFER_MASK		0x01000000
+
+#define AVR32_SPI_MR_MSTR_MASK			0x00000001
+#define AVR32_SPI_MR_PS_MASK			0x00000002
+#define AVR32_SPI_MR_PCSDEC_MASK		0x00000004
+#define AVR32_SPI_MR_MODFDIS_MASK		0x00000010
+#define AVR32_SPI_MR_LLB_MASK			0x00000080
+#define AVR32_SPI_MR_PCS_MASK			0x000F0000
+#define AVR32_SPI_MR_PCS_OFFSET			16
+#define AVR32_SPI_MR_PCS_SIZE			4
+
+#define AVR32_SPI_RDR_RD_MASK			0x0000FFFF
+#define AVR32_SPI_RDR_RD_OFFSET			0
+
+#define AVR32_SPI_TDR_TD_MASK			0x0000FFFF
+#define AVR32_SPI_TDR_TD_OFFSET			0
+#define AVR32_SPI_TDR_PCS_OFFSET		16
+#define AVR32_SPI_TDR_LASTXFER_OFFSET	24
+
+#define AVR32_SPI_SR_RDRF_MASK			0x00000001
+#define AVR32_SPI_SR_TDRE_MASK			0x00000002
+#define AVR32_SPI_SR_MODF_MASK			0x00000004
+#define AVR32_SPI_SR_OVRES_MASK			0x00000008
+#define AVR32_SPI_SR_TXEMPTY_MASK		0x00000200
+#define AVR32_SPI_SR_SPIENS_MASK		0x00010000
+
+#define AVR32_SPI_CSR0_CPOL_OFFSET		0
+#define AVR32_SPI_CSR0_NCPHA_OFFSET		1
+#define AVR32_SPI_CSR0_CSAAT_OFFSET		3
+#define AVR32_SPI_CSR0_BITS_MASK		0x000000F0
+#define AVR32_SPI_CSR0_BITS_OFFSET		4
+#define AVR32_SPI_CSR0_SCBR_MASK		0x0000FF00
+#define AVR32_SPI_CSR0_SCBR_OFFSET		8
+
+typedef struct avr32_spi_cr_t {
+	unsigned int spien		: 1;
+	unsigned int spidis		: 1;
+	unsigned int			: 5;
+	unsigned int swrst		: 1;
+	unsigned int			: 16;
+	unsigned int lastxfer	: 1;
+	unsigned int			: 7;
+} avr32_spi_cr_t;
+
+typedef struct avr32_spi_mr_t {
+	unsigned int mstr		: 1;
+	unsigned int ps			: 1;
+	unsigned int pcsdec		: 1;
+	unsigned int			: 1;
+	unsigned int modfdis	: 1;
+	unsigned int			: 2;
+	unsigned int llb		: 1;
+	unsigned int			: 8;
+	unsigned int pcs		: 4;
+	unsigned int			: 4;
+	unsigned int dlybcs		: 8;
+} avr32_spi_mr_t;
+
+typedef struct avr32_spi_rdr_t {
+	unsigned int rd			: 16;
+	unsigned int pcs		: 4;
+	unsigned int			: 12;
+} avr32_spi_rdr_t;
+
+typedef struct avr32_spi_tdr_t {
+	unsigned int td			: 16;
+	unsigned int pcs		: 4;
+	unsigned int			: 4;
+	unsigned int lastxfer	: 1;
+	unsigned int			: 7;
+} avr32_spi_tdr_t;
+
+typedef struct avr32_spi_sr_t {
+	unsigned int rdrf		: 1;
+	unsigned int tdre		: 1;
+	unsigned int modf		: 1;
+	unsigned int ovres		: 1;
+	unsigned int			: 5;
+	unsigned int txempty	: 1;
+	unsigned int			: 6;
+	unsigned int spiens		: 1;
+	unsigned int			: 15;
+} avr32_spi_sr_t;
+
+typedef avr32_spi_sr_t avr32_spi_ier_t;
+typedef avr32_spi_sr_t avr32_spi_idr_t;
+typedef avr32_spi_sr_t avr32_spi_imr_t;
+
+typedef struct avr32_spi_csr0_t {
+	unsigned int cpol		: 1;
+	unsigned int ncpha		: 1;
+	unsigned int			: 1;
+	unsigned int csaat		: 1;
+	unsigned int bits		: 4;
+	unsigned int scbr		: 8;
+	unsigned int dlybs		: 8;
+	unsigned int dlybct		: 8;
+} avr32_spi_csr0_t;
+
+typedef avr32_spi_csr0_t avr32_spi_csr1_t;
+typedef avr32_spi_csr0_t avr32_spi_csr2_t;
+typedef avr32_spi_csr0_t avr32_spi_csr3_t;
+
+// Register map of the SPI module, 32-bit registers
+typedef struct avr32_spi_t {
+	union { uint32_t cr;			avr32_spi_cr_t		CR;		};
+	union { uint32_t mr;			avr32_spi_mr_t		MR;		};
+	union { const uint32_t rdr;		avr32_spi_rdr_t		RDR;	};
+	union { uint32_t tdr;			avr32_spi_tdr_t		TDR;	};
+	union { const uint32_t sr;		avr32_spi_sr_t		SR;		};
+	union { uint32_t ier;			avr32_spi_ier_t		IER;	};
+	union { uint32_t idr;			avr32_spi_idr_t		IDR;	};
+	union { const uint32_t imr;		avr32_spi_imr_t		IMR;	};
+	uint32_t reserved[4];
+	union { uint32_t csr0;			avr32_spi_csr0_t	CSR0;	};
+	union { uint32_t csr1;			avr32_spi_csr1_t	CSR1;	};
+	union { uint32_t csr2;			avr32_spi_csr2_t	CSR2;	};
+	union { uint32_t csr3;			avr32_spi_csr3_t	CSR3;	};
+} avr32_spi_t;
+
+// Both SPI modules are the single modelled one
+extern volatile avr32_spi_t *spi_model_regs;
+#define AVR32_SPI0		(*spi_model_regs)
+#define AVR32_SPI1		(*spi_model_regs)
+
+
+#endif /* HOST_AVR32_IO_H_ */
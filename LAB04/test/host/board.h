@@ -0,0 +1,18 @@
+/**
+ * Name         : board.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host stand-in for the EVK1100 board header, the SD card
+ *                slot on the SPI model only
+ */
+#ifndef HOST_BOARD_H_
+#define HOST_BOARD_H_
+
+#include "compiler.h"
+
+// SD card slot of the EVK1100: SPI1, NPCS1
+#define SD_MMC_SPI			(&AVR32_SPI1)
+#define SD_MMC_SPI_NPCS		1
+
+
+#endif /* HOST_BOARD_H_ */
@@ -0,0 +1,97 @@
+/**
+ * Name         : compiler.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host stand-in for the ASF compiler.h, used by the tests
+ */
+#ifndef HOST_COMPILER_H_
+#define HOST_COMPILER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include <avr32/io.h>
+
+// Asserts are always on in the tests
+#define Assert(expr)	assert(expr)
+
+// Producer and consumer may run on two host cores, a full fence then
+#define barrier()		__sync_synchronize()
+
+// ASF types
+typedef int8_t		S8;
+typedef uint8_t		U8;
+typedef int16_t		S16;
+typedef uint16_t	U16;
+typedef int32_t		S32;
+typedef uint32_t	U32;
+typedef int64_t		S64;
+typedef uint64_t	U64;
+typedef U8			Byte;
+
+#define PASS		0
+#define FAIL		1
+#define DISABLE		0
+#define ENABLE		1
+
+#define _GLOBEXT_			extern
+#define _CONST_TYPE_		const
+#define _MEM_TYPE_SLOW_
+#define _MEM_TYPE_MEDFAST_
+#define _MEM_TYPE_FAST_
+
+#define COMPILER_ALIGNED(a)		__attribute__((__aligned__(a)))
+#define COMPILER_WORD_ALIGNED	__attribute__((__aligned__(4)))
+#define COMPILER_PACK_SET(alignment)
+#define COMPILER_PACK_RESET()
+
+// The AVR32 min()/max() compare as int
+#define min(a, b)	({ int __a = (a), __b = (b); __a < __b ? __a : __b; })
+#define max(a, b)	({ int __a = (a), __b = (b); __a > __b ? __a : __b; })
+#define Min(a, b)	(((a) < (b)) ? (a) : (b))
+#define Max(a, b)	(((a) > (b)) ? (a) : (b))
+#define div_ceil(a, b)	(((a) + (b) - 1) / (b))
+#define UNUSED(v)		(void)(v)
+
+// Bytes of a value in memory, the host is little-endian unlike the AVR32
+#define MSB(u16)	(((U8 *)&(u16))[1])
+#define LSB(u16)	(((U8 *)&(u16))[0])
+#define MSB0W(u32)	(((U8 *)&(u32))[3])
+#define MSB1W(u32)	(((U8 *)&(u32))[2])
+#define MSB2W(u32)	(((U8 *)&(u32))[1])
+#define MSB3W(u32)	(((U8 *)&(u32))[0])
+#define LSB3W(u32)	MSB0W(u32)
+#define LSB2W(u32)	MSB1W(u32)
+#define LSB1W(u32)	MSB2W(u32)
+#define LSB0W(u32)	MSB3W(u32)
+#define LSB0(u32)	LSB0W(u32)
+#define LSB1(u32)	LSB1W(u32)
+#define LSB2(u32)	LSB2W(u32)
+#define LSB3(u32)	LSB3W(u32)
+#define MSB3(u32)	MSB3W(u32)
+#define MSB2(u32)	MSB2W(u32)
+#define MSB1(u32)	MSB1W(u32)
+#define MSB0(u32)	MSB0W(u32)
+
+#define memcmp_ram2ram	memcmp
+#define memcmp_code2ram	memcmp
+#define memcpy_ram2ram	memcpy
+#define memcpy_code2ram	memcpy
+
+// Size of RAM buffers (USB services)
+typedef uint32_t iram_size_t;
+
+// There are no interrupts on the host
+typedef uint32_t irqflags_t;
+#define cpu_irq_save()			((irqflags_t)0)
+#define cpu_irq_restore(flags)	((void)(flags))
+#define cpu_irq_enable()
+#define cpu_irq_disable()
+
+// CPU cycle counter, estimated by the SPI model (spi_model.c)
+extern uint32_t spi_model_count;
+#define Get_sys_count()		(spi_model_count)
+
+
+#endif /* HOST_COMPILER_H_ */
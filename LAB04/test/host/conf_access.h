@@ -0,0 +1,81 @@
+/**
+ * Name         : conf_access.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host memory control access configuration, one LUN on a
+ *                RAM disk image (image_mem.h) in place of the SD card, or
+ *                the SD card driver on the SD card emulator (sd_card.h)
+ *                when TEST_SD_MMC_SPI is defined
+ */
+#ifndef _CONF_ACCESS_H_
+#define _CONF_ACCESS_H_
+
+#include "compiler.h"
+
+// Activation of Logical Unit Numbers
+#ifdef TEST_SD_MMC_SPI
+#define LUN_0                DISABLE
+#define LUN_4                ENABLE
+#else
+#define LUN_0                ENABLE
+#define LUN_4                DISABLE
+#endif
+#define LUN_1                DISABLE
+#define LUN_2                DISABLE
+#define LUN_3                DISABLE
+#define LUN_5                DISABLE
+#define LUN_6                DISABLE
+#define LUN_7                DISABLE
+#define LUN_USB              DISABLE
+
+// LUN 0, the disk image
+#define IMAGE_MEM                               LUN_0
+#define LUN_ID_IMAGE_MEM                        LUN_ID_0
+#define LUN_0_INCLUDE                           "image_mem.h"
+#define Lun_0_test_unit_ready                   image_mem_test_unit_ready
+#define Lun_0_read_capacity                     image_mem_read_capacity
+#define Lun_0_unload                            NULL
+#define Lun_0_wr_protect                        image_mem_wr_protect
+#define Lun_0_removal                           image_mem_removal
+#define Lun_0_mem_2_ram                         image_mem_mem_2_ram
+#define Lun_0_ram_2_mem                         image_mem_ram_2_mem
+#define Lun_0_mem_2_ram_multi                   image_mem_mem_2_ram_multi
+#define Lun_0_ram_2_mem_multi                   image_mem_ram_2_mem_multi
+#define LUN_0_NAME                              "\"Disk image\""
+
+// LUN 4, the SD card over SPI as in the LAB04 configuration
+#define SD_MMC_SPI_MEM                          LUN_4
+#define LUN_ID_SD_MMC_SPI_MEM                   LUN_ID_4
+#define LUN_4_INCLUDE                           "sd_mmc_spi_mem.h"
+#define Lun_4_test_unit_ready                   sd_mmc_spi_test_unit_ready
+#define Lun_4_read_capacity                     sd_mmc_spi_read_capacity
+#define Lun_4_unload                            NULL
+#define Lun_4_wr_protect                        sd_mmc_spi_wr_protect
+#define Lun_4_removal                           sd_mmc_spi_removal
+#define Lun_4_mem_2_ram                         sd_mmc_spi_mem_2_ram
+#define Lun_4_ram_2_mem                         sd_mmc_spi_ram_2_mem
+#define Lun_4_mem_2_ram_multi                   sd_mmc_spi_mem_2_ram_multi
+#define Lun_4_ram_2_mem_multi                   sd_mmc_spi_ram_2_mem_multi
+#define LUN_4_NAME                              "\"SD/MMC Card over SPI\""
+
+// Actions associated with memory accesses
+#define memory_start_read_action(nb_sectors)
+#define memory_stop_read_action()
+#define memory_start_write_action(nb_sectors)
+#define memory_stop_write_action()
+
+// Activation of interface features, the FAT module copies files with
+// the streaming interface
+#define ACCESS_USB           false
+#define ACCESS_MEM_TO_RAM    true
+#define ACCESS_STREAM        true
+#define ACCESS_STREAM_RECORD false
+#define ACCESS_MEM_TO_MEM    true
+#define ACCESS_CODEC         false
+
+#define GLOBAL_WR_PROTECT    false
+
+#define SECTOR_SIZE  512
+
+
+#endif /* _CONF_ACCESS_H_ */
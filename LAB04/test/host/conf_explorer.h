@@ -0,0 +1,32 @@
+/**
+ * Name         : conf_explorer.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : FAT module configuration of the host tests, the LAB04
+ *                one with the sizes a test build may change
+ */
+#ifndef HOST_CONF_EXPLORER_H_
+#define HOST_CONF_EXPLORER_H_
+
+#include "../../config/conf_explorer.h"
+
+// Number of sectors in the sector cache
+#ifdef TEST_FS_NB_CACHE_SECTOR
+#undef  FS_NB_CACHE_SECTOR
+#define FS_NB_CACHE_SECTOR	TEST_FS_NB_CACHE_SECTOR
+#endif
+
+// Size in bytes of the free cluster bitmap
+#ifdef TEST_FS_FREE_MAP_SIZE
+#undef  FS_FREE_MAP_SIZE
+#define FS_FREE_MAP_SIZE	TEST_FS_FREE_MAP_SIZE
+#endif
+
+// Number of FAT updates between two copies of FAT1 in FAT2
+#ifdef TEST_FS_FAT2_MIRROR_INTERVAL
+#undef  FS_FAT2_MIRROR_INTERVAL
+#define FS_FAT2_MIRROR_INTERVAL	TEST_FS_FAT2_MIRROR_INTERVAL
+#endif
+
+
+#endif /* HOST_CONF_EXPLORER_H_ */
@@ -0,0 +1,18 @@
+/**
+ * Name         : conf_sd_mmc_spi.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : SD/MMC SPI driver configuration of the host tests, the
+ *                LAB04 one with the data phase on the CPU (no PDCA model)
+ */
+#ifndef HOST_CONF_SD_MMC_SPI_H_
+#define HOST_CONF_SD_MMC_SPI_H_
+
+#include "../../config/conf_sd_mmc_spi.h"
+
+// The SPI model has no PDCA, the CPU loops of spi.c move the data
+#undef  SD_MMC_SPI_USE_PDCA
+#define SD_MMC_SPI_USE_PDCA		false
+
+
+#endif /* HOST_CONF_SD_MMC_SPI_H_ */
@@ -0,0 +1,12 @@
+/**
+ * Name         : gpio.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host stand-in for the GPIO driver header, the pins of
+ *                the SPI model need no setup
+ */
+#ifndef HOST_GPIO_H_
+#define HOST_GPIO_H_
+
+
+#endif /* HOST_GPIO_H_ */
@@ -0,0 +1,130 @@
+/**
+ * Name         : image_mem.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : RAM disk image with access counters and write faults,
+ *                the memory behind LUN 0 in the host tests
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "image_mem.h"
+
+
+
+/*****  VARIABLES  ****************************************************/
+
+uint8_t *image_mem = NULL;
+uint32_t image_mem_size = 0;
+image_mem_stat_t image_mem_stat;
+void (*image_mem_write_hook)(U32 addr, const void *ram) = NULL;
+
+// Write fault injection
+static uint32_t image_mem_fail_skip;
+static uint32_t image_mem_fail_count;
+
+
+
+/*****  FUNCTIONS  ****************************************************/
+
+void image_mem_create(uint32_t nb_sector)
+{
+	image_mem_destroy();
+	image_mem = calloc(nb_sector, SECTOR_SIZE);
+	assert(image_mem);
+	image_mem_size = nb_sector;
+	memset(&image_mem_stat, 0, sizeof(image_mem_stat));
+	image_mem_fail_count = 0;
+}
+
+void image_mem_destroy(void)
+{
+	free(image_mem);
+	image_mem = NULL;
+	image_mem_size = 0;
+}
+
+void image_mem_fail_writes(uint32_t skip, uint32_t nb_write)
+{
+	image_mem_fail_skip = skip;
+	image_mem_fail_count = nb_write;
+}
+
+void image_mem_save(uint8_t *copy)
+{
+	memcpy(copy, image_mem, (size_t)image_mem_size * SECTOR_SIZE);
+}
+
+void image_mem_restore(const uint8_t *copy)
+{
+	memcpy(image_mem, copy, (size_t)image_mem_size * SECTOR_SIZE);
+}
+
+Ctrl_status image_mem_test_unit_ready(void)
+{
+	return image_mem ? CTRL_GOOD : CTRL_NO_PRESENT;
+}
+
+Ctrl_status image_mem_read_capacity(U32 *u32_nb_sector)
+{
+	if (!image_mem) return CTRL_NO_PRESENT;
+	*u32_nb_sector = image_mem_size - 1;
+	return CTRL_GOOD;
+}
+
+bool image_mem_wr_protect(void)
+{
+	return false;
+}
+
+bool image_mem_removal(void)
+{
+	return true;
+}
+
+Ctrl_status image_mem_mem_2_ram_multi(U32 addr, U16 nb_sector, void *ram)
+{
+	if (!image_mem) return CTRL_NO_PRESENT;
+	if (addr + nb_sector > image_mem_size) return CTRL_FAIL;
+
+	memcpy(ram, image_mem + (size_t)addr * SECTOR_SIZE, (size_t)nb_sector * SECTOR_SIZE);
+	image_mem_stat.read_cmds++;
+	image_mem_stat.read_sectors += nb_sector;
+	return CTRL_GOOD;
+}
+
+Ctrl_status image_mem_ram_2_mem_multi(U32 addr, U16 nb_sector, const void *ram)
+{
+	if (!image_mem) return CTRL_NO_PRESENT;
+	if (addr + nb_sector > image_mem_size) return CTRL_FAIL;
+
+	// Injected fault, nothing is written
+	if (image_mem_fail_count)
+	{
+		if (image_mem_fail_skip) image_mem_fail_skip--;
+		else
+		{
+			image_mem_fail_count--;
+			return CTRL_FAIL;
+		}
+	}
+
+	if (image_mem_write_hook)
+	{
+		for (U16 i = 0; i < nb_sector; i++) image_mem_write_hook(addr + i, (const uint8_t*)ram + i * SECTOR_SIZE);
+	}
+
+	memcpy(image_mem + (size_t)addr * SECTOR_SIZE, ram, (size_t)nb_sector * SECTOR_SIZE);
+	image_mem_stat.write_cmds++;
+	image_mem_stat.write_sectors += nb_sector;
+	return CTRL_GOOD;
+}
+
+Ctrl_status image_mem_mem_2_ram(U32 addr, void *ram)
+{
+	return image_mem_mem_2_ram_multi(addr, 1, ram);
+}
+
+Ctrl_status image_mem_ram_2_mem(U32 addr, const void *ram)
+{
+	return image_mem_ram_2_mem_multi(addr, 1, ram);
+}
@@ -0,0 +1,57 @@
+/**
+ * Name         : image_mem.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : RAM disk image with access counters and write faults,
+ *                the memory behind LUN 0 in the host tests
+ */
+#ifndef IMAGE_MEM_H_
+#define IMAGE_MEM_H_
+
+#include "conf_access.h"
+#include "ctrl_access.h"
+
+
+// Access counters, one command may move several sectors
+typedef struct {
+	uint32_t read_cmds;
+	uint32_t read_sectors;
+	uint32_t write_cmds;
+	uint32_t write_sectors;
+} image_mem_stat_t;
+
+// The image, image_mem_size sectors of 512 bytes
+extern uint8_t *image_mem;
+extern uint32_t image_mem_size;
+
+// Access counters, cleared by the test when needed
+extern image_mem_stat_t image_mem_stat;
+
+// Called for each sector before it is written, if set
+extern void (*image_mem_write_hook)(U32 addr, const void *ram);
+
+// Allocates an empty (zeroed) image of nb_sector sectors
+void image_mem_create(uint32_t nb_sector);
+
+// Frees the image, the LUN is then not present
+void image_mem_destroy(void);
+
+// Makes the next nb_write write commands fail (after skip good ones)
+void image_mem_fail_writes(uint32_t skip, uint32_t nb_write);
+
+// Saves or restores a copy of the whole image (e.g. a power loss)
+void image_mem_save(uint8_t *copy);
+void image_mem_restore(const uint8_t *copy);
+
+// LUN functions for ctrl_access
+Ctrl_status image_mem_test_unit_ready(void);
+Ctrl_status image_mem_read_capacity(U32 *u32_nb_sector);
+bool image_mem_wr_protect(void);
+bool image_mem_removal(void);
+Ctrl_status image_mem_mem_2_ram(U32 addr, void *ram);
+Ctrl_status image_mem_ram_2_mem(U32 addr, const void *ram);
+Ctrl_status image_mem_mem_2_ram_multi(U32 addr, U16 nb_sector, void *ram);
+Ctrl_status image_mem_ram_2_mem_multi(U32 addr, U16 nb_sector, const void *ram);
+
+
+#endif /* IMAGE_MEM_H_ */
@@ -0,0 +1,464 @@
+/**
+ * Name         : sd_card.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : SD card emulator in SPI mode, a device of the SPI model
+ *                backed by an image file. It answers the commands of the
+ *                SD/MMC SPI driver: identification (CMD0/8/55/41/58),
+ *                CSD, CID, CMD6 high speed, CMD13, single and multiple
+ *                block reads and writes with CMD12 and stop tokens.
+ */
+#define _GNU_SOURCE
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "sd_card.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+#define SD_BLOCK			512
+
+// R1 bits
+#define R1_IDLE				0x01
+#define R1_ILLEGAL			0x04
+#define R1_ADDRESS			0x20
+#define R1_PARAMETER		0x40
+
+// Tokens
+#define TOKEN_START			0xFE
+#define TOKEN_START_MULTI	0xFC
+#define TOKEN_STOP_MULTI	0xFD
+#define DATA_ACCEPTED		0x05
+
+// CSD TRAN_SPEED: 25 MHz, 50 MHz in high speed mode
+#define TRAN_SPEED_25MHZ	0x32
+#define TRAN_SPEED_50MHZ	0x5A
+
+// Stuff byte after CMD12, anything but 0xFF
+#define CMD12_STUFF			0x3C
+
+typedef enum {
+	SD_IDLE,			// waiting for a command
+	SD_READ_MULTI,		// streaming blocks until CMD12
+	SD_WRITE_SINGLE,	// waiting for the start token of CMD24
+	SD_WRITE_MULTI,		// waiting for a start or stop token of CMD25
+} sd_state_t;
+
+
+/*****  VARIABLES  ****************************************************/
+
+sd_card_stat_t sd_card_stat;
+uint8_t sd_card_tran_speed;
+uint32_t sd_card_busy_bytes;
+
+static struct {
+	FILE		*file;
+	uint32_t	nb_sector;
+	bool		sdhc;
+	bool		selected;
+	bool		idle;			// idle state, until ACMD41 completes
+	uint8_t		init_polls;		// ACMD41 answered idle this many more times
+	bool		app;			// CMD55 received, next is an ACMD
+	bool		high_speed;
+	sd_state_t	state;
+	uint32_t	block;			// next block of a multiple read or write
+	uint8_t		cmd[6];
+	uint8_t		cmd_len;
+	uint8_t		out[SD_BLOCK + 16];
+	uint16_t	out_len;
+	uint16_t	out_pos;
+	uint32_t	busy;			// busy bytes left
+	bool		receiving;		// data block of a write
+	uint8_t		rx[SD_BLOCK + 2];
+	uint16_t	rx_len;
+} card;
+
+
+
+/*****  IMAGE  ********************************************************/
+
+void sd_card_image_read(uint32_t sector, uint32_t nb_sector, void *buf)
+{
+	assert(sector + nb_sector <= card.nb_sector);
+	assert(pread(fileno(card.file), buf, (size_t)nb_sector * SD_BLOCK, (off_t)sector * SD_BLOCK)
+			== (ssize_t)nb_sector * SD_BLOCK);
+}
+
+void sd_card_image_write(uint32_t sector, uint32_t nb_sector, const void *buf)
+{
+	assert(sector + nb_sector <= card.nb_sector);
+	assert(pwrite(fileno(card.file), buf, (size_t)nb_sector * SD_BLOCK, (off_t)sector * SD_BLOCK)
+			== (ssize_t)nb_sector * SD_BLOCK);
+}
+
+
+
+/*****  RESPONSES  ****************************************************/
+
+static void out_clear(void)
+{
+	card.out_len = card.out_pos = 0;
+}
+
+static void out_byte(uint8_t byte)
+{
+	assert(card.out_len < sizeof(card.out));
+	card.out[card.out_len++] = byte;
+}
+
+// A data block after NAC: start token, data and a CRC (not checked)
+static void out_block(const uint8_t *data, uint16_t len)
+{
+	uint8_t i;
+
+	for (i = 0; i < SD_CARD_NAC; i++) out_byte(0xFF);
+	out_byte(TOKEN_START);
+	while (len--) out_byte(*data++);
+	out_byte(0x00);
+	out_byte(0x00);
+}
+
+static void out_sector(uint32_t block)
+{
+	uint8_t data[SD_BLOCK];
+
+	sd_card_image_read(block, 1, data);
+	out_block(data, SD_BLOCK);
+	sd_card_stat.blocks_read++;
+}
+
+// Card Specific Data, version 1 (SDSC) or 2 (SDHC)
+static void out_csd(void)
+{
+	uint8_t csd[16] = {0};
+	uint32_t c_size;
+
+	csd[1] = 0x26;											// TAAC
+	csd[3] = sd_card_tran_speed ? sd_card_tran_speed : card.high_speed ? TRAN_SPEED_50MHZ : TRAN_SPEED_25MHZ;
+	csd[4] = 0x5B;											// CCC, class 10 (switch) included
+	csd[5] = 0x59;											// READ_BL_LEN = 512
+	if (card.sdhc)
+	{
+		c_size = card.nb_sector / 1024 - 1;					// 512 kB units
+		csd[0] = 0x40;
+		csd[7] = (c_size >> 16) & 0x3F;
+		csd[8] = c_size >> 8;
+		csd[9] = c_size;
+	}
+	else
+	{
+		c_size = card.nb_sector / 512 - 1;					// C_SIZE_MULT = 7, 512 blocks
+		csd[6] = 0x80 | ((c_size >> 10) & 0x03);
+		csd[7] = c_size >> 2;
+		csd[8] = (c_size << 6) | 0x3F;
+		csd[9] = 0xFC | 0x03;
+		csd[10] = 0x80;
+	}
+	csd[10] |= 0x40 | 0x3F;									// ERASE_BLK_EN, SECTOR_SIZE
+	csd[11] = 0x80;
+	csd[15] = 0x01;
+	out_block(csd, sizeof(csd));
+}
+
+static void out_cid(void)
+{
+	static const uint8_t cid[16] = {
+		0x03, 'S', 'D', 'H', 'O', 'S', 'T', 0x10, 0x12, 0x34, 0x56, 0x78, 0x01, 0x4A, 0x01, 0x01
+	};
+
+	out_block(cid, sizeof(cid));
+}
+
+// CMD6 switch status: group 1 supports functions 0 and 1 (high speed)
+static void out_switch_status(uint32_t arg)
+{
+	uint8_t status[64] = {0};
+
+	status[1] = 100;										// max current (mA)
+	status[13] = 0x03;
+	status[16] = ((arg & 0x0F) == 0x01) ? 0x01 : 0x00;
+	if ((arg & 0x80000000) && (arg & 0x0F) == 0x01) card.high_speed = true;
+	out_block(status, sizeof(status));
+}
+
+// Block of a read or write command, byte address on a SDSC card
+static bool cmd_block(uint32_t arg, uint32_t *block, uint8_t *r1)
+{
+	if (!card.sdhc)
+	{
+		if (arg % SD_BLOCK) {
+			*r1 |= R1_ADDRESS;
+			return false;
+		}
+		arg /= SD_BLOCK;
+	}
+	if (arg >= card.nb_sector) {
+		*r1 |= R1_PARAMETER;
+		return false;
+	}
+	*block = arg;
+	return true;
+}
+
+
+
+/*****  COMMANDS  *****************************************************/
+
+static void command(void)
+{
+	uint8_t index = card.cmd[0] & 0x3F;
+	uint32_t arg = ((uint32_t)card.cmd[1] << 24) | ((uint32_t)card.cmd[2] << 16) |
+			((uint32_t)card.cmd[3] << 8) | card.cmd[4];
+	bool app = card.app;
+	uint8_t r1;
+	uint32_t block;
+
+	sd_card_stat.cmd[index]++;
+	card.app = false;
+
+	// CMD12 interrupts the block being sent: stuff byte, then R1b
+	if (index == 12)
+	{
+		out_clear();
+		out_byte(CMD12_STUFF);
+		out_byte(0xFF);
+		out_byte(0x00);
+		card.busy = sd_card_busy_bytes;
+		card.state = SD_IDLE;
+		return;
+	}
+
+	out_clear();
+	out_byte(0xFF);											// NCR
+	r1 = card.idle ? R1_IDLE : 0x00;
+
+	switch (index)
+	{
+	case 0:
+		card.idle = true;
+		card.init_polls = 2;
+		card.high_speed = false;
+		card.state = SD_IDLE;
+		out_byte(R1_IDLE);
+		break;
+
+	case 8:													// R7, echo of the check pattern
+		out_byte(r1);
+		out_byte(0x00);
+		out_byte(0x00);
+		out_byte((arg >> 8) & 0x0F);
+		out_byte(arg);
+		break;
+
+	case 55:
+		card.app = true;
+		out_byte(r1);
+		break;
+
+	case 41:
+		if (!app) {
+			out_byte(r1 | R1_ILLEGAL);
+			break;
+		}
+		if (card.init_polls) card.init_polls--;
+		else card.idle = false;
+		out_byte(card.idle ? R1_IDLE : 0x00);
+		break;
+
+	case 23:												// ACMD23, pre-erase hint
+		out_byte(app ? r1 : (r1 | R1_ILLEGAL));
+		break;
+
+	case 58:												// R3, OCR with CCS
+		out_byte(r1);
+		out_byte(0x80 | (card.sdhc ? 0x40 : 0x00));
+		out_byte(0xFF);
+		out_byte(0x80);
+		out_byte(0x00);
+		break;
+
+	case 59:
+		out_byte(r1);
+		break;
+
+	case 16:
+		out_byte((arg == SD_BLOCK) ? r1 : (r1 | R1_PARAMETER));
+		break;
+
+	case 9:
+		out_byte(r1);
+		out_csd();
+		break;
+
+	case 10:
+		out_byte(r1);
+		out_cid();
+		break;
+
+	case 6:
+		out_byte(r1);
+		out_switch_status(arg);
+		break;
+
+	case 13:												// R2
+		out_byte(r1);
+		out_byte(0x00);
+		break;
+
+	case 17:
+		if (!cmd_block(arg, &block, &r1)) {
+			out_byte(r1);
+			break;
+		}
+		out_byte(r1);
+		out_sector(block);
+		break;
+
+	case 18:
+	case 24:
+	case 25:
+		if (!cmd_block(arg, &block, &r1)) {
+			out_byte(r1);
+			break;
+		}
+		out_byte(r1);
+		card.block = block;
+		card.state = (index == 18) ? SD_READ_MULTI : (index == 24) ? SD_WRITE_SINGLE : SD_WRITE_MULTI;
+		break;
+
+	default:
+		out_byte(r1 | R1_ILLEGAL);
+		break;
+	}
+}
+
+// Data block of a write received: data response, then busy
+static void write_block(void)
+{
+	sd_card_image_write(card.block++, 1, card.rx);
+	sd_card_stat.blocks_written++;
+	out_clear();
+	out_byte(DATA_ACCEPTED);
+	card.busy = sd_card_busy_bytes;
+	if (card.state == SD_WRITE_SINGLE || card.block >= card.nb_sector) card.state = SD_IDLE;
+}
+
+// MOSI byte received
+static void receive(uint8_t mosi)
+{
+	if (card.receiving)
+	{
+		card.rx[card.rx_len++] = mosi;
+		if (card.rx_len == sizeof(card.rx)) {
+			card.receiving = false;
+			write_block();
+		}
+		return;
+	}
+
+	// Tokens of a write, no command is taken in the meantime
+	if (card.state == SD_WRITE_SINGLE || card.state == SD_WRITE_MULTI)
+	{
+		if ((card.state == SD_WRITE_SINGLE && mosi == TOKEN_START) ||
+				(card.state == SD_WRITE_MULTI && mosi == TOKEN_START_MULTI)) {
+			card.receiving = true;
+			card.rx_len = 0;
+		} else if (card.state == SD_WRITE_MULTI && mosi == TOKEN_STOP_MULTI) {
+			// one byte, then busy while the last block is programmed
+			out_clear();
+			out_byte(0xFF);
+			card.busy = sd_card_busy_bytes;
+			card.state = SD_IDLE;
+		}
+		return;
+	}
+
+	if (!card.cmd_len)
+	{
+		if ((mosi & 0xC0) != 0x40) return;
+		// A multiple block read keeps sending data during CMD12
+		if (card.state != SD_READ_MULTI) out_clear();
+	}
+	card.cmd[card.cmd_len++] = mosi;
+	if (card.cmd_len == sizeof(card.cmd)) {
+		card.cmd_len = 0;
+		command();
+	}
+}
+
+// MISO byte to send
+static uint8_t transmit(void)
+{
+	if (card.out_pos == card.out_len)
+	{
+		if (card.busy) {
+			card.busy--;
+			return 0x00;
+		}
+		if (card.state == SD_READ_MULTI && !card.cmd_len)
+		{
+			// the next block, nothing past the end of the card
+			out_clear();
+			if (card.block < card.nb_sector) out_sector(card.block++);
+			else return 0xFF;
+		}
+		else return 0xFF;
+	}
+	return card.out[card.out_pos++];
+}
+
+
+
+/*****  SPI DEVICE  ***************************************************/
+
+static void sd_card_select(bool selected)
+{
+	card.selected = selected;
+	if (selected) return;
+
+	// A transaction ends, programming (busy) goes on
+	out_clear();
+	card.cmd_len = 0;
+	card.receiving = false;
+	card.state = SD_IDLE;
+}
+
+static uint8_t sd_card_exchange(uint8_t mosi)
+{
+	uint8_t miso;
+
+	assert(card.file);
+	sd_card_stat.bytes++;
+	miso = transmit();
+	receive(mosi);
+	return miso;
+}
+
+const spi_model_device_t sd_card_device = { sd_card_select, sd_card_exchange };
+
+
+
+/*****  FUNCTIONS  ****************************************************/
+
+void sd_card_create(const char *path, uint32_t nb_sector, bool sdhc)
+{
+	sd_card_destroy();
+	assert(nb_sector % 1024 == 0);
+	memset(&card, 0, sizeof(card));
+	card.file = path ? fopen(path, "w+b") : tmpfile();
+	assert(card.file);
+	assert(ftruncate(fileno(card.file), (off_t)nb_sector * SD_BLOCK) == 0);
+	card.nb_sector = nb_sector;
+	card.sdhc = sdhc;
+	sd_card_busy_bytes = SD_CARD_BUSY_BYTES;
+	memset(&sd_card_stat, 0, sizeof(sd_card_stat));
+}
+
+void sd_card_destroy(void)
+{
+	if (card.file) fclose(card.file);
+	card.file = NULL;
+}
@@ -0,0 +1,59 @@
+/**
+ * Name         : sd_card.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : SD card emulator in SPI mode, a device of the SPI model
+ *                (spi_model.h) backed by an image file
+ */
+#ifndef SD_CARD_H_
+#define SD_CARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spi_model.h"
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Bytes of 0xFF before each data block of a read (NAC)
+#define SD_CARD_NAC				2
+
+// Bytes of busy signal after a written block or a CMD12
+#define SD_CARD_BUSY_BYTES		32
+
+// Command and data counters, cleared by the test when needed
+typedef struct {
+	uint32_t cmd[64];			// commands by index, ACMDs included
+	uint32_t blocks_read;
+	uint32_t blocks_written;
+	uint32_t bytes;				// bytes clocked while selected
+} sd_card_stat_t;
+
+extern sd_card_stat_t sd_card_stat;
+
+// TRAN_SPEED byte of the CSD, 0 for the one of the card (25 or 50 MHz)
+extern uint8_t sd_card_tran_speed;
+
+// Bytes of busy signal of the next busy phases, SD_CARD_BUSY_BYTES when
+// the card is inserted
+extern uint32_t sd_card_busy_bytes;
+
+// The card as a device of the SPI model
+extern const spi_model_device_t sd_card_device;
+
+
+/*****  FUNCTIONS  ****************************************************/
+
+// Inserts an erased card of nb_sector sectors backed by the file at path
+// (a temporary file if NULL). A SDHC card has block addressing.
+void sd_card_create(const char *path, uint32_t nb_sector, bool sdhc);
+
+// Removes the card, a temporary file is deleted
+void sd_card_destroy(void);
+
+// Direct access to the image, for the checks of the tests
+void sd_card_image_read(uint32_t sector, uint32_t nb_sector, void *buf);
+void sd_card_image_write(uint32_t sector, uint32_t nb_sector, const void *buf);
+
+
+#endif /* SD_CARD_H_ */
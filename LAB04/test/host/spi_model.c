@@ -0,0 +1,326 @@
+/**
+ * Name         : spi_model.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host model of the SPI module. The register page is
+ *                mapped without access rights, a fault on it runs the
+ *                access in the model and single steps the instruction
+ *                (x86-64 Linux).
+ */
+#define _GNU_SOURCE
+#include <assert.h>
+#include <signal.h>
+#include <string.h>
+#include <ucontext.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include "spi_model.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// x86 trap flag in EFLAGS, and the write bit of the page fault error code
+#define EFLAGS_TF			0x100
+#define PF_ERR_WRITE		0x2
+
+#define PAGE_SIZE			4096
+
+#define REG(name)			offsetof(avr32_spi_t, name)
+
+
+/*****  VARIABLES  ****************************************************/
+
+volatile avr32_spi_t *spi_model_regs;
+spi_model_stat_t spi_model_stat;
+uint32_t spi_model_count;
+
+static uint8_t *spi_model_page;
+
+// Register written by the instruction being stepped, -1 for a read
+static int spi_model_pending = -1;
+
+static const spi_model_device_t *spi_model_device[4];
+
+// Interrupt stall injection
+static uint32_t spi_model_stall_at;
+static uint32_t spi_model_stall_cycles;
+
+// Module state
+static struct {
+	bool		enabled;
+	uint32_t	mr;
+	uint32_t	csr[4];
+	int			npcs;			// chip select asserted, -1 for none
+	uint16_t	tdr;
+	bool		tdr_full;
+	uint16_t	shift;
+	uint8_t		shift_npcs;
+	bool		shifting;
+	uint32_t	shift_end;		// cycle count at the end of the frame
+	uint16_t	rdr;
+	bool		rdr_full;
+	bool		ovres;
+} spi;
+
+
+
+/*****  MODEL  ********************************************************/
+
+// Chip select driven by MR.PCS, fixed peripheral select only
+static int spi_model_pcs(void)
+{
+	uint8_t pcs = (spi.mr & AVR32_SPI_MR_PCS_MASK) >> AVR32_SPI_MR_PCS_OFFSET;
+	int n;
+
+	if (spi.mr & AVR32_SPI_MR_PCSDEC_MASK) return (pcs < 4) ? pcs : -1;
+	for (n = 0; n < 4; n++) {
+		if (!(pcs & (1 << n))) return n;
+	}
+	return -1;
+}
+
+static void spi_model_update_npcs(void)
+{
+	int npcs = spi_model_pcs();
+
+	if (npcs == spi.npcs) return;
+	if (spi.npcs >= 0 && spi_model_device[spi.npcs]) spi_model_device[spi.npcs]->select(false);
+	spi.npcs = npcs;
+	if (npcs >= 0 && spi_model_device[npcs]) spi_model_device[npcs]->select(true);
+}
+
+// Frame size and duration of the chip select
+static uint8_t spi_model_bits(uint8_t npcs)
+{
+	return ((spi.csr[npcs] & AVR32_SPI_CSR0_BITS_MASK) >> AVR32_SPI_CSR0_BITS_OFFSET) + 8;
+}
+
+static uint32_t spi_model_frame_cycles(uint8_t npcs)
+{
+	uint32_t scbr = (spi.csr[npcs] & AVR32_SPI_CSR0_SCBR_MASK) >> AVR32_SPI_CSR0_SCBR_OFFSET;
+
+	return spi_model_bits(npcs) * (scbr ? scbr : 1) * SPI_MODEL_CPU_PER_PBA;
+}
+
+static void spi_model_start(uint16_t frame, uint32_t now)
+{
+	spi.shift_npcs = (spi.npcs >= 0) ? spi.npcs : 0;
+	spi.shift = frame;
+	spi.shifting = true;
+	spi.shift_end = now + spi_model_frame_cycles(spi.shift_npcs);
+}
+
+// Shifts a frame to the selected device, all ones come back without one
+static uint16_t spi_model_exchange(uint16_t frame, uint8_t bits)
+{
+	const spi_model_device_t *device = (spi.npcs >= 0) ? spi_model_device[spi.npcs] : NULL;
+	uint16_t rx;
+
+	assert(bits == 8 || bits == 16);
+	if (spi.mr & AVR32_SPI_MR_LLB_MASK) return frame;
+	if (!device) return (bits == 16) ? 0xFFFF : 0xFF;
+	if (bits == 8) return device->exchange(frame);
+	rx = device->exchange(frame >> 8) << 8;
+	return rx | device->exchange(frame);
+}
+
+// Completes the frames shifted until now, starting the one in TDR after each
+static void spi_model_advance(uint32_t now)
+{
+	uint8_t bits;
+
+	while (spi.shifting && (int32_t)(now - spi.shift_end) >= 0)
+	{
+		bits = spi_model_bits(spi.shift_npcs);
+		if (spi.rdr_full) {
+			spi.ovres = true;
+			spi_model_stat.overruns++;
+		}
+		spi.rdr = spi_model_exchange(spi.shift, bits);
+		spi.rdr_full = true;
+		spi_model_stat.frames++;
+		if (bits == 16) spi_model_stat.frames_16++;
+
+		spi.shifting = false;
+		if (spi.tdr_full) {
+			spi.tdr_full = false;
+			spi_model_start(spi.tdr, spi.shift_end);
+		}
+	}
+}
+
+static void spi_model_reset(void)
+{
+	memset(&spi, 0, sizeof(spi));
+	spi.npcs = -1;
+	memset(spi_model_page, 0, PAGE_SIZE);
+}
+
+// A register access, time passes and the module catches up first
+static void spi_model_access(void)
+{
+	spi_model_stat.accesses++;
+	spi_model_count += SPI_MODEL_ACCESS_CYCLES;
+	if (spi_model_stall_cycles && spi_model_stat.accesses == spi_model_stall_at) {
+		spi_model_count += spi_model_stall_cycles;
+		spi_model_stall_cycles = 0;
+	}
+	spi_model_advance(spi_model_count);
+}
+
+static uint32_t spi_model_read(size_t reg)
+{
+	uint32_t value;
+
+	spi_model_access();
+	switch (reg)
+	{
+	case REG(sr):
+		spi_model_stat.sr_reads++;
+		value = 0;
+		if (spi.rdr_full) value |= AVR32_SPI_SR_RDRF_MASK;
+		if (!spi.tdr_full) value |= AVR32_SPI_SR_TDRE_MASK;
+		if (spi.ovres) value |= AVR32_SPI_SR_OVRES_MASK;
+		if (!spi.tdr_full && !spi.shifting) value |= AVR32_SPI_SR_TXEMPTY_MASK;
+		if (spi.enabled) value |= AVR32_SPI_SR_SPIENS_MASK;
+		spi.ovres = false;
+		return value;
+
+	case REG(rdr):
+		spi_model_stat.rdr_reads++;
+		spi.rdr_full = false;
+		return spi.rdr;
+
+	case REG(mr):
+		return spi.mr;
+
+	case REG(csr0): case REG(csr1): case REG(csr2): case REG(csr3):
+		return spi.csr[(reg - REG(csr0)) / 4];
+
+	default:
+		return 0;
+	}
+}
+
+static void spi_model_write(size_t reg, uint32_t value)
+{
+	spi_model_access();
+	switch (reg)
+	{
+	case REG(cr):
+		if (value & AVR32_SPI_CR_SWRST_MASK) {
+			spi_model_reset();
+			spi_model_update_npcs();
+		}
+		if (value & AVR32_SPI_CR_SPIEN_MASK) spi.enabled = true;
+		if (value & AVR32_SPI_CR_SPIDIS_MASK) spi.enabled = false;
+		break;
+
+	case REG(mr):
+		spi.mr = value;
+		spi_model_update_npcs();
+		break;
+
+	case REG(tdr):
+		spi_model_stat.tdr_writes++;
+		if (!spi.enabled) break;
+		if (spi.tdr_full) spi_model_stat.lost++;
+		if (spi.shifting) {
+			spi.tdr = value & AVR32_SPI_TDR_TD_MASK;
+			spi.tdr_full = true;
+		} else {
+			spi_model_start(value & AVR32_SPI_TDR_TD_MASK, spi_model_count);
+		}
+		break;
+
+	case REG(csr0): case REG(csr1): case REG(csr2): case REG(csr3):
+		spi.csr[(reg - REG(csr0)) / 4] = value;
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+
+/*****  TRAPS  ********************************************************/
+
+// Access to the register page: a read gets its value from the model
+// before the instruction runs, a write is run after it
+static void spi_model_fault(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+	size_t offset = (uint8_t *)info->si_addr - spi_model_page;
+
+	if (offset >= PAGE_SIZE) {
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+	offset &= ~(size_t)3;
+
+	mprotect(spi_model_page, PAGE_SIZE, PROT_READ | PROT_WRITE);
+	if (uc->uc_mcontext.gregs[REG_ERR] & PF_ERR_WRITE) {
+		spi_model_pending = offset;
+	} else {
+		spi_model_pending = -1;
+		*(uint32_t *)(spi_model_page + offset) = spi_model_read(offset);
+	}
+	uc->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+
+// The instruction has run, the page is closed again
+static void spi_model_step(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+
+	if (spi_model_pending >= 0) {
+		spi_model_write(spi_model_pending, *(uint32_t *)(spi_model_page + spi_model_pending));
+		spi_model_pending = -1;
+	}
+	mprotect(spi_model_page, PAGE_SIZE, PROT_NONE);
+	uc->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+}
+
+
+
+/*****  FUNCTIONS  ****************************************************/
+
+void spi_model_init(void)
+{
+	struct sigaction action;
+
+	if (!spi_model_page)
+	{
+		spi_model_page = mmap(NULL, PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		assert(spi_model_page != MAP_FAILED);
+		spi_model_regs = (volatile avr32_spi_t *)spi_model_page;
+
+		memset(&action, 0, sizeof(action));
+		action.sa_flags = SA_SIGINFO;
+		action.sa_sigaction = spi_model_fault;
+		assert(sigaction(SIGSEGV, &action, NULL) == 0);
+		action.sa_sigaction = spi_model_step;
+		assert(sigaction(SIGTRAP, &action, NULL) == 0);
+	}
+
+	mprotect(spi_model_page, PAGE_SIZE, PROT_READ | PROT_WRITE);
+	spi_model_reset();
+	memset(spi_model_device, 0, sizeof(spi_model_device));
+	memset(&spi_model_stat, 0, sizeof(spi_model_stat));
+	spi_model_stall_cycles = 0;
+	mprotect(spi_model_page, PAGE_SIZE, PROT_NONE);
+}
+
+void spi_model_attach(uint8_t npcs, const spi_model_device_t *device)
+{
+	assert(npcs < 4);
+	spi_model_device[npcs] = device;
+}
+
+void spi_model_stall(uint32_t after, uint32_t cycles)
+{
+	spi_model_stall_at = spi_model_stat.accesses + after;
+	spi_model_stall_cycles = cycles;
+}
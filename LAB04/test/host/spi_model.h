@@ -0,0 +1,67 @@
+/**
+ * Name         : spi_model.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host model of the SPI module. The real spi.c accesses
+ *                its registers as usual, each access is trapped and run
+ *                by the model, which shifts the frames to the devices on
+ *                the chip selects and keeps a CPU cycle count estimate.
+ */
+#ifndef SPI_MODEL_H_
+#define SPI_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr32/io.h>
+
+
+/*****  TIMING  *******************************************************/
+
+// CPU cycles per PBA cycle, conf_clock.h runs PBA at half the CPU clock
+#define SPI_MODEL_CPU_PER_PBA		2
+
+// CPU cycles of one SPI register access through the HSB-PB bridge,
+// the instructions around it are not counted
+#define SPI_MODEL_ACCESS_CYCLES		6
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Device on a chip select, 16-bit frames are shifted as two bytes, MSB first
+typedef struct {
+	void	(*select)(bool selected);		// NPCS line asserted or released
+	uint8_t	(*exchange)(uint8_t mosi);		// one byte shifted, returns MISO
+} spi_model_device_t;
+
+// Access and frame counters, cleared by the test when needed
+typedef struct {
+	uint32_t accesses;		// register accesses
+	uint32_t sr_reads;
+	uint32_t tdr_writes;
+	uint32_t rdr_reads;
+	uint32_t frames;		// frames shifted
+	uint32_t frames_16;		// of which 16-bit ones
+	uint32_t overruns;		// frames received while RDR was full
+	uint32_t lost;			// TDR written while full, a frame lost
+} spi_model_stat_t;
+
+extern spi_model_stat_t spi_model_stat;
+
+// CPU cycle count estimate, Get_sys_count() of the host tests
+extern uint32_t spi_model_count;
+
+
+/*****  FUNCTIONS  ****************************************************/
+
+// Maps the register page and resets the module, no device attached
+void spi_model_init(void);
+
+// Attaches a device to NPCS npcs (0-3), NULL detaches it
+void spi_model_attach(uint8_t npcs, const spi_model_device_t *device);
+
+// Holds the CPU for cycles after the next after register accesses, as an
+// interrupt would, while the module keeps shifting
+void spi_model_stall(uint32_t after, uint32_t cycles);
+
+
+#endif /* SPI_MODEL_H_ */
@@ -0,0 +1,19 @@
+/**
+ * Name         : sysclk.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host stand-in for the system clock service, the clocks
+ *                of conf_clock.h that the SPI model runs at
+ */
+#ifndef HOST_SYSCLK_H_
+#define HOST_SYSCLK_H_
+
+#include "spi_model.h"
+
+
+// PBA at half the CPU clock, as CONFIG_SYSCLK_PBA_DIV 1
+#define sysclk_get_pba_hz()		(33000000UL)
+#define sysclk_get_cpu_hz()		(sysclk_get_pba_hz() * SPI_MODEL_CPU_PER_PBA)
+
+
+#endif /* HOST_SYSCLK_H_ */
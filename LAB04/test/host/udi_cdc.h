@@ -0,0 +1,27 @@
+/**
+ * Name         : udi_cdc.h
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host stand-in for the USB CDC interface header, the
+ *                receive functions the CLI uses are defined by the test
+ */
+#ifndef HOST_UDI_CDC_H_
+#define HOST_UDI_CDC_H_
+
+#include "compiler.h"
+
+
+// Number of bytes received and not read yet
+iram_size_t udi_cdc_get_nb_received_data(void);
+
+// Returns true if a byte is ready to be read
+bool udi_cdc_is_rx_ready(void);
+
+// Waits for a byte and returns it
+int udi_cdc_getc(void);
+
+// Reads size bytes, returns the number of bytes that were not read
+iram_size_t udi_cdc_read_buf(void* buf, iram_size_t size);
+
+
+#endif /* HOST_UDI_CDC_H_ */
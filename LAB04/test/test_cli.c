@@ -0,0 +1,219 @@
+/**
+ * Name         : test_cli.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test of the CLI input (cli.c) in a main loop that
+ *                logs a frame per pass, with a terminal that types slowly
+ *                or not at all
+ */
+#include <asf.h>
+#include <string.h>
+#include "image_mem.h"
+#include "log.h"
+#include "cli.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Disk image size in sectors (16 MB, FAT16)
+#define IMAGE_SECTORS		32768
+
+// One channel at 1 kHz
+#define TEST_CHANNELS		0x01
+#define TEST_CLOCK_HZ		1500000
+#define TEST_CLOCK_PERIOD	1500
+
+// Passes of the main loop of each test, one frame is logged per pass
+#define TEST_PASSES			5000
+
+// Terminal: the bytes typed, one more arrives every terminal_period passes
+static const char *terminal_text;
+static uint32_t terminal_typed;
+static uint32_t terminal_read;
+static uint32_t terminal_period;
+
+// Calls of the CDC functions by the CLI
+static uint32_t nb_rx_ready, nb_read_buf;
+
+
+
+/*****  CDC STAND-IN  *************************************************/
+
+iram_size_t udi_cdc_get_nb_received_data(void)
+{
+	return terminal_typed - terminal_read;
+}
+
+bool udi_cdc_is_rx_ready(void)
+{
+	nb_rx_ready++;
+	return udi_cdc_get_nb_received_data() > 0;
+}
+
+// Blocks on the target, the main loop must never get here
+int udi_cdc_getc(void)
+{
+	assert(false);
+	return 0;
+}
+
+iram_size_t udi_cdc_read_buf(void* buf, iram_size_t size)
+{
+	iram_size_t nb = min(size, udi_cdc_get_nb_received_data());
+
+	nb_read_buf++;
+	memcpy(buf, terminal_text + terminal_read, nb);
+	terminal_read += nb;
+	return size - nb;
+}
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// Starts typing text, a byte each period passes (all at once if 0)
+static void terminal_type(const char *text, uint32_t period)
+{
+	terminal_text = text;
+	terminal_typed = period ? 0 : strlen(text);
+	terminal_read = 0;
+	terminal_period = period;
+	nb_rx_ready = nb_read_buf = 0;
+}
+
+// Blocks of the logfile, header included
+static uint32_t logfile_blocks(const char *filename)
+{
+	uint32_t nb_block;
+
+	ctrl_access_lock();
+	assert(nav_setcwd((FS_STRING)filename, true, false));
+	assert(file_open(FOPEN_MODE_R));
+	nb_block = nav_file_lgt() / LOG_BLOCK_SIZE;
+	file_close();
+	ctrl_access_unlock();
+	return nb_block;
+}
+
+// Blocks of a session of nb_frames frames
+static uint32_t session_blocks(uint32_t nb_frames)
+{
+	uint32_t per_block = LOG_BLOCK_VALUES;
+
+	return 1 + (nb_frames + per_block - 1) / per_block;
+}
+
+// Main loop as main.c: a frame from the ADC, the log task, then the CLI.
+// Runs passes passes or until a command is entered, returns the passes run
+// and the command.
+static uint32_t main_loop(uint32_t passes, cli_command_t *cmd, uint32_t *frame)
+{
+	uint16_t value;
+	uint32_t pass;
+
+	*cmd = CLI_CMD_NONE;
+	for (pass = 0; pass < passes && *cmd == CLI_CMD_NONE; pass++)
+	{
+		value = *frame & ADC_MAX_VALUE;
+		log_write_frame((*frame)++, &value);
+		assert(log_task());
+
+		// The terminal types
+		if (terminal_period && !(pass % terminal_period) && terminal_text[terminal_typed]) terminal_typed++;
+
+		cli_task();
+		*cmd = cli_get_command();
+	}
+	return pass;
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+// Nothing typed: each pass logs its frame, the CLI only checks for input
+static void test_idle(void)
+{
+	cli_command_t cmd;
+	uint32_t frame = 0;
+
+	assert(log_set_file("idle.log"));
+	assert(log_start(TEST_CHANNELS, TEST_CLOCK_HZ, TEST_CLOCK_PERIOD));
+	terminal_type("", 0);
+	assert(main_loop(TEST_PASSES, &cmd, &frame) == TEST_PASSES);
+	log_stop();
+
+	assert(cmd == CLI_CMD_NONE && frame == TEST_PASSES);
+	assert(nb_rx_ready == TEST_PASSES && nb_read_buf == 0);
+	assert(log_get_stalls() == 0 && log_get_lost_blocks() == 0);
+	assert(logfile_blocks("idle.log") == session_blocks(TEST_PASSES));
+}
+
+// A command typed a byte at a time: logging goes on between the bytes,
+// the command is seen on the pass its last byte arrives
+static void test_slow_typing(void)
+{
+	cli_command_t cmd;
+	uint32_t frame = 0, passes;
+
+	assert(log_set_file("slow.log"));
+	assert(log_start(TEST_CHANNELS, TEST_CLOCK_HZ, TEST_CLOCK_PERIOD));
+	terminal_type("stop\r\n", 500);
+	passes = main_loop(TEST_PASSES, &cmd, &frame);
+	log_stop();
+
+	assert(cmd == CLI_CMD_STOP && passes == 5 * 500 + 1);
+	assert(nb_read_buf == strlen("stop\r\n"));
+	assert(log_get_stalls() == 0 && log_get_lost_blocks() == 0);
+	assert(logfile_blocks("slow.log") == session_blocks(passes));
+}
+
+// Input pending all at once is read in buffer sized chunks, each command
+// is returned on its own pass, with an argument and after a line longer
+// than the command buffer
+static void test_burst(void)
+{
+	cli_command_t cmd;
+	uint32_t frame = 0;
+
+	assert(log_set_file("burst.log"));
+	assert(log_start(TEST_CHANNELS, TEST_CLOCK_HZ, TEST_CLOCK_PERIOD));
+	terminal_type("file burst.log\r\n", 0);
+	assert(main_loop(1, &cmd, &frame) == 1 && cmd == CLI_CMD_FILE);
+	assert(!strcmp(cli_get_argument(), "burst.log"));
+	assert(nb_read_buf == 1);
+
+	terminal_type("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\r\nhelp\r\n", 0);
+	assert(main_loop(10, &cmd, &frame) <= 3 && cmd == CLI_CMD_UNKNOWN);
+	assert(main_loop(10, &cmd, &frame) <= 3 && cmd == CLI_CMD_HELP);
+	assert(terminal_read == terminal_typed);
+	assert(main_loop(10, &cmd, &frame) == 10 && cmd == CLI_CMD_NONE);
+	log_stop();
+
+	assert(log_get_stalls() == 0 && log_get_lost_blocks() == 0);
+	assert(logfile_blocks("burst.log") == session_blocks(frame));
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	image_mem_create(IMAGE_SECTORS);
+	ctrl_access_lock();
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_drive_format(FS_FORMAT_FAT));
+	ctrl_access_unlock();
+	assert(log_init(0));
+
+	test_idle();
+	test_slow_typing();
+	test_burst();
+
+	image_mem_destroy();
+	printf("test_cli: passed\n");
+	return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * Name         : test_fat2.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host crash consistency test of the delayed FAT2 copy,
+ *                the disk image is cut after each sector write
+ */
+#include <asf.h>
+#include <stdlib.h>
+#include <string.h>
+#include "image_mem.h"
+#include "fat_image.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Disk image size in sectors (16 MB, FAT16)
+#define IMAGE_SECTORS		32768
+
+// Most FAT sectors and sector versions tracked
+#define MAX_FAT_SECTORS		64
+#define MAX_VERSIONS		512
+
+// FAT1 sector writes of the workload with the FAT2 copy at each update,
+// before the dirty sector bitmap
+#define BASELINE_FAT1_WRITES	4
+
+// A sector write seen by the hook
+typedef struct {
+	uint32_t addr;
+	uint8_t data[FS_512B];
+} journal_t;
+
+
+
+/*****  VARIABLES  ****************************************************/
+
+static uint8_t buf[32 * FS_512B];
+static uint32_t cluster_size;
+
+// Sector writes of the workload
+static journal_t *journal;
+static uint32_t journal_size;
+
+// Versions (hashes) of each FAT1 sector written so far
+static uint64_t versions[MAX_FAT_SECTORS][MAX_VERSIONS];
+static uint16_t nb_versions[MAX_FAT_SECTORS];
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// Records a sector write
+static void journal_hook(U32 addr, const void *ram)
+{
+	journal = realloc(journal, (journal_size + 1) * sizeof(journal_t));
+	assert(journal);
+	journal[journal_size].addr = addr;
+	memcpy(journal[journal_size].data, ram, FS_512B);
+	journal_size++;
+}
+
+// FNV-1a of a sector
+static uint64_t sector_hash(const uint8_t *data)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	uint16_t i;
+
+	for (i = 0; i < FS_512B; i++) hash = (hash ^ data[i]) * 0x100000001B3ULL;
+	return hash;
+}
+
+// Adds the content of FAT1 sector s on the image to its versions
+static void add_version(uint32_t s)
+{
+	uint64_t hash = sector_hash(image_mem + (fs_g_nav.u32_ptr_fat + s) * FS_512B);
+	uint16_t i;
+
+	for (i = 0; i < nb_versions[s]; i++) if (versions[s][i] == hash) return;
+	assert(nb_versions[s] < MAX_VERSIONS);
+	versions[s][nb_versions[s]++] = hash;
+}
+
+// Writes a file of nb_cluster clusters, bytes are seed + position
+static void write_file(const char *name, uint8_t mode, uint32_t nb_cluster, uint8_t seed)
+{
+	uint32_t n;
+
+	assert(nav_setcwd((FS_STRING)name, true, true));
+	assert(file_open(mode));
+	while (nb_cluster--)
+	{
+		for (n = 0; n < cluster_size; n++) buf[n] = (uint8_t)(seed + file_getpos() + n);
+		assert(file_write_buf(buf, cluster_size) == cluster_size);
+	}
+	file_close();
+}
+
+// Checks a file written by write_file()
+static void check_file(const char *name, uint32_t nb_cluster, uint8_t seed)
+{
+	uint32_t pos, n;
+
+	assert(nav_setcwd((FS_STRING)name, true, false));
+	assert(nav_file_lgt() == nb_cluster * cluster_size);
+	assert(file_open(FOPEN_MODE_R));
+	for (pos = 0; pos < nb_cluster * cluster_size; pos += cluster_size)
+	{
+		assert(file_read_buf(buf, cluster_size) == cluster_size);
+		for (n = 0; n < cluster_size; n++) assert(buf[n] == (uint8_t)(seed + pos + n));
+	}
+	file_close();
+}
+
+// Mounts the image as after a power loss and checks it: the partition
+// mounts, the file closed before the workload is intact and, when the copy
+// is delayed, each FAT2 sector holds a content that its FAT1 sector had
+// before (FAT2 is never ahead of FAT1)
+static void check_crash(void)
+{
+	uint32_t writes = image_mem_stat.write_cmds;
+#if (FS_FAT2_MIRROR_INTERVAL != 0)
+	uint64_t hash;
+	uint32_t s;
+	uint16_t i;
+#endif
+
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_partition_mount());
+	check_file("a.bin", 20, 0x11);
+
+#if (FS_FAT2_MIRROR_INTERVAL != 0)
+	for (s = 0; s < fs_g_nav.u32_fat_size; s++)
+	{
+		hash = sector_hash(image_mem + (fs_g_nav.u32_ptr_fat + fs_g_nav.u32_fat_size + s) * FS_512B);
+		for (i = 0; i < nb_versions[s] && versions[s][i] != hash; i++) { }
+		assert(i < nb_versions[s]);
+	}
+#endif
+	assert(image_mem_stat.write_cmds == writes);
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+static void test_crash(void)
+{
+	uint32_t fat1_writes = 0, fat2_writes = 0;
+	uint32_t fat1, fat2, end;
+	uint8_t *base;
+	uint32_t k, s;
+
+	fat_image_mount(IMAGE_SECTORS);
+	cluster_size = fs_g_nav.u8_BPB_SecPerClus * FS_512B;
+	assert(cluster_size <= sizeof(buf));
+	assert(fs_g_nav.u32_fat_size <= MAX_FAT_SECTORS);
+	fat1 = fs_g_nav.u32_ptr_fat;
+	fat2 = fat1 + fs_g_nav.u32_fat_size;
+	end = fat2 + fs_g_nav.u32_fat_size;
+
+	// Files written before the power loss
+	write_file("a.bin", FOPEN_MODE_W, 20, 0x11);
+	write_file("c.bin", FOPEN_MODE_W, 10, 0x33);
+	assert(fat_cache_flush());
+	assert(fat_image_fats_equal());
+	base = malloc((size_t)IMAGE_SECTORS * FS_512B);
+	assert(base);
+	image_mem_save(base);
+
+	// Workload, each sector write is recorded
+	image_mem_write_hook = journal_hook;
+	write_file("b.bin", FOPEN_MODE_APPEND, 20, 0x22);
+	assert(nav_setcwd((FS_STRING)"c.bin", true, false));
+	assert(nav_file_del(false));
+	write_file("b.bin", FOPEN_MODE_APPEND, 40, 0x22);
+	write_file("d.bin", FOPEN_MODE_W, 5, 0x44);
+	image_mem_write_hook = NULL;
+
+	// After the close FAT2 is a copy of FAT1
+	assert(fat_image_fats_equal());
+	check_file("b.bin", 60, 0x22);
+
+	// Replay the writes on the saved image, cut after each one
+	image_mem_restore(base);
+	for (s = 0; s < fs_g_nav.u32_fat_size; s++) add_version(s);
+	for (k = 0; k <= journal_size; k++)
+	{
+		check_crash();
+		if (k == journal_size) break;
+
+		memcpy(image_mem + journal[k].addr * FS_512B, journal[k].data, FS_512B);
+		if (journal[k].addr >= fat1 && journal[k].addr < fat2)
+		{
+			add_version(journal[k].addr - fat1);
+			fat1_writes++;
+		}
+		else if (journal[k].addr >= fat2 && journal[k].addr < end) fat2_writes++;
+	}
+	assert(fat_image_fats_equal());
+
+	printf("FAT2 interval %u: %lu power loss points, %lu FAT1 and %lu FAT2 sector writes\n",
+			FS_FAT2_MIRROR_INTERVAL, (unsigned long)journal_size + 1,
+			(unsigned long)fat1_writes, (unsigned long)fat2_writes);
+
+	// Without a delayed copy FAT1 sectors stay in the cache as before
+#if (FS_FAT2_MIRROR_INTERVAL == 0)
+	assert(fat1_writes <= BASELINE_FAT1_WRITES);
+#endif
+
+	free(journal);
+	free(base);
+	image_mem_destroy();
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	ctrl_access_lock();
+	test_crash();
+	ctrl_access_unlock();
+
+	printf("test_fat2: passed\n");
+	return 0;
+}
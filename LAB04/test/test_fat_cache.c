@@ -0,0 +1,193 @@
+/**
+ * Name         : test_fat_cache.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test and benchmark of the FAT sector cache, built
+ *                with the configured number of sectors and with one
+ */
+#include <asf.h>
+#include <string.h>
+#include <time.h>
+#include "image_mem.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Disk image size in sectors (16 MB, FAT16)
+#define IMAGE_SECTORS		32768
+
+// Workload: rounds of small appends to each file
+#define WORK_FILES			4
+#define WORK_ROUNDS			200
+#define WORK_CHUNK			300
+
+// Sectors of the image far after the files, used by the LRU test
+#define FREE_SECTOR(n)		(IMAGE_SECTORS - 64 + (n))
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// Formats the image and mounts the partition
+static void mount_image(void)
+{
+	image_mem_create(IMAGE_SECTORS);
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_drive_format(FS_FORMAT_FAT));
+	assert(nav_partition_mount());
+}
+
+// Byte n of file f in the workload
+static uint8_t work_byte(uint8_t f, uint32_t n)
+{
+	return (uint8_t)(n * 7 + f * 31 + (n >> 9));
+}
+
+// Clears the cache statistics
+static void stat_clear(void)
+{
+	memset(&fs_g_sectorcache_stat, 0, sizeof(fs_g_sectorcache_stat));
+	memset(&image_mem_stat, 0, sizeof(image_mem_stat));
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+#if FS_NB_CACHE_SECTOR >= 4
+// Reads a sector through the cache
+static void cache_read(uint32_t addr)
+{
+	fs_gu32_addrsector = addr;
+	assert(fat_cache_read_sector(true));
+}
+
+// Replacement of the least recently used sector and write back
+static void test_lru(void)
+{
+	uint8_t i;
+
+	mount_image();
+	assert(fat_cache_flush());
+	fat_cache_reset();
+	stat_clear();
+
+	// Four sectors fill the cache, the first one is then used again
+	for (i = 0; i < 4; i++) cache_read(FREE_SECTOR(i));
+	cache_read(FREE_SECTOR(0));
+	assert(fs_g_sectorcache_stat.u32_miss == 4 && fs_g_sectorcache_stat.u32_hit == 1);
+	assert(fs_g_sectorcache_stat.u32_eviction == 0);
+
+	// A fifth sector replaces the oldest one (1), 0 stays cached
+	cache_read(FREE_SECTOR(4));
+	assert(fs_g_sectorcache_stat.u32_eviction == 1);
+	cache_read(FREE_SECTOR(0));
+	cache_read(FREE_SECTOR(2));
+	assert(fs_g_sectorcache_stat.u32_hit == 3 && fs_g_sectorcache_stat.u32_miss == 5);
+	cache_read(FREE_SECTOR(1));
+	assert(fs_g_sectorcache_stat.u32_miss == 6);
+	assert(image_mem_stat.read_cmds == 6 && image_mem_stat.write_cmds == 0);
+
+	// A modified sector is written only when it leaves the cache
+	cache_read(FREE_SECTOR(10));
+	fs_g_sector[0] = 0xA5;
+	fat_cache_mark_sector_as_dirty();
+	for (i = 11; i < 14; i++) cache_read(FREE_SECTOR(i));
+	assert(image_mem_stat.write_cmds == 0);
+	cache_read(FREE_SECTOR(14));
+	assert(image_mem_stat.write_cmds == 1 && fs_g_sectorcache_stat.u32_writeback == 1);
+	assert(image_mem[FREE_SECTOR(10) * 512] == 0xA5);
+
+	// Flush writes the modified sectors and keeps them cached
+	cache_read(FREE_SECTOR(11));
+	fs_g_sector[1] = 0x5A;
+	fat_cache_mark_sector_as_dirty();
+	assert(fat_cache_flush());
+	assert(image_mem[FREE_SECTOR(11) * 512 + 1] == 0x5A);
+	assert(image_mem_stat.write_cmds == 2);
+	cache_read(FREE_SECTOR(11));
+	assert(image_mem_stat.read_cmds == 11);
+
+	image_mem_destroy();
+}
+#endif
+
+// Appends to several files in turn, lists the directory and reads the
+// files back, the workload of a logger with a few logfiles
+static void test_workload(void)
+{
+	static uint8_t buf[WORK_CHUNK];
+	char name[16];
+	uint32_t round, n;
+	uint8_t f;
+	clock_t start;
+
+	mount_image();
+	stat_clear();
+	start = clock();
+
+	for (round = 0; round < WORK_ROUNDS; round++)
+	{
+		for (f = 0; f < WORK_FILES; f++)
+		{
+			sprintf(name, "file%u.bin", f);
+			assert(nav_setcwd((FS_STRING)name, true, true));
+			assert(file_open(FOPEN_MODE_APPEND));
+			for (n = 0; n < WORK_CHUNK; n++) buf[n] = work_byte(f, round * WORK_CHUNK + n);
+			assert(file_write_buf(buf, WORK_CHUNK) == WORK_CHUNK);
+			file_close();
+		}
+	}
+
+	// List the directory
+	assert(nav_filelist_reset());
+	for (n = 0; nav_filelist_set(0, FS_FIND_NEXT); n++) {
+		assert(nav_file_lgt() == WORK_ROUNDS * WORK_CHUNK);
+	}
+	assert(n == WORK_FILES);
+
+	// Read back
+	for (f = 0; f < WORK_FILES; f++)
+	{
+		sprintf(name, "file%u.bin", f);
+		assert(nav_setcwd((FS_STRING)name, true, false));
+		assert(file_open(FOPEN_MODE_R));
+		for (round = 0; round < WORK_ROUNDS; round++)
+		{
+			assert(file_read_buf(buf, WORK_CHUNK) == WORK_CHUNK);
+			for (n = 0; n < WORK_CHUNK; n++) assert(buf[n] == work_byte(f, round * WORK_CHUNK + n));
+		}
+		file_close();
+	}
+	assert(fat_cache_flush());
+
+	printf("workload, %u sector cache: %lu hits, %lu misses, %lu evictions, %lu write backs\n",
+			FS_NB_CACHE_SECTOR,
+			(unsigned long)fs_g_sectorcache_stat.u32_hit, (unsigned long)fs_g_sectorcache_stat.u32_miss,
+			(unsigned long)fs_g_sectorcache_stat.u32_eviction, (unsigned long)fs_g_sectorcache_stat.u32_writeback);
+	printf("workload, %u sector cache: %lu sector reads, %lu sector writes, %.1f ms\n",
+			FS_NB_CACHE_SECTOR,
+			(unsigned long)image_mem_stat.read_sectors, (unsigned long)image_mem_stat.write_sectors,
+			(clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+
+	image_mem_destroy();
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	ctrl_access_lock();
+#if FS_NB_CACHE_SECTOR >= 4
+	test_lru();
+#endif
+	test_workload();
+	ctrl_access_unlock();
+
+	printf("test_fat_cache: passed\n");
+	return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * Name         : test_freemap.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test and benchmark of the cluster allocation with
+ *                the free cluster bitmap, and with the FAT scan when the
+ *                bitmap is too small for the partition
+ */
+#include <asf.h>
+#include <string.h>
+#include <time.h>
+#include "image_mem.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Disk image size in sectors (16 MB, FAT16)
+#define IMAGE_SECTORS		32768
+
+// Files of one cluster allocated by the latency benchmark
+#define BENCH_FILES			16
+
+// Largest cluster handled by the tests
+#define MAX_CLUSTER_SIZE	(32 * 512)
+
+// The bitmap covers the partition of the image
+#define FREEMAP_USED		(FS_FREE_MAP_SIZE * 8 >= IMAGE_SECTORS)
+
+
+
+/*****  VARIABLES  ****************************************************/
+
+static uint8_t buf[MAX_CLUSTER_SIZE];
+static uint32_t cluster_size;
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// Formats the image and mounts the partition
+static void mount_image(void)
+{
+	image_mem_create(IMAGE_SECTORS);
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_drive_format(FS_FORMAT_FAT));
+	assert(nav_partition_mount());
+	cluster_size = fs_g_nav.u8_BPB_SecPerClus * FS_512B;
+	assert(cluster_size <= MAX_CLUSTER_SIZE);
+	assert(FREEMAP_USED == fat_freemap_build());
+}
+
+// Creates a file of nb_cluster clusters written in one call, its
+// bytes are seed + position
+static void write_file(const char *name, uint32_t nb_cluster, uint8_t seed)
+{
+	uint32_t size = nb_cluster * cluster_size;
+	uint32_t n;
+
+	assert(size <= 0xFFFF && size <= sizeof(buf));
+	for (n = 0; n < size; n++) buf[n] = (uint8_t)(seed + n);
+	assert(nav_setcwd((FS_STRING)name, true, true));
+	assert(file_open(FOPEN_MODE_W));
+	assert(file_write_buf(buf, size) == size);
+	file_close();
+}
+
+// Checks the content of a file written by write_file(), returns the
+// number of contiguous segments
+static uint32_t check_file(const char *name, uint32_t nb_cluster, uint8_t seed)
+{
+	Fs_file_segment segment;
+	uint32_t size = nb_cluster * cluster_size;
+	uint32_t nb_segment = 0;
+	uint32_t n;
+
+	assert(nav_setcwd((FS_STRING)name, true, false));
+	assert(nav_file_lgt() == size);
+	assert(file_open(FOPEN_MODE_R));
+	assert(file_read_buf(buf, size) == size);
+	for (n = 0; n < size; n++) assert(buf[n] == (uint8_t)(seed + n));
+
+	assert(file_seek(0, FS_SEEK_SET));
+	while (!file_eof())
+	{
+		segment.u16_size = 0;
+		assert(file_read(&segment));
+		nb_segment++;
+	}
+	file_close();
+	return nb_segment;
+}
+
+// Fills nb_cluster clusters with one file, contiguous from cluster 2 on
+// an empty partition
+static void fill_clusters(uint32_t nb_cluster)
+{
+	uint32_t chunk = sizeof(buf) / cluster_size;
+
+	memset(buf, 0xFF, sizeof(buf));
+	assert(nav_setcwd((FS_STRING)"fill.bin", true, true));
+	assert(file_open(FOPEN_MODE_W));
+	while (nb_cluster)
+	{
+		if (chunk > nb_cluster) chunk = nb_cluster;
+		assert(file_write_buf(buf, chunk * cluster_size) == chunk * cluster_size);
+		nb_cluster -= chunk;
+	}
+	file_close();
+}
+
+// Fills the partition up to percent of its clusters with one file
+static void fill(uint8_t percent)
+{
+	fill_clusters(fs_g_nav.u32_CountofCluster * percent / 100);
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+// Allocation cost of one cluster files on a filled partition
+static void test_latency(uint8_t percent)
+{
+	struct timespec start, end;
+	char name[16];
+	uint8_t f;
+
+	mount_image();
+	fill(percent);
+	memset(&image_mem_stat, 0, sizeof(image_mem_stat));
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (f = 0; f < BENCH_FILES; f++)
+	{
+		sprintf(name, "new%u.bin", f);
+		write_file(name, 1, f);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	printf("%u%% fill, %s: %.1f sector reads, %.1f us per allocation\n",
+			percent, FREEMAP_USED ? "bitmap" : "FAT scan",
+			(double)image_mem_stat.read_sectors / BENCH_FILES,
+			((end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3) / BENCH_FILES);
+
+	// The bitmap finds the free cluster without reading the FAT
+	if (FREEMAP_USED) assert(image_mem_stat.read_sectors <= 4 * BENCH_FILES);
+
+	for (f = 0; f < BENCH_FILES; f++)
+	{
+		sprintf(name, "new%u.bin", f);
+		assert(check_file(name, 1, f) == 1);
+	}
+	assert(nav_partition_freespace_verify());
+	image_mem_destroy();
+}
+
+// Free clusters of deleted files are reused, a larger file goes to a
+// run large enough with the bitmap where the FAT scan splits it over the
+// holes
+static void test_fragmented(void)
+{
+	char name[16];
+	uint32_t nb_segment, first;
+	uint8_t f;
+
+	mount_image();
+
+	// The FAT scan first probes clusters 2, 503, 1004... (one every 501)
+	// and scans the whole FAT from cluster 2 when they are all used. With
+	// the partition full up to the last probe, both allocators place new
+	// files one after the other at the end.
+	first = fs_g_nav.u32_CountofCluster - 1;
+	first -= (first - 2) % 501 - 1;
+	assert(fs_g_nav.u32_CountofCluster - first >= 32);
+	fill_clusters(first - 2);
+
+	// One cluster holes between files, before the last allocated cluster
+	for (f = 0; f < 16; f++)
+	{
+		sprintf(name, "small%u.bin", f);
+		write_file(name, 1, f);
+		assert(fs_g_nav_entry.u32_cluster == first + f);
+	}
+	for (f = 0; f < 16; f += 2)
+	{
+		sprintf(name, "small%u.bin", f);
+		assert(nav_setcwd((FS_STRING)name, true, false));
+		assert(nav_file_del(false));
+	}
+
+	// A file of several clusters
+	write_file("large.bin", 4, 0x80);
+	nb_segment = check_file("large.bin", 4, 0x80);
+	printf("fragmented, %s: file of 4 clusters in %lu segments\n",
+			FREEMAP_USED ? "bitmap" : "FAT scan", (unsigned long)nb_segment);
+	if (FREEMAP_USED) assert(nb_segment == 1);
+	else assert(nb_segment > 1);
+
+	// The holes are used by one cluster files
+	write_file("one.bin", 1, 0x40);
+	assert(fs_g_nav_entry.u32_cluster < first + 16);
+
+	// Nothing was overwritten
+	for (f = 1; f < 16; f += 2)
+	{
+		sprintf(name, "small%u.bin", f);
+		assert(check_file(name, 1, f) == 1);
+	}
+	assert(check_file("large.bin", 4, 0x80) == nb_segment);
+	assert(check_file("one.bin", 1, 0x40) == 1);
+	assert(nav_partition_freespace_verify());
+	image_mem_destroy();
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	ctrl_access_lock();
+	test_latency(10);
+	test_latency(90);
+	test_fragmented();
+	ctrl_access_unlock();
+
+	printf("test_freemap: passed\n");
+	return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * Name         : test_freespace.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test of the free cluster count kept by the FAT
+ *                module, cross-checked with the FAT of the disk image
+ */
+#include <asf.h>
+#include <string.h>
+#include "image_mem.h"
+#include "fat_image.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Disk images, FAT16 (16 MB) and FAT12 (4 MB)
+#define IMAGE_FAT16			32768
+#define IMAGE_FAT12			8192
+
+// Random file operations of the workload
+#define WORK_FILES			6
+#define WORK_STEPS			400
+#define WORK_MAX_WRITE		12000
+
+
+
+/*****  VARIABLES  ****************************************************/
+
+static uint8_t buf[WORK_MAX_WRITE];
+static uint32_t rand_state = 12345;
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// xorshift32
+static uint32_t rand32(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+// The count of the FAT module equals the FAT on the image
+static void check_count(void)
+{
+	assert(fat_cache_flush());
+	assert(nav_partition_freespace() == fat_image_free_clusters() * fs_g_nav.u8_BPB_SecPerClus);
+}
+
+// One random operation on one of the files
+static void random_step(void)
+{
+	char name[16];
+	uint16_t size = rand32() % WORK_MAX_WRITE;
+
+	sprintf(name, "f%lu.dat", (unsigned long)(rand32() % WORK_FILES));
+	memset(buf, (uint8_t)size, size);
+
+	switch (rand32() % 5)
+	{
+		case 0:	// Rewrite
+		assert(nav_setcwd((FS_STRING)name, true, true));
+		assert(file_open(FOPEN_MODE_W));
+		assert(file_write_buf(buf, size) == size);
+		file_close();
+		break;
+		case 1:	// Append
+		case 2:
+		assert(nav_setcwd((FS_STRING)name, true, true));
+		assert(file_open(FOPEN_MODE_APPEND));
+		assert(file_write_buf(buf, size) == size);
+		file_close();
+		break;
+		case 3:	// Truncate
+		if (!nav_setcwd((FS_STRING)name, true, false)) break;
+		assert(file_open(FOPEN_MODE_R_PLUS));
+		assert(file_seek(nav_file_lgt() / 2, FS_SEEK_SET));
+		assert(file_set_eof());
+		file_close();
+		break;
+		default: // Delete
+		if (!nav_setcwd((FS_STRING)name, true, false)) break;
+		assert(nav_file_del(false));
+		break;
+	}
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+// The count follows allocations and releases, without reading the FAT
+static void test_workload(uint32_t image_sectors)
+{
+	uint32_t step;
+
+	fat_image_mount(image_sectors);
+	check_count();
+
+	for (step = 0; step < WORK_STEPS; step++)
+	{
+		random_step();
+		check_count();
+		if (step % 50 == 0) assert(nav_partition_freespace_verify());
+	}
+
+	// The count is given without a device access
+	memset(&image_mem_stat, 0, sizeof(image_mem_stat));
+	for (step = 0; step < 10; step++) nav_partition_freespace();
+	assert(image_mem_stat.read_cmds == 0);
+
+	// Mounted again, the FAT is scanned once
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_partition_mount());
+	check_count();
+	assert(nav_partition_freespace_verify());
+
+	printf("%s: %lu of %lu clusters free after %u steps\n",
+			fs_g_nav_fast.u8_type_fat == FS_TYPE_FAT_12 ? "FAT12" : "FAT16",
+			(unsigned long)fat_image_free_clusters(),
+			(unsigned long)fs_g_nav.u32_CountofCluster - 2, WORK_STEPS);
+	image_mem_destroy();
+}
+
+// A FAT modified behind the module is found and the count corrected
+static void test_verify(void)
+{
+	uint32_t cluster, count;
+
+	fat_image_mount(IMAGE_FAT16);
+	count = nav_partition_freespace();
+	assert(fat_cache_flush());
+
+	// Mark the last cluster used on the image, drop the cached sectors
+	cluster = fs_g_nav.u32_CountofCluster - 1;
+	assert(!fat_image_entry(0, cluster));
+	image_mem[fs_g_nav.u32_ptr_fat * FS_512B + cluster * 2] = 0xFF;
+	image_mem[fs_g_nav.u32_ptr_fat * FS_512B + cluster * 2 + 1] = 0xFF;
+	fat_cache_reset();
+
+	assert(nav_partition_freespace() == count);
+	assert(!nav_partition_freespace_verify());
+	assert(fs_g_status == FS_ERR_FS);
+	assert(nav_partition_freespace() == count - fs_g_nav.u8_BPB_SecPerClus);
+	assert(nav_partition_freespace_verify());
+
+	image_mem_destroy();
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	ctrl_access_lock();
+	test_workload(IMAGE_FAT16);
+	test_workload(IMAGE_FAT12);
+	test_verify();
+	ctrl_access_unlock();
+
+	printf("test_freespace: passed\n");
+	return 0;
+}
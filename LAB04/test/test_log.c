@@ -0,0 +1,282 @@
+/**
+ * Name         : test_log.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test of the logfile format (log.c), logs sessions
+ *                to a FAT16 disk image and parses the blocks back, then
+ *                writes the logfile for the log2csv round trip
+ */
+#include <asf.h>
+#include <string.h>
+#include <stddef.h>
+#include "image_mem.h"
+#include "log.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Disk image size in sectors (16 MB, FAT16)
+#define IMAGE_SECTORS		32768
+
+// Sampling parameters of the sessions, channels 0 and 2 at 1 kHz
+#define TEST_CHANNELS		0x05
+#define TEST_NB_CHANNELS	2
+#define TEST_CLOCK_HZ		1500000
+#define TEST_CLOCK_PERIOD	1500
+
+// A logging session: frames first..first+nb_frames-1, frame numbers
+// jump by gap after gap_at frames (a stall)
+typedef struct {
+	uint32_t first;
+	uint32_t nb_frames;
+	uint32_t gap_at;
+	uint32_t gap;
+	uint32_t prealloc;
+} session_t;
+
+static const session_t sessions[] = {
+	{ 0,    1000, 300,  17, 0 },         // through the FAT
+	{ 5000, 2000, 1000, 1,  64 * 512 },  // through a preallocated run
+	{ 0,    10,   UINT32_MAX, 0, 0 },       // a single partial block
+};
+
+#define NB_SESSIONS		(sizeof(sessions) / sizeof(sessions[0]))
+
+// Logfile and the CSV log2csv must make of it, for the round trip of
+// make check (the test binary name with .bin and .csv)
+static const char *output_name;
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// Frame number of the i-th frame of a session
+static uint32_t session_frame(const session_t *s, uint32_t i)
+{
+	return s->first + i + (i >= s->gap_at ? s->gap : 0);
+}
+
+// Values of a frame, different per channel
+static void frame_values(uint32_t frame, uint16_t *values)
+{
+	values[0] = frame & ADC_MAX_VALUE;
+	values[1] = ~frame & ADC_MAX_VALUE;
+}
+
+// Logs a session to the current logfile
+static void log_session(const session_t *s)
+{
+	uint16_t values[TEST_NB_CHANNELS];
+	uint32_t i;
+
+	assert(log_start(TEST_CHANNELS, TEST_CLOCK_HZ, TEST_CLOCK_PERIOD));
+	if (s->prealloc) assert(log_preallocate(s->prealloc));
+
+	for (i = 0; i < s->nb_frames; i++)
+	{
+		uint32_t frame = session_frame(s, i);
+		frame_values(frame, values);
+		log_write_frame(frame, values);
+		if (i % 7 == 0) assert(log_task());
+	}
+	log_stop();
+	assert(log_get_stalls() == 0 && log_get_lost_blocks() == 0);
+}
+
+// A block as the AVR32 writes it: fields big-endian, CRC of those bytes
+static void block_to_target(log_block_t *block)
+{
+	log_header_t *header = (log_header_t*)block;
+	uint16_t i;
+
+	if (!memcmp(header->magic, LOG_MAGIC, sizeof(LOG_MAGIC)))
+	{
+		header->version = __builtin_bswap16(header->version);
+		header->block_size = __builtin_bswap16(header->block_size);
+		header->sample_freq = __builtin_bswap32(header->sample_freq);
+		header->clock_hz = __builtin_bswap32(header->clock_hz);
+		header->clock_period = __builtin_bswap32(header->clock_period);
+	}
+	else if (block->magic == LOG_BLOCK_MAGIC)
+	{
+		block->magic = __builtin_bswap16(block->magic);
+		block->nb_records = __builtin_bswap16(block->nb_records);
+		block->sequence = __builtin_bswap32(block->sequence);
+		block->first_frame = __builtin_bswap32(block->first_frame);
+		for (i = 0; i < LOG_BLOCK_VALUES; i++) block->values[i] = __builtin_bswap16(block->values[i]);
+	}
+	block->crc = __builtin_bswap16(log_crc16(block, offsetof(log_block_t, crc)));
+}
+
+// Writes the logfile read back as the AVR32 has it, with a padding block
+// and a data block with a CRC error at the end, and the CSV of the sessions
+static void write_output(const log_block_t *blocks, uint32_t nb_block)
+{
+	log_block_t block;
+	uint16_t values[TEST_NB_CHANNELS];
+	char name[256];
+	uint32_t i, f, frame;
+	FILE *file;
+
+	snprintf(name, sizeof(name), "%s.bin", output_name);
+	assert((file = fopen(name, "wb")));
+	for (i = 0; i < nb_block; i++)
+	{
+		block = blocks[i];
+		block_to_target(&block);
+		assert(fwrite(&block, LOG_BLOCK_SIZE, 1, file) == 1);
+	}
+	memset(&block, 0, sizeof(block));
+	assert(fwrite(&block, LOG_BLOCK_SIZE, 1, file) == 1);
+	block = blocks[1];
+	block_to_target(&block);
+	block.values[0] ^= 1;
+	assert(fwrite(&block, LOG_BLOCK_SIZE, 1, file) == 1);
+	fclose(file);
+
+	snprintf(name, sizeof(name), "%s.csv", output_name);
+	assert((file = fopen(name, "w")));
+	for (i = 0; i < NB_SESSIONS; i++)
+	{
+		fprintf(file, "frame,time,ch0,ch2\n");
+		for (f = 0; f < sessions[i].nb_frames; f++)
+		{
+			frame = session_frame(&sessions[i], f);
+			frame_values(frame, values);
+			fprintf(file, "%lu,%.6f,%u,%u\n", (unsigned long)frame,
+					(double)frame * TEST_CLOCK_PERIOD / TEST_CLOCK_HZ, values[0], values[1]);
+		}
+	}
+	fclose(file);
+}
+
+// Checks a header block
+static void check_header(const log_header_t *header)
+{
+	uint16_t i;
+
+	assert(!memcmp(header->magic, LOG_MAGIC, sizeof(LOG_MAGIC)));
+	assert(header->version == LOG_VERSION);
+	assert(header->block_size == LOG_BLOCK_SIZE);
+	assert(header->sample_freq == 1000);
+	assert(header->clock_hz == TEST_CLOCK_HZ);
+	assert(header->clock_period == TEST_CLOCK_PERIOD);
+	assert(header->channels == TEST_CHANNELS);
+	assert(header->nb_channels == TEST_NB_CHANNELS);
+	assert(header->adc_bits == 10);
+	for (i = 0; i < sizeof(header->reserved); i++) assert(!header->reserved[i]);
+	assert(header->crc == log_crc16(header, offsetof(log_header_t, crc)));
+}
+
+// Checks the data blocks of a session, returns the number of blocks
+static uint32_t check_session(const session_t *s, const log_block_t *block, uint32_t nb_block)
+{
+	uint16_t per_block = LOG_BLOCK_VALUES / TEST_NB_CHANNELS;
+	uint16_t values[TEST_NB_CHANNELS];
+	uint32_t i = 0;
+	uint32_t seq;
+	uint16_t r;
+
+	for (seq = 0; i < s->nb_frames; seq++, block++)
+	{
+		assert(seq < nb_block);
+		assert(block->magic == LOG_BLOCK_MAGIC);
+		assert(block->sequence == seq);
+		assert(block->crc == log_crc16(block, offsetof(log_block_t, crc)));
+		assert(block->nb_records && block->nb_records <= per_block);
+		assert(block->first_frame == session_frame(s, i));
+
+		// Consecutive frames, a gap starts a new block
+		for (r = 0; r < block->nb_records; r++, i++)
+		{
+			assert(session_frame(s, i) == block->first_frame + r);
+			frame_values(block->first_frame + r, values);
+			assert(!memcmp(&block->values[r * TEST_NB_CHANNELS], values, sizeof(values)));
+		}
+		if (block->nb_records < per_block) assert(i == s->nb_frames || i == s->gap_at);
+
+		// Unused values are cleared
+		for (r *= TEST_NB_CHANNELS; r < LOG_BLOCK_VALUES; r++) assert(!block->values[r]);
+	}
+	return seq;
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+// Block layout and CRC
+static void test_layout(void)
+{
+	assert(sizeof(log_header_t) == LOG_BLOCK_SIZE);
+	assert(sizeof(log_block_t) == LOG_BLOCK_SIZE);
+	assert(offsetof(log_header_t, crc) == LOG_BLOCK_SIZE - 2);
+	assert(offsetof(log_header_t, reserved) == 27);
+	assert(offsetof(log_block_t, values) == 12);
+	assert(offsetof(log_block_t, crc) == LOG_BLOCK_SIZE - 2);
+	assert(LOG_BLOCK_VALUES == 249);
+
+	// CRC-16/CCITT-FALSE check value
+	assert(log_crc16("123456789", 9) == 0x29B1);
+	assert(log_crc16("", 0) == 0xFFFF);
+}
+
+// Sessions appended to one logfile read back block by block
+static void test_sessions(void)
+{
+	static log_block_t blocks[64];
+	uint32_t nb_block, b = 0;
+	uint32_t i;
+
+	image_mem_create(IMAGE_SECTORS);
+	ctrl_access_lock();
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_drive_format(FS_FORMAT_FAT));
+	ctrl_access_unlock();
+
+	assert(log_init(0));
+	assert(log_set_file("test.log"));
+	for (i = 0; i < NB_SESSIONS; i++) log_session(&sessions[i]);
+
+	// Read back the whole file
+	ctrl_access_lock();
+	assert(nav_setcwd((FS_STRING)"test.log", true, false));
+	assert(file_open(FOPEN_MODE_R));
+	assert(nav_file_lgt() % LOG_BLOCK_SIZE == 0);
+	nb_block = nav_file_lgt() / LOG_BLOCK_SIZE;
+	assert(nb_block <= sizeof(blocks) / LOG_BLOCK_SIZE);
+	assert(file_read_buf((uint8_t*)blocks, nb_block * LOG_BLOCK_SIZE) == nb_block * LOG_BLOCK_SIZE);
+	file_close();
+	ctrl_access_unlock();
+
+	// Each session is a header followed by its data blocks
+	for (i = 0; i < NB_SESSIONS; i++)
+	{
+		assert(b < nb_block);
+		check_header((const log_header_t*)&blocks[b++]);
+		b += check_session(&sessions[i], &blocks[b], nb_block - b);
+	}
+	assert(b == nb_block);
+	write_output(blocks, nb_block);
+
+	printf("sessions: %lu blocks, %lu write commands\n",
+			(unsigned long)nb_block, (unsigned long)image_mem_stat.write_cmds);
+	image_mem_destroy();
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(int argc, char *argv[])
+{
+	output_name = argv[0];
+
+	test_layout();
+	test_sessions();
+
+	printf("test_log: passed\n");
+	return 0;
+}
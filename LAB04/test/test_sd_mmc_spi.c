@@ -0,0 +1,359 @@
+/**
+ * Name         : test_sd_mmc_spi.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test and benchmark of the SD/MMC SPI driver on the
+ *                SD card emulator: single and multiple block (CMD18,
+ *                CMD25) transfers, and the FAT module on the card
+ */
+#include <asf.h>
+#include <string.h>
+#include "spi.h"
+#include "conf_sd_mmc_spi.h"
+#include "sd_mmc_spi.h"
+#include "sd_mmc_spi_mem.h"
+#include "spi_model.h"
+#include "sd_card.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Card size in sectors (4 MB, FAT12 once formatted)
+#define CARD_SECTORS		8192
+
+// PBA clock of conf_clock.h, and the CPU clock twice that
+#define TEST_PBA_HZ			33000000
+#define TEST_CPU_HZ			(TEST_PBA_HZ * SPI_MODEL_CPU_PER_PBA)
+
+// Sectors moved by each benchmark transfer
+#define NB_SECTOR			16
+
+// Sectors of the card used by the transfers, and the test file size
+#define BASE_SECTOR			1000
+#define FILE_SIZE			(16 * 1024L)
+
+static uint8_t buf[NB_SECTOR * 512 + 1];
+static uint8_t image[NB_SECTOR * 512];
+
+// Sectors passed to the multiple sector callbacks
+static uint8_t *callback_ram;
+
+// Completion of an asynchronous write
+static int async_status;
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// Byte i of sector s as written to the card by the tests
+static uint8_t pattern(uint32_t s, uint32_t i, uint8_t seed)
+{
+	return (uint8_t)(s * 31 + i * 7 + (i >> 8) + seed);
+}
+
+static void fill(uint8_t *ram, uint32_t sector, uint32_t nb_sector, uint8_t seed)
+{
+	uint32_t i;
+
+	for (i = 0; i < nb_sector * 512; i++) ram[i] = pattern(sector + i / 512, i % 512, seed);
+}
+
+// Compares sectors of the card image with the pattern
+static bool image_check(uint32_t sector, uint32_t nb_sector, uint8_t seed)
+{
+	uint32_t i;
+
+	sd_card_image_read(sector, nb_sector, image);
+	for (i = 0; i < nb_sector * 512; i++) {
+		if (image[i] != pattern(sector + i / 512, i % 512, seed)) return false;
+	}
+	return true;
+}
+
+static void stat_clear(void)
+{
+	memset(&sd_card_stat, 0, sizeof(sd_card_stat));
+	memset(&spi_model_stat, 0, sizeof(spi_model_stat));
+}
+
+// Inserts a card and initializes the SPI module and the driver as app.c
+static void card_insert(bool sdhc)
+{
+	spi_options_t options = {
+		.reg          = SD_MMC_SPI_NPCS,
+		.baudrate     = SD_MMC_SPI_MASTER_SPEED,
+		.bits         = SD_MMC_SPI_BITS,
+		.spck_delay   = 0,
+		.trans_delay  = 0,
+		.stay_act     = 1,
+		.spi_mode     = 0,
+		.modfdis      = 1
+	};
+
+	spi_model_init();
+	sd_card_create(NULL, CARD_SECTORS, sdhc);
+	spi_model_attach(SD_MMC_SPI_NPCS, &sd_card_device);
+
+	spi_initMaster(SD_MMC_SPI, &options);
+	spi_selectionMode(SD_MMC_SPI, 0, 0, 0);
+	spi_enable(SD_MMC_SPI);
+	assert(sd_mmc_spi_init(options, TEST_PBA_HZ));
+}
+
+void sd_mmc_spi_read_multiple_sector_callback(const void *psector)
+{
+	memcpy(callback_ram, psector, 512);
+	callback_ram += 512;
+}
+
+void sd_mmc_spi_write_multiple_sector_callback(void *psector)
+{
+	memcpy(psector, callback_ram, 512);
+	callback_ram += 512;
+}
+
+static void async_done(bool status)
+{
+	async_status = status;
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+// Identification, CSD decoding and the high speed switch
+static void test_init(bool sdhc)
+{
+	uint32_t last;
+
+	card_insert(sdhc);
+	assert(card_type == (sdhc ? SD_CARD_2_SDHC : SD_CARD_2));
+	assert(sd_mmc_spi_last_block_address == CARD_SECTORS - 1);
+	assert(sd_card_stat.cmd[6] == 2);
+	assert(sd_mmc_spi_get_clock() == TEST_PBA_HZ);
+	assert(sd_mmc_spi_test_unit_ready() == CTRL_GOOD);
+	assert(sd_mmc_spi_read_capacity(&last) == CTRL_GOOD);
+}
+
+// A reserved TRAN_SPEED time value leaves the card at the identification
+// clock instead of dividing by zero
+static void test_tran_speed(void)
+{
+	sd_card_tran_speed = 0x02;
+	card_insert(true);
+	assert(sd_mmc_spi_get_clock() > 0 && sd_mmc_spi_get_clock() <= 400000);
+	assert(sd_mmc_spi_test_unit_ready() == CTRL_GOOD);
+	sd_card_tran_speed = 0;
+}
+
+// Reads with CMD17 per sector and with one CMD18, the data and the
+// cost of each
+static void test_read(bool sdhc)
+{
+	uint32_t i, start, cycles[2], bytes[2], cmds[2];
+	uint8_t pass;
+
+	fill(image, BASE_SECTOR, NB_SECTOR, 0);
+	sd_card_image_write(BASE_SECTOR, NB_SECTOR, image);
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		memset(buf, 0, sizeof(buf));
+		stat_clear();
+		start = Get_sys_count();
+		if (pass == 0) {
+			for (i = 0; i < NB_SECTOR; i++) {
+				assert(sd_mmc_spi_mem_2_ram(BASE_SECTOR + i, buf + i * 512) == CTRL_GOOD);
+			}
+			assert(sd_card_stat.cmd[17] == NB_SECTOR && sd_card_stat.cmd[18] == 0);
+		} else {
+			assert(sd_mmc_spi_mem_2_ram_multi(BASE_SECTOR, NB_SECTOR, buf) == CTRL_GOOD);
+			assert(sd_card_stat.cmd[17] == 0 && sd_card_stat.cmd[18] == 1 && sd_card_stat.cmd[12] == 1);
+		}
+		cycles[pass] = Get_sys_count() - start;
+		bytes[pass] = sd_card_stat.bytes;
+		for (cmds[pass] = 0, i = 0; i < 64; i++) cmds[pass] += sd_card_stat.cmd[i];
+		assert(!memcmp(buf, image, sizeof(image)));
+		assert(spi_model_stat.lost == 0);
+
+		printf("%s %s: %.2f commands, %.1f bytes clocked, %lu cycles per sector (%.0f kB/s)\n",
+				sdhc ? "SDHC" : "SDSC", pass ? "CMD18 read" : "CMD17 reads",
+				cmds[pass] / (double)NB_SECTOR, bytes[pass] / (double)NB_SECTOR,
+				(unsigned long)(cycles[pass] / NB_SECTOR),
+				NB_SECTOR * 512.0 / 1024 * TEST_CPU_HZ / cycles[pass]);
+	}
+	assert(bytes[1] < bytes[0] && cycles[1] < cycles[0]);
+
+	// One sector goes through CMD17, none moves nothing
+	stat_clear();
+	assert(sd_mmc_spi_mem_2_ram_multi(BASE_SECTOR + 3, 1, buf) == CTRL_GOOD);
+	assert(sd_card_stat.cmd[17] == 1 && sd_card_stat.cmd[18] == 0);
+	assert(!memcmp(buf, image + 3 * 512, 512));
+	assert(sd_mmc_spi_mem_2_ram_multi(BASE_SECTOR, 0, buf) == CTRL_GOOD);
+
+	// Up to the last sector, the card prefetches nothing past it
+	fill(image, CARD_SECTORS - 4, 4, 1);
+	sd_card_image_write(CARD_SECTORS - 4, 4, image);
+	assert(sd_mmc_spi_mem_2_ram_multi(CARD_SECTORS - 4, 4, buf) == CTRL_GOOD);
+	assert(!memcmp(buf, image, 4 * 512));
+
+	// A buffer on an odd address takes 8-bit frames, an even one 16-bit
+	for (pass = 0; pass < 2; pass++)
+	{
+		start = Get_sys_count();
+		assert(sd_mmc_spi_mem_2_ram_multi(CARD_SECTORS - 4, 4, buf + !pass) == CTRL_GOOD);
+		cycles[pass] = Get_sys_count() - start;
+		assert(!memcmp(buf + !pass, image, 4 * 512));
+		printf("%s %d-bit frames: %lu cycles per sector\n", sdhc ? "SDHC" : "SDSC",
+				pass ? 16 : 8, (unsigned long)(cycles[pass] / 4));
+	}
+	assert(cycles[1] < cycles[0]);
+
+	// The streaming interface, sector by sector through the callback
+	fill(image, BASE_SECTOR, NB_SECTOR, 0);
+	memset(buf, 0, sizeof(buf));
+	callback_ram = buf;
+	assert(sd_mmc_spi_read_open(BASE_SECTOR));
+	assert(sd_mmc_spi_read_multiple_sector(NB_SECTOR));
+	assert(sd_mmc_spi_read_close());
+	assert(!memcmp(buf, image, NB_SECTOR * 512));
+
+	// Past the end of the card
+	assert(sd_mmc_spi_mem_2_ram_multi(CARD_SECTORS, 2, buf) == CTRL_FAIL);
+	assert(sd_mmc_spi_mem_2_ram(BASE_SECTOR, buf) == CTRL_GOOD);
+}
+
+// Writes with CMD24 and CMD25, the card programs in the background
+static void test_write(bool sdhc)
+{
+	uint32_t i;
+
+	// One CMD25 after the ACMD23 hint
+	fill(buf, BASE_SECTOR, NB_SECTOR, 2);
+	stat_clear();
+	assert(sd_mmc_spi_ram_2_mem_multi(BASE_SECTOR, NB_SECTOR, buf) == CTRL_GOOD);
+	assert(sd_card_stat.cmd[25] == 1 && sd_card_stat.cmd[23] == 1 && sd_card_stat.cmd[24] == 0);
+	assert(sd_card_stat.blocks_written == NB_SECTOR);
+	assert(image_check(BASE_SECTOR, NB_SECTOR, 2));
+
+	// CMD24 per sector
+	fill(buf, BASE_SECTOR, NB_SECTOR, 3);
+	stat_clear();
+	for (i = 0; i < 4; i++) {
+		assert(sd_mmc_spi_ram_2_mem(BASE_SECTOR + i, buf + i * 512) == CTRL_GOOD);
+	}
+	assert(sd_card_stat.cmd[24] == 4 && sd_card_stat.cmd[25] == 0);
+	assert(sd_mmc_spi_wait_not_busy());
+	assert(image_check(BASE_SECTOR, 4, 3) && image_check(BASE_SECTOR + 4, NB_SECTOR - 4, 2));
+
+	// From an odd address
+	memmove(buf + 1, buf, NB_SECTOR * 512);
+	assert(sd_mmc_spi_ram_2_mem_multi(BASE_SECTOR, NB_SECTOR, buf + 1) == CTRL_GOOD);
+	assert(sd_mmc_spi_wait_not_busy());
+	assert(image_check(BASE_SECTOR, NB_SECTOR, 3));
+
+	// The streaming interface
+	fill(buf, BASE_SECTOR, NB_SECTOR, 4);
+	callback_ram = buf;
+	assert(sd_mmc_spi_write_open(BASE_SECTOR));
+	assert(sd_mmc_spi_write_multiple_sector(NB_SECTOR));
+	sd_mmc_spi_write_close();
+	assert(sd_mmc_spi_wait_not_busy());
+	assert(image_check(BASE_SECTOR, NB_SECTOR, 4));
+
+	// Asynchronous write, completed by polling the card
+	fill(buf, BASE_SECTOR, 1, 5);
+	async_status = -1;
+	assert(sd_mmc_spi_write_sector_async(BASE_SECTOR, buf, async_done));
+	assert(sd_mmc_spi_async_is_busy());
+	assert(!sd_mmc_spi_write_sector_async(BASE_SECTOR + 1, buf, async_done));
+	for (i = 0; sd_mmc_spi_async_is_busy(); i++) sd_mmc_spi_async_task();
+	assert(async_status == true && i > 1);
+	assert(image_check(BASE_SECTOR, 1, 5));
+
+	// Past the end of the card
+	assert(sd_mmc_spi_ram_2_mem_multi(CARD_SECTORS - 1, 2, buf) == CTRL_FAIL);
+	assert(sd_mmc_spi_ram_2_mem(CARD_SECTORS, buf) == CTRL_FAIL);
+}
+
+// A card that stays busy fails an asynchronous write after the write
+// time-out, polled at the ADC buffer rate of main.c (every 32 ms)
+static void test_write_timeout(void)
+{
+	uint32_t polls = 0;
+
+	card_insert(true);
+	sd_card_busy_bytes = UINT32_MAX;
+	fill(buf, BASE_SECTOR, 1, 7);
+	async_status = -1;
+	assert(sd_mmc_spi_write_sector_async(BASE_SECTOR, buf, async_done));
+	while (sd_mmc_spi_async_is_busy())
+	{
+		spi_model_count += TEST_CPU_HZ / 1000 * 32;
+		sd_mmc_spi_async_task();
+		polls++;
+	}
+	assert(async_status == false);
+	assert(polls >= SD_MMC_SPI_WRITE_TIMEOUT_MS / 32 && polls <= SD_MMC_SPI_WRITE_TIMEOUT_MS / 32 + 1);
+}
+
+// The FAT module on the card, file data moves with multiple block commands
+static void test_fat(void)
+{
+	static uint8_t data[FILE_SIZE];
+	uint32_t i;
+
+	for (i = 0; i < FILE_SIZE; i++) data[i] = pattern(0, i, 6);
+
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_drive_format(FS_FORMAT_FAT));
+	assert(nav_partition_mount());
+	assert(nav_file_create((FS_STRING)"log.bin"));
+	assert(file_open(FOPEN_MODE_W));
+	stat_clear();
+	assert(file_write_buf(data, FILE_SIZE) == FILE_SIZE);
+	assert(sd_card_stat.cmd[25] > 0);
+	file_close();
+
+	memset(data, 0, sizeof(data));
+	nav_reset();
+	assert(nav_drive_set(0));
+	assert(nav_partition_mount());
+	assert(nav_setcwd((FS_STRING)"log.bin", true, false));
+	assert(file_open(FOPEN_MODE_R));
+	stat_clear();
+	assert(file_read_buf(data, FILE_SIZE) == FILE_SIZE);
+	assert(sd_card_stat.cmd[18] > 0 && sd_card_stat.cmd[17] < FILE_SIZE / 512 / 4);
+	file_close();
+	for (i = 0; i < FILE_SIZE; i++) assert(data[i] == pattern(0, i, 6));
+	nav_exit();
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	ctrl_access_lock();
+
+	test_init(false);
+	test_read(false);
+	test_write(false);
+
+	test_tran_speed();
+	test_write_timeout();
+
+	test_init(true);
+	test_read(true);
+	test_write(true);
+	test_fat();
+
+	sd_card_destroy();
+	ctrl_access_unlock();
+
+	printf("test_sd_mmc_spi: passed\n");
+	return 0;
+}
@@ -0,0 +1,316 @@
+/**
+ * Name         : test_spi.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test of the SPI buffer functions on the SPI register
+ *                model, with a cycle estimate against byte loops
+ */
+#include <stdio.h>
+#include <string.h>
+#include "spi.h"
+#include "spi_model.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+#define TEST_SPI			(&AVR32_SPI1)
+#define TEST_NPCS			1
+
+// PBA clock of conf_clock.h, the SPI clock is PBA / SCBR
+#define TEST_PBA_HZ			33000000
+
+#define TEST_LEN			512
+
+// Transfer of the overrun test, a stall is tried at each access of it
+#define OVERRUN_LEN			64
+
+// Device on the chip select: records MOSI, answers a known MISO stream
+static uint8_t dev_mosi[4 * TEST_LEN];
+static uint32_t dev_nb;
+static bool dev_selected;
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// MISO byte n of the device
+static uint8_t dev_miso(uint32_t n)
+{
+	return (uint8_t)(n * 13 + 7);
+}
+
+static void dev_select(bool selected)
+{
+	dev_selected = selected;
+}
+
+static uint8_t dev_exchange(uint8_t mosi)
+{
+	assert(dev_selected);
+	if (dev_nb < sizeof(dev_mosi)) dev_mosi[dev_nb] = mosi;
+	return dev_miso(dev_nb++);
+}
+
+static const spi_model_device_t dev = { dev_select, dev_exchange };
+
+// Sets up the module and the chip select with SCBR = pba_hz / baudrate
+static void spi_setup(uint32_t baudrate)
+{
+	spi_options_t options = {
+		.reg          = TEST_NPCS,
+		.baudrate     = baudrate,
+		.bits         = 8,
+		.spck_delay   = 0,
+		.trans_delay  = 0,
+		.stay_act     = 1,
+		.spi_mode     = 0,
+		.modfdis      = 1
+	};
+
+	spi_model_init();
+	spi_model_attach(TEST_NPCS, &dev);
+	assert(spi_initMaster(TEST_SPI, &options) == SPI_OK);
+	assert(spi_selectionMode(TEST_SPI, 0, 0, 0) == SPI_OK);
+	assert(spi_setupChipReg(TEST_SPI, &options, TEST_PBA_HZ) == SPI_OK);
+	spi_enable(TEST_SPI);
+	assert(spi_is_enabled(TEST_SPI));
+}
+
+static void dev_clear(void)
+{
+	dev_nb = 0;
+	memset(&spi_model_stat, 0, sizeof(spi_model_stat));
+}
+
+// Byte loops as the drivers had them before the buffer functions
+static void byte_write(const uint8_t *data, uint32_t len)
+{
+	while (len--) assert(spi_write(TEST_SPI, *data++) == SPI_OK);
+}
+
+static void byte_read(uint8_t *data, uint32_t len)
+{
+	uint16_t frame;
+
+	while (len--)
+	{
+		assert(spi_write(TEST_SPI, 0xFF) == SPI_OK);
+		assert(spi_read(TEST_SPI, &frame) == SPI_OK);
+		*data++ = frame;
+	}
+}
+
+// Frame size of the chip select, for the 16-bit functions
+static void frame_bits(uint8_t bits)
+{
+	while (!spi_writeEndCheck(TEST_SPI));
+	spi_set_bits_per_transfer(TEST_SPI, TEST_NPCS, bits);
+}
+
+
+
+/*****  TESTS  ********************************************************/
+
+// Data and order of the three buffer functions
+static void test_buffers(void)
+{
+	static uint8_t tx[TEST_LEN], rx[TEST_LEN];
+	uint32_t i;
+
+	spi_setup(TEST_PBA_HZ / 4);
+	for (i = 0; i < TEST_LEN; i++) tx[i] = (uint8_t)(i ^ 0x5A);
+
+	// TX only: every byte reaches the device once, in order
+	assert(spi_selectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+	dev_clear();
+	assert(spi_write_buf(TEST_SPI, tx, TEST_LEN) == SPI_OK);
+	assert(spi_unselectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+	assert(!dev_selected);
+	assert(dev_nb == TEST_LEN && !memcmp(dev_mosi, tx, TEST_LEN));
+	assert(spi_model_stat.lost == 0);
+
+	// RX after the TX: the stale RDR and overrun of the TX only frames
+	// must not show up, the dummy byte is sent for each frame
+	assert(spi_selectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+	dev_clear();
+	assert(spi_read_buf(TEST_SPI, rx, TEST_LEN, 0xA5) == SPI_OK);
+	assert(dev_nb == TEST_LEN);
+	for (i = 0; i < TEST_LEN; i++) assert(dev_mosi[i] == 0xA5 && rx[i] == dev_miso(i));
+
+	// Full duplex
+	dev_clear();
+	assert(spi_transfer_buf(TEST_SPI, tx, rx, TEST_LEN) == SPI_OK);
+	assert(dev_nb == TEST_LEN && !memcmp(dev_mosi, tx, TEST_LEN));
+	for (i = 0; i < TEST_LEN; i++) assert(rx[i] == dev_miso(i));
+
+	// Nothing to move
+	dev_clear();
+	assert(spi_write_buf(TEST_SPI, tx, 0) == SPI_OK);
+	assert(spi_read_buf(TEST_SPI, rx, 0, 0xFF) == SPI_OK);
+	assert(dev_nb == 0 && spi_model_stat.lost == 0 && spi_model_stat.overruns == 0);
+	assert(spi_unselectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+}
+
+// The 16-bit functions move two bytes per frame, the first one in the MSB
+// which is shifted out first, so the device sees the bytes in buffer order
+static void test_packed16(void)
+{
+	static uint8_t tx[TEST_LEN], rx[TEST_LEN + 1];
+	uint32_t i;
+
+	spi_setup(TEST_PBA_HZ / 4);
+	for (i = 0; i < TEST_LEN; i++) tx[i] = (uint8_t)(i ^ 0x5A);
+	assert(spi_selectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+	frame_bits(16);
+
+	dev_clear();
+	assert(spi_write_packed16(TEST_SPI, tx, TEST_LEN) == SPI_OK);
+	while (!spi_writeEndCheck(TEST_SPI));
+	assert(dev_nb == TEST_LEN && !memcmp(dev_mosi, tx, TEST_LEN));
+	assert(spi_model_stat.frames_16 == TEST_LEN / 2 && spi_model_stat.lost == 0);
+
+	// After the TX only frames, the dummy frame goes out MSB first
+	dev_clear();
+	assert(spi_read_packed16(TEST_SPI, rx, TEST_LEN, 0xA55A) == SPI_OK);
+	assert(dev_nb == TEST_LEN);
+	for (i = 0; i < TEST_LEN; i++)
+	{
+		assert(dev_mosi[i] == ((i & 1) ? 0x5A : 0xA5));
+		assert(rx[i] == dev_miso(i));
+	}
+
+	// Into an odd address, the buffer is accessed by bytes
+	dev_clear();
+	assert(spi_read_packed16(TEST_SPI, rx + 1, TEST_LEN, 0xFFFF) == SPI_OK);
+	for (i = 0; i < TEST_LEN; i++) assert(rx[i + 1] == dev_miso(i));
+
+	// Odd lengths do not fit the frames
+	dev_clear();
+	assert(spi_write_packed16(TEST_SPI, tx, 3) == SPI_ERROR_ARGUMENT);
+	assert(spi_read_packed16(TEST_SPI, rx, 3, 0xFFFF) == SPI_ERROR_ARGUMENT);
+	assert(spi_read_packed16(TEST_SPI, rx, 0, 0xFFFF) == SPI_OK);
+	assert(dev_nb == 0);
+
+	frame_bits(8);
+	assert(spi_unselectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+}
+
+// A CPU stall with a frame queued in TDR overruns RDR. Whichever access
+// the stall falls on, the read either returns the right data or reports
+// the overrun, and the next one starts clean.
+static void test_overrun(void)
+{
+	static uint8_t rx[OVERRUN_LEN];
+	uint32_t i, at, nb_overrun = 0;
+	spi_status_t status;
+
+	spi_setup(TEST_PBA_HZ / 4);
+	assert(spi_selectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+
+	// An interrupt of 10 frames at each access of a few frames
+	for (at = 20; at < 60; at++)
+	{
+		dev_clear();
+		spi_model_stall(at, 10 * 8 * 4 * SPI_MODEL_CPU_PER_PBA);
+		status = spi_read_buf(TEST_SPI, rx, OVERRUN_LEN, 0xFF);
+		assert(dev_nb == OVERRUN_LEN);
+		if (spi_model_stat.overruns)
+		{
+			assert(status == SPI_ERROR_OVERRUN);
+			nb_overrun++;
+		}
+		else
+		{
+			assert(status == SPI_OK);
+			for (i = 0; i < OVERRUN_LEN; i++) assert(rx[i] == dev_miso(i));
+		}
+
+		dev_clear();
+		assert(spi_transfer_buf(TEST_SPI, rx, rx, OVERRUN_LEN) == SPI_OK);
+		assert(spi_model_stat.overruns == 0);
+	}
+	assert(nb_overrun > 0 && nb_overrun < 40);
+
+	// A stall shorter than a frame is absorbed by TDR
+	for (at = 20; at < 60; at++)
+	{
+		dev_clear();
+		spi_model_stall(at, 4 * SPI_MODEL_CPU_PER_PBA);
+		assert(spi_read_buf(TEST_SPI, rx, OVERRUN_LEN, 0xFF) == SPI_OK);
+		for (i = 0; i < OVERRUN_LEN; i++) assert(rx[i] == dev_miso(i));
+	}
+
+	// Reading SR during the transfer clears OVRES, so the status of the
+	// module does not show it afterwards
+	assert(spi_getStatus(TEST_SPI) == SPI_OK);
+	assert(spi_unselectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+}
+
+// Register accesses and cycles of 512 bytes, byte loops against the buffer
+// functions and 8 against 16-bit frames, at the SD card clock (SCBR = 1)
+static void test_cycles(void)
+{
+	static uint8_t buf[TEST_LEN];
+	uint32_t start, cycles[6], accesses[6];
+	static const char *name[6] = {
+		"spi_write() loop", "spi_write_buf()", "spi_write()/spi_read() loop", "spi_read_buf()",
+		"spi_write_packed16()", "spi_read_packed16()"
+	};
+	uint8_t i;
+
+	spi_setup(TEST_PBA_HZ);
+	assert(spi_selectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+	memset(buf, 0x3C, sizeof(buf));
+
+	for (i = 0; i < 6; i++)
+	{
+		if (i == 4) frame_bits(16);
+		dev_clear();
+		start = Get_sys_count();
+		switch (i)
+		{
+		case 0: byte_write(buf, TEST_LEN); break;
+		case 1: assert(spi_write_buf(TEST_SPI, buf, TEST_LEN) == SPI_OK); break;
+		case 2: byte_read(buf, TEST_LEN); break;
+		case 3: assert(spi_read_buf(TEST_SPI, buf, TEST_LEN, 0xFF) == SPI_OK); break;
+		case 4: assert(spi_write_packed16(TEST_SPI, buf, TEST_LEN) == SPI_OK); break;
+		case 5: assert(spi_read_packed16(TEST_SPI, buf, TEST_LEN, 0xFFFF) == SPI_OK); break;
+		}
+		while (!spi_writeEndCheck(TEST_SPI));
+		cycles[i] = Get_sys_count() - start;
+		accesses[i] = spi_model_stat.accesses;
+		assert(dev_nb == TEST_LEN && spi_model_stat.lost == 0);
+		assert(spi_model_stat.tdr_writes == ((i < 4) ? TEST_LEN : TEST_LEN / 2));
+
+		printf("%-28s %4lu register accesses, %5lu cycles (%.1f/byte)\n", name[i],
+				(unsigned long)accesses[i], (unsigned long)cycles[i], cycles[i] / (double)TEST_LEN);
+	}
+	printf("%-28s %5u cycles\n", "shifting 512 frames", TEST_LEN * 8 * SPI_MODEL_CPU_PER_PBA);
+
+	// The buffer functions skip a function call and its status checks per
+	// byte, and the read keeps a frame queued
+	assert(cycles[1] <= cycles[0] && cycles[3] < cycles[2]);
+	assert(accesses[3] < accesses[2]);
+
+	// 16-bit frames halve the TDR and RDR accesses, which lets the read
+	// keep up with the shifter like the write
+	assert(cycles[5] < cycles[3] && cycles[5] <= cycles[4] + 64);
+	frame_bits(8);
+	assert(spi_unselectChip(TEST_SPI, TEST_NPCS) == SPI_OK);
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	test_buffers();
+	test_packed16();
+	test_overrun();
+	test_cycles();
+
+	printf("test_spi: passed\n");
+	return 0;
+}
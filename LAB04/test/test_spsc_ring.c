@@ -0,0 +1,146 @@
+/**
+ * Name         : test_spsc_ring.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host test of the SPSC event ring (spsc_ring.h)
+ */
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include "spsc_ring.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Ring size of the stress test, small so that it runs full often
+#define STRESS_RING_SIZE	16
+
+// Events pushed by the stress test producer
+#define STRESS_EVENTS		1000000UL
+
+
+
+/*****  VARIABLES  ****************************************************/
+
+static spsc_event_t buffer[STRESS_RING_SIZE];
+static spsc_ring_t ring;
+
+// Set by the producer when all events are pushed
+static volatile bool stress_done;
+
+
+
+/*****  TESTS  ********************************************************/
+
+// Empty ring, fill it up, overflow and drain in order
+static void test_fill_drain(void)
+{
+	spsc_event_t event;
+	uint32_t i;
+
+	spsc_ring_init(&ring, buffer, 8);
+	assert(spsc_ring_count(&ring) == 0);
+	assert(!spsc_ring_pop(&ring, &event));
+
+	for (i = 0; i < 8; i++) {
+		assert(spsc_ring_push(&ring, i * 10, i));
+	}
+	assert(spsc_ring_count(&ring) == 8);
+	assert(!spsc_ring_push(&ring, 80, 8));
+	assert(ring.overflows == 1);
+	assert(ring.high_water == 8);
+
+	for (i = 0; i < 8; i++) {
+		assert(spsc_ring_pop(&ring, &event));
+		assert(event.timestamp == i * 10 && event.value == i);
+	}
+	assert(!spsc_ring_pop(&ring, &event));
+	assert(spsc_ring_count(&ring) == 0);
+}
+
+// The free-running indexes wrap at 65536
+static void test_index_wrap(void)
+{
+	spsc_event_t event;
+	uint32_t i;
+
+	spsc_ring_init(&ring, buffer, 4);
+	ring.head = ring.tail = 0xFFFE;
+
+	for (i = 0; i < 20; i++) {
+		assert(spsc_ring_push(&ring, i, ~i));
+		assert(spsc_ring_push(&ring, i, i));
+		assert(spsc_ring_count(&ring) == 2);
+		assert(spsc_ring_pop(&ring, &event) && event.value == ~i);
+		assert(spsc_ring_pop(&ring, &event) && event.value == i);
+		assert(spsc_ring_count(&ring) == 0);
+	}
+	assert(ring.high_water == 2 && ring.overflows == 0);
+}
+
+// Producer side of the stress test, pushes a sequence and retries an
+// event the full ring rejected, so that the ring runs full without gaps.
+// Both sides yield when they cannot proceed, the host may have one core.
+static void *stress_producer(void *arg)
+{
+	uint32_t i;
+
+	(void)arg;
+	for (i = 0; i < STRESS_EVENTS; i++) {
+		while (!spsc_ring_push(&ring, i ^ 0xA5A5A5A5, i)) {
+			sched_yield();
+		}
+	}
+	stress_done = true;
+	return NULL;
+}
+
+// One producer and one consumer thread: every event arrives once, in
+// order and not torn, while the producer keeps hitting a full ring
+static void test_stress(void)
+{
+	pthread_t producer;
+	spsc_event_t event;
+	uint32_t received = 0;
+	uint32_t next = 0;
+	bool done;
+
+	spsc_ring_init(&ring, buffer, STRESS_RING_SIZE);
+	stress_done = false;
+	assert(pthread_create(&producer, NULL, stress_producer, NULL) == 0);
+
+	do {
+		done = stress_done;
+		while (spsc_ring_pop(&ring, &event)) {
+			assert(event.value == next);
+			assert(event.timestamp == (event.value ^ 0xA5A5A5A5));
+			next++;
+			received++;
+		}
+		sched_yield();
+	} while (!done);
+
+	assert(pthread_join(producer, NULL) == 0);
+	assert(!spsc_ring_pop(&ring, &event));
+	assert(received == STRESS_EVENTS);
+	assert(ring.high_water <= STRESS_RING_SIZE);
+
+	printf("stress: %lu events, %lu full ring retries, high water %u\n",
+			(unsigned long)received, (unsigned long)ring.overflows,
+			ring.high_water);
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(void)
+{
+	test_fill_drain();
+	test_index_wrap();
+	test_stress();
+
+	printf("test_spsc_ring: passed\n");
+	return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * Name         : log2csv.c
+ * Author       : Jrgen Ryther Hoem
+ * Lab          : Lab 4 (ET014G)
+ * Description  : Host converter of the binary logfile (see log.h) to CSV,
+ *                one row per frame with its time in seconds
+ *
+ *  Usage: log2csv <logfile> [csvfile]
+ *
+ *  Each session starts with a column line. Blocks with a CRC error,
+ *  an unknown magic or before the first header are skipped, a summary
+ *  goes to stderr.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "../log.h"
+
+
+
+/*****  DECLARATIONS  *************************************************/
+
+// Session of the last valid header
+typedef struct {
+	bool     valid;
+	uint32_t clock_hz;
+	uint32_t clock_period;
+	uint8_t  channels;
+	uint8_t  nb_channels;
+} session_t;
+
+// Block counters of the summary
+typedef struct {
+	uint32_t sessions;
+	uint32_t blocks;
+	uint32_t frames;
+	uint32_t crc_errors;
+	uint32_t skipped;
+} summary_t;
+
+
+
+/*****  HELPERS  ******************************************************/
+
+// Big-endian fields of a block
+static uint16_t get16(const uint8_t *block, size_t offset)
+{
+	return (uint16_t)((block[offset] << 8) | block[offset + 1]);
+}
+
+static uint32_t get32(const uint8_t *block, size_t offset)
+{
+	return ((uint32_t)get16(block, offset) << 16) | get16(block, offset + 2);
+}
+
+// CRC-16/CCITT (poly 0x1021, init 0xFFFF), as log_crc16()
+static uint16_t crc16(const uint8_t *data, size_t len)
+{
+	uint16_t crc = 0xFFFF;
+	uint8_t bit;
+
+	while (len--)
+	{
+		crc ^= (uint16_t)(*data++ << 8);
+		for (bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+// Starts a session from a header block, prints its column line
+static bool read_header(const uint8_t *block, session_t *session, FILE *out)
+{
+	uint8_t ch;
+
+	if (get16(block, offsetof(log_header_t, version)) != LOG_VERSION
+	||  get16(block, offsetof(log_header_t, block_size)) != LOG_BLOCK_SIZE
+	||  !get32(block, offsetof(log_header_t, clock_hz))) return false;
+
+	session->clock_hz     = get32(block, offsetof(log_header_t, clock_hz));
+	session->clock_period = get32(block, offsetof(log_header_t, clock_period));
+	session->channels     = block[offsetof(log_header_t, channels)];
+	session->nb_channels  = block[offsetof(log_header_t, nb_channels)];
+	session->valid = session->nb_channels > 0;
+
+	fprintf(out, "frame,time");
+	for (ch = 0; ch < 8; ch++) if (session->channels & (1 << ch)) fprintf(out, ",ch%u", ch);
+	fprintf(out, "\n");
+	return true;
+}
+
+// Prints the frames of a data block, returns their number
+static uint32_t read_data(const uint8_t *block, const session_t *session, FILE *out)
+{
+	uint16_t nb_records = get16(block, offsetof(log_block_t, nb_records));
+	uint32_t frame = get32(block, offsetof(log_block_t, first_frame));
+	size_t value = offsetof(log_block_t, values);
+	uint16_t r;
+	uint8_t c;
+
+	if (nb_records > LOG_BLOCK_VALUES / session->nb_channels) nb_records = LOG_BLOCK_VALUES / session->nb_channels;
+
+	for (r = 0; r < nb_records; r++, frame++)
+	{
+		fprintf(out, "%lu,%.6f", (unsigned long)frame, (double)frame * session->clock_period / session->clock_hz);
+		for (c = 0; c < session->nb_channels; c++, value += 2) fprintf(out, ",%u", get16(block, value));
+		fprintf(out, "\n");
+	}
+	return nb_records;
+}
+
+
+
+/*****  MAIN  *********************************************************/
+
+int main(int argc, char *argv[])
+{
+	uint8_t block[LOG_BLOCK_SIZE];
+	session_t session = { false };
+	summary_t summary = { 0 };
+	FILE *in, *out = stdout;
+	int status;
+
+	if (argc < 2 || argc > 3)
+	{
+		fprintf(stderr, "Usage: log2csv <logfile> [csvfile]\n");
+		return 1;
+	}
+	if (!(in = fopen(argv[1], "rb")))
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	if (argc == 3 && !(out = fopen(argv[2], "w")))
+	{
+		perror(argv[2]);
+		fclose(in);
+		return 1;
+	}
+
+	while (fread(block, LOG_BLOCK_SIZE, 1, in) == 1)
+	{
+		summary.blocks++;
+
+		if (!memcmp(block, LOG_MAGIC, sizeof(LOG_MAGIC))
+		||  get16(block, offsetof(log_block_t, magic)) == LOG_BLOCK_MAGIC)
+		{
+			if (crc16(block, LOG_BLOCK_SIZE - 2) != get16(block, LOG_BLOCK_SIZE - 2))
+			{
+				summary.crc_errors++;
+				continue;
+			}
+		}
+		else
+		{
+			// Padding or an unknown block
+			summary.skipped++;
+			continue;
+		}
+
+		if (!memcmp(block, LOG_MAGIC, sizeof(LOG_MAGIC)))
+		{
+			if (read_header(block, &session, out)) summary.sessions++;
+			else
+			{
+				session.valid = false;
+				summary.skipped++;
+			}
+		}
+		else if (session.valid) summary.frames += read_data(block, &session, out);
+		else summary.skipped++;
+	}
+
+	fprintf(stderr, "log2csv: %lu blocks, %lu sessions, %lu frames, %lu CRC errors, %lu skipped\n",
+			(unsigned long)summary.blocks, (unsigned long)summary.sessions, (unsigned long)summary.frames,
+			(unsigned long)summary.crc_errors, (unsigned long)summary.skipped);
+
+	status = (ferror(in) || ferror(out)) ? 1 : 0;
+	fclose(in);
+	if (out != stdout && fclose(out)) status = 1;
+	return status;
+}